@@ -0,0 +1,130 @@
+//  Copyright 2021 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compare the single-core throughput of runtime_bigintBatchModularMul,
+// runtime_bigintBatchModularExp, and runtime_bigintFixedBaseExp with repeated
+// calls to runtime_bigintModularMul and runtime_bigintModularExp.
+// Usage: batch_modmul [width [batchSize]]
+#include "runtime.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Return the time in seconds.
+static double getTime(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+// Set |dest| to a pseudo-random |width|-bit bigint.
+static void randomBigint(runtime_array *dest, uint32_t width, uint64_t *seed) {
+  runtime_array word = runtime_makeEmptyArray();
+  runtime_integerToBigint(dest, 0, width, false, false);
+  for (uint32_t i = 0; i < width; i += 32) {
+    *seed = *seed*6364136223846793005ull + 1442695040888963407ull;
+    runtime_integerToBigint(&word, *seed >> 32, width, false, false);
+    runtime_bigintShl(dest, dest, 32);
+    runtime_bigintBitwiseOr(dest, dest, &word);
+  }
+  runtime_freeArray(&word);
+}
+
+// Fill an array of bigints with random values less than the modulus.
+static void randomBigintArray(runtime_array *array, uint32_t numValues, runtime_array *modulus,
+    uint64_t *seed) {
+  uint32_t width = runtime_bigintWidth(modulus);
+  runtime_allocArray(array, numValues, sizeof(runtime_array), true);
+  for (uint32_t i = 0; i < numValues; i++) {
+    runtime_array *value = (runtime_array*)array->data + i;
+    randomBigint(value, width, seed);
+    runtime_bigintMod(value, value, modulus);
+  }
+}
+
+int main(int argc, char **argv) {
+  uint32_t width = argc > 1? atoi(argv[1]) : 2048;
+  uint32_t numValues = argc > 2? atoi(argv[2]) : 64;
+  uint32_t mulRounds = 200;
+  uint32_t expRounds = 1;
+  uint64_t seed = 1;
+  runtime_arrayStart();
+  runtime_array modulus = runtime_makeEmptyArray();
+  runtime_array one = runtime_makeEmptyArray();
+  randomBigint(&modulus, width, &seed);
+  // Force the modulus to be odd and full width.
+  runtime_integerToBigint(&one, 1, width, false, false);
+  runtime_bigintBitwiseOr(&modulus, &modulus, &one);
+  runtime_bigintShl(&one, &one, width - 1);
+  runtime_bigintBitwiseOr(&modulus, &modulus, &one);
+  runtime_array a = runtime_makeEmptyArray();
+  runtime_array b = runtime_makeEmptyArray();
+  runtime_array result = runtime_makeEmptyArray();
+  runtime_array results = runtime_makeEmptyArray();
+  randomBigintArray(&a, numValues, &modulus, &seed);
+  randomBigintArray(&b, numValues, &modulus, &seed);
+  double start = getTime();
+  for (uint32_t r = 0; r < mulRounds; r++) {
+    for (uint32_t i = 0; i < numValues; i++) {
+      runtime_bigintModularMul(&result, (runtime_array*)a.data + i, (runtime_array*)b.data + i,
+          &modulus);
+    }
+  }
+  double serialMul = mulRounds*numValues/(getTime() - start);
+  start = getTime();
+  for (uint32_t r = 0; r < mulRounds; r++) {
+    runtime_bigintBatchModularMul(&results, &a, &b, &modulus);
+  }
+  double batchMul = mulRounds*numValues/(getTime() - start);
+  start = getTime();
+  for (uint32_t r = 0; r < expRounds; r++) {
+    for (uint32_t i = 0; i < numValues; i++) {
+      runtime_bigintModularExp(&result, (runtime_array*)a.data + i, (runtime_array*)b.data + i,
+          &modulus);
+    }
+  }
+  double serialExp = expRounds*numValues/(getTime() - start);
+  start = getTime();
+  for (uint32_t r = 0; r < expRounds; r++) {
+    runtime_bigintBatchModularExp(&results, &a, &b, &modulus);
+  }
+  double batchExp = expRounds*numValues/(getTime() - start);
+  // Exponentiate a fixed base, a[0], by each of b.
+  runtime_array table = runtime_makeEmptyArray();
+  start = getTime();
+  runtime_bigintFixedBaseTable(&table, (runtime_array*)a.data, &modulus);
+  double tableTime = getTime() - start;
+  start = getTime();
+  for (uint32_t i = 0; i < numValues; i++) {
+    runtime_bigintFixedBaseExp(&result, &table, (runtime_array*)b.data + i);
+  }
+  double combExp = numValues/(getTime() - start);
+  printf("width=%u batch=%u\n", width, numValues);
+  printf("modmul: serial %.0f/s, batched %.0f/s, speedup %.2fx\n", serialMul, batchMul,
+      batchMul/serialMul);
+  printf("modexp: serial %.2f/s, batched %.2f/s, speedup %.2fx\n", serialExp, batchExp,
+      batchExp/serialExp);
+  printf("fixed-base modexp: comb %.2f/s, speedup %.2fx, table built in %.3fs\n", combExp,
+      combExp/serialExp, tableTime);
+  runtime_freeArray(&modulus);
+  runtime_freeArray(&one);
+  runtime_freeArray(&a);
+  runtime_freeArray(&b);
+  runtime_freeArray(&result);
+  runtime_freeArray(&results);
+  runtime_freeArray(&table);
+  runtime_arrayStop();
+  return 0;
+}
@@ -0,0 +1,222 @@
+//  Copyright 2021 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmark the bigint runtime against GMP.  Each operation is timed at widths
+// from 128 to 8192 bits, with public and secret operands.  GMP has no notion of
+// secrets, so it is timed once per width, except for modexp, where secret
+// operands are compared against the constant-time mpz_powm_sec.
+//
+// Output is CSV on stdout, one row per measurement:
+//   op,width,secret,impl,iterations,ns_per_op
+// Usage: bigint_bench [minSeconds [maxWidth]]
+#include "runtime.h"
+
+#include <gmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef struct {
+  uint32_t width;
+  // a is width - 2 bits, so a + a does not overflow.  b and c are half width,
+  // so b*c does not overflow.  m is an odd full-width modulus, base < m, and e
+  // is a full-width exponent.
+  runtime_array a, b, c, m, base, e;
+  runtime_array dest, rem, string;
+  mpz_t ga, gb, gc, gm, gbase, ge;
+  mpz_t gdest, grem;
+  char *buf;
+} benchContext;
+
+typedef void (*benchFunc)(benchContext *ctx);
+
+typedef struct {
+  const char *name;
+  benchFunc runtimeFunc;
+  benchFunc gmpFunc;
+  benchFunc gmpSecretFunc;  // GMP's constant-time variant, if any.
+} benchOp;
+
+// Return the time in seconds.
+static double getTime(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec*1e-9;
+}
+
+// Return the next pseudo-random 32 bits.
+static uint32_t nextRandom(uint64_t *seed) {
+  *seed = *seed*6364136223846793005ull + 1442695040888963407ull;
+  return *seed >> 32;
+}
+
+// Set both the runtime and GMP integers to the same random value of exactly
+// |bits| bits.  If |odd| is set, the value is odd.
+static void setOperand(runtime_array *dest, mpz_t gdest, uint32_t bits, uint32_t width,
+    bool odd, uint64_t *seed) {
+  uint32_t numBytes = (bits + 7)/8;
+  runtime_array bytes = runtime_makeEmptyArray();
+  runtime_allocArray(&bytes, numBytes, sizeof(uint8_t), false);
+  uint8_t *data = (uint8_t*)bytes.data;
+  for (uint32_t i = 0; i < numBytes; i++) {
+    data[i] = nextRandom(seed);
+  }
+  uint32_t topBits = bits - 8*(numBytes - 1);
+  data[numBytes - 1] &= (1u << topBits) - 1;
+  data[numBytes - 1] |= 1u << (topBits - 1);
+  if (odd) {
+    data[0] |= 1;
+  }
+  runtime_bigintDecodeLittleEndian(dest, &bytes, width, false, false);
+  mpz_import(gdest, numBytes, -1, 1, 0, 0, data);
+  runtime_freeArray(&bytes);
+}
+
+// Set up all the operands for one width.
+static void initContext(benchContext *ctx, uint32_t width, uint64_t *seed) {
+  ctx->width = width;
+  ctx->a = ctx->b = ctx->c = ctx->m = ctx->base = ctx->e = runtime_makeEmptyArray();
+  ctx->dest = ctx->rem = ctx->string = runtime_makeEmptyArray();
+  mpz_inits(ctx->ga, ctx->gb, ctx->gc, ctx->gm, ctx->gbase, ctx->ge, ctx->gdest, ctx->grem, NULL);
+  setOperand(&ctx->a, ctx->ga, width - 2, width, false, seed);
+  setOperand(&ctx->b, ctx->gb, width/2 - 1, width, false, seed);
+  setOperand(&ctx->c, ctx->gc, width/2 - 1, width, false, seed);
+  setOperand(&ctx->m, ctx->gm, width, width, true, seed);
+  setOperand(&ctx->base, ctx->gbase, width - 1, width, false, seed);
+  setOperand(&ctx->e, ctx->ge, width, width, false, seed);
+  ctx->buf = malloc(width/3 + 16);
+}
+
+// Mark the runtime operands secret or public.
+static void setContextSecret(benchContext *ctx, bool secret) {
+  runtime_bigintSetSecret(&ctx->a, secret);
+  runtime_bigintSetSecret(&ctx->b, secret);
+  runtime_bigintSetSecret(&ctx->c, secret);
+  runtime_bigintSetSecret(&ctx->base, secret);
+  runtime_bigintSetSecret(&ctx->e, secret);
+}
+
+static void freeContext(benchContext *ctx) {
+  runtime_freeArray(&ctx->a);
+  runtime_freeArray(&ctx->b);
+  runtime_freeArray(&ctx->c);
+  runtime_freeArray(&ctx->m);
+  runtime_freeArray(&ctx->base);
+  runtime_freeArray(&ctx->e);
+  runtime_freeArray(&ctx->dest);
+  runtime_freeArray(&ctx->rem);
+  runtime_freeArray(&ctx->string);
+  mpz_clears(ctx->ga, ctx->gb, ctx->gc, ctx->gm, ctx->gbase, ctx->ge, ctx->gdest, ctx->grem, NULL);
+  free(ctx->buf);
+}
+
+static void runtimeAdd(benchContext *ctx) { runtime_bigintAdd(&ctx->dest, &ctx->a, &ctx->a); }
+static void gmpAdd(benchContext *ctx) { mpz_add(ctx->gdest, ctx->ga, ctx->ga); }
+static void runtimeMul(benchContext *ctx) { runtime_bigintMul(&ctx->dest, &ctx->b, &ctx->c); }
+static void gmpMul(benchContext *ctx) { mpz_mul(ctx->gdest, ctx->gb, ctx->gc); }
+static void runtimeDivRem(benchContext *ctx) {
+  runtime_bigintDivRem(&ctx->dest, &ctx->rem, &ctx->a, &ctx->b);
+}
+static void gmpDivRem(benchContext *ctx) {
+  mpz_tdiv_qr(ctx->gdest, ctx->grem, ctx->ga, ctx->gb);
+}
+static void runtimeMod(benchContext *ctx) { runtime_bigintMod(&ctx->dest, &ctx->a, &ctx->b); }
+static void gmpMod(benchContext *ctx) { mpz_tdiv_r(ctx->gdest, ctx->ga, ctx->gb); }
+static void runtimeModExp(benchContext *ctx) {
+  runtime_bigintModularExp(&ctx->dest, &ctx->base, &ctx->e, &ctx->m);
+}
+static void gmpModExp(benchContext *ctx) {
+  mpz_powm(ctx->gdest, ctx->gbase, ctx->ge, ctx->gm);
+}
+static void gmpModExpSec(benchContext *ctx) {
+  mpz_powm_sec(ctx->gdest, ctx->gbase, ctx->ge, ctx->gm);
+}
+static void runtimeModInverse(benchContext *ctx) {
+  runtime_bigintModularInverse(&ctx->dest, &ctx->base, &ctx->m);
+}
+static void gmpModInverse(benchContext *ctx) { mpz_invert(ctx->gdest, ctx->gbase, ctx->gm); }
+static void runtimeShl(benchContext *ctx) { runtime_bigintShl(&ctx->dest, &ctx->b, ctx->width/3); }
+static void gmpShl(benchContext *ctx) { mpz_mul_2exp(ctx->gdest, ctx->gb, ctx->width/3); }
+static void runtimeShr(benchContext *ctx) { runtime_bigintShr(&ctx->dest, &ctx->a, ctx->width/3); }
+static void gmpShr(benchContext *ctx) { mpz_tdiv_q_2exp(ctx->gdest, ctx->ga, ctx->width/3); }
+static void runtimeToDecimal(benchContext *ctx) {
+  runtime_bigintToString(&ctx->string, &ctx->a, 10);
+}
+static void gmpToDecimal(benchContext *ctx) { mpz_get_str(ctx->buf, 10, ctx->ga); }
+static void runtimeToHex(benchContext *ctx) {
+  runtime_bigintToString(&ctx->string, &ctx->a, 16);
+}
+static void gmpToHex(benchContext *ctx) { mpz_get_str(ctx->buf, 16, ctx->ga); }
+
+static const benchOp benchOps[] = {
+  {"add", runtimeAdd, gmpAdd, NULL},
+  {"mul", runtimeMul, gmpMul, NULL},
+  {"divrem", runtimeDivRem, gmpDivRem, NULL},
+  {"mod", runtimeMod, gmpMod, NULL},
+  {"modexp", runtimeModExp, gmpModExp, gmpModExpSec},
+  {"modinverse", runtimeModInverse, gmpModInverse, NULL},
+  {"shl", runtimeShl, gmpShl, NULL},
+  {"shr", runtimeShr, gmpShr, NULL},
+  {"todecimal", runtimeToDecimal, gmpToDecimal, NULL},
+  {"tohex", runtimeToHex, gmpToHex, NULL},
+};
+
+// Time |func|, doubling the iteration count until it runs for at least
+// |minSeconds|.  Print a CSV row.
+static void runBench(const char *name, const char *impl, benchFunc func, benchContext *ctx,
+    bool secret, double minSeconds) {
+  uint64_t iterations = 1;
+  double elapsed;
+  func(ctx);  // Warm up caches and allocate destinations.
+  for (;;) {
+    double start = getTime();
+    for (uint64_t i = 0; i < iterations; i++) {
+      func(ctx);
+    }
+    elapsed = getTime() - start;
+    if (elapsed >= minSeconds) {
+      break;
+    }
+    iterations <<= 1;
+  }
+  printf("%s,%u,%s,%s,%llu,%.1f\n", name, ctx->width, secret? "secret" : "public", impl,
+      (unsigned long long)iterations, elapsed*1e9/iterations);
+  fflush(stdout);
+}
+
+int main(int argc, char **argv) {
+  double minSeconds = argc > 1? atof(argv[1]) : 0.2;
+  uint32_t maxWidth = argc > 2? atoi(argv[2]) : 8192;
+  uint64_t seed = 1;
+  runtime_arrayStart();
+  printf("op,width,secret,impl,iterations,ns_per_op\n");
+  for (uint32_t width = 128; width <= maxWidth; width <<= 1) {
+    benchContext ctx;
+    initContext(&ctx, width, &seed);
+    for (uint32_t i = 0; i < sizeof(benchOps)/sizeof(benchOps[0]); i++) {
+      const benchOp *op = benchOps + i;
+      for (uint32_t secret = 0; secret <= 1; secret++) {
+        setContextSecret(&ctx, secret);
+        runBench(op->name, "rune", op->runtimeFunc, &ctx, secret, minSeconds);
+      }
+      runBench(op->name, "gmp", op->gmpFunc, &ctx, false, minSeconds);
+      if (op->gmpSecretFunc != NULL) {
+        runBench(op->name, "gmp", op->gmpSecretFunc, &ctx, true, minSeconds);
+      }
+    }
+    freeContext(&ctx);
+  }
+  runtime_arrayStop();
+  return 0;
+}
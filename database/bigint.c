@@ -437,6 +437,68 @@ deBigint deBigintModularReduce(deBigint a, deBigint modulus) {
   return result;
 }
 
+// Import an unsigned bigint into an initialized mpz_t.
+static void importUnsignedBigint(mpz_t val, deBigint bigint) {
+  utAssert(!deBigintNegative(bigint));
+  mpz_import(val, deBigintGetNumData(bigint), -1, 1, 0, 0, deBigintGetData(bigint));
+}
+
+// Export an mpz_t into a new unsigned bigint of the given width, and clear it.
+static deBigint exportUnsignedBigint(mpz_t val, uint32 width) {
+  deBigint result = bigintCreate(false, width);
+  mpz_export(deBigintGetData(result), NULL, -1, 1, 0, 0, val);
+  mpz_clear(val);
+  return result;
+}
+
+// If the modulus is of the form 2^k - c, where k >= 64 and c < 2^31, return c,
+// with the modulus' width.  Otherwise, return deBigintNull.
+deBigint deBigintFindPseudoMersenneOffset(deBigint modulus) {
+  mpz_t val, offset;
+  mpz_init(val);
+  mpz_init(offset);
+  importUnsignedBigint(val, modulus);
+  uint32 k = mpz_sizeinbase(val, 2);
+  mpz_setbit(offset, k);
+  mpz_sub(offset, offset, val);
+  bool found = k >= 64 && mpz_cmp_ui(offset, 1ul << 31) < 0;
+  mpz_clear(val);
+  if (!found) {
+    mpz_clear(offset);
+    return deBigintNull;
+  }
+  return exportUnsignedBigint(offset, deBigintGetWidth(modulus));
+}
+
+// Return R^2 mod modulus, where R = 2^(31*numLimbs).  This must match the
+// runtime's limb count for the modulus' width: 31-bit limbs with 2 spare bits.
+deBigint deBigintFindMontgomeryR2(deBigint modulus) {
+  uint32 width = deBigintGetWidth(modulus);
+  uint32 numLimbs = (width + 2 + 30)/31;
+  mpz_t val, r2;
+  mpz_init(val);
+  mpz_init(r2);
+  importUnsignedBigint(val, modulus);
+  mpz_setbit(r2, 62*numLimbs);
+  mpz_mod(r2, r2, val);
+  mpz_clear(val);
+  return exportUnsignedBigint(r2, width);
+}
+
+// Return mu = floor(4^k/modulus), where k is the bit length of the modulus.
+// This is one bit wider than the modulus.
+deBigint deBigintFindBarrettMu(deBigint modulus) {
+  mpz_t val, mu;
+  mpz_init(val);
+  mpz_init(mu);
+  importUnsignedBigint(val, modulus);
+  utAssert(mpz_sgn(val) != 0);
+  mpz_setbit(mu, 2*mpz_sizeinbase(val, 2));
+  mpz_fdiv_q(mu, mu, val);
+  mpz_clear(val);
+  return exportUnsignedBigint(mu, deBigintGetWidth(modulus) + 1);
+}
+
 // Make a new bigint with the new size.  If truncation changes the value, report an error.
 deBigint deBigintResize(deBigint bigint, uint32 width, deLine line) {
   deBigint result = bigintCreate(deBigintSigned(bigint), width);
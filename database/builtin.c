@@ -22,13 +22,16 @@ deTclass deArrayTclass, deFuncptrTclass, deFunctionTclass, deBoolTclass, deStrin
 
 // Builtin methods.
 static deFunction deArrayLengthFunc, deArrayResizeFunc, deArrayAppendFunc,
-    deArrayConcatFunc, deArrayReverseFunc, deStringLengthFunc,
+    deArrayConcatFunc, deArrayReverseFunc, deArrayBatchModMulFunc,
+    deArrayBatchModExpFunc, deArrayFixedBaseExpFunc, deStringLengthFunc,
     deStringResizeFunc, deStringAppendFunc, deStringConcatFunc,
     deStringReverseFunc, deStringToUintLEFunc, deUintToStringLEFunc,
     deStringToUintBEFunc, deUintToStringBEFunc, deStringToHexFunc,
     deHexToStringFunc, deFindFunc, deRfindFunc, deArrayToStringFunc,
     deBoolToStringFunc, deUintToStringFunc, deIntToStringFunc,
-    deTupleToStringFunc, deStructToStringFunc, deEnumToStringFunc;
+    deTupleToStringFunc, deStructToStringFunc, deEnumToStringFunc,
+    deUintFixedBaseTableFunc, deStringSha256Func, deStringHmacSha256Func, deStringSha3Func,
+    deStringHashFunc, deUintHashFunc, deIntHashFunc;
 
 deTclass deFindTypeTclass(deDatatypeType type) {
   switch (type) {
@@ -129,6 +132,12 @@ void deBuiltinStart(void) {
   deArrayConcatFunc = addMethod(deArrayTclass, DE_BUILTINFUNC_ARRAYCONCAT, "concat", 1, "array");
   deArrayReverseFunc = addMethod(deArrayTclass, DE_BUILTINFUNC_ARRAYREVERSE, "reverse", 0);
   deArrayToStringFunc = addMethod(deArrayTclass, DE_BUILTINFUNC_ARRAYTOSTRING, "toString", 0);
+  deArrayBatchModMulFunc = addMethod(deArrayTclass, DE_BUILTINFUNC_ARRAYBATCHMODMUL,
+      "batchModMul", 2, "other", "modulus");
+  deArrayBatchModExpFunc = addMethod(deArrayTclass, DE_BUILTINFUNC_ARRAYBATCHMODEXP,
+      "batchModExp", 2, "exponents", "modulus");
+  deArrayFixedBaseExpFunc = addMethod(deArrayTclass, DE_BUILTINFUNC_ARRAYFIXEDBASEEXP,
+      "fixedBaseExp", 1, "exponent");
   createBuiltinTclass("Funcptr", DE_BUILTINTCLASS_FUNCPTR, 2, "function", "parameterArray");
   // TODO: upgrade Function constructor to take statement expression and
   // construct the function.  This would implement lambda expressions.
@@ -150,6 +159,11 @@ void deBuiltinStart(void) {
      "toUintBE", 1, "width");
   deStringToHexFunc = addMethod(deStringTclass, DE_BUILTINFUNC_STRINGTOHEX, "toHex", 0);
   deHexToStringFunc = addMethod(deStringTclass, DE_BUILTINFUNC_HEXTOSTRING, "fromHex", 0);
+  deStringSha256Func = addMethod(deStringTclass, DE_BUILTINFUNC_STRINGSHA256, "sha256", 0);
+  deStringHmacSha256Func = addMethod(deStringTclass, DE_BUILTINFUNC_STRINGHMACSHA256,
+      "hmacSha256", 1, "message");
+  deStringSha3Func = addMethod(deStringTclass, DE_BUILTINFUNC_STRINGSHA3, "sha3", 0);
+  deStringHashFunc = addMethod(deStringTclass, DE_BUILTINFUNC_STRINGHASH, "hash", 0);
   deFindFunc = addMethod(deStringTclass, DE_BUILTINFUNC_FIND, "find", 2, "subString", "offset");
   setParameterDefault(deFindFunc, 2, deIntegerExpressionCreate(deNativeUintBigintCreate(0), 0));
   deRfindFunc = addMethod(deStringTclass, DE_BUILTINFUNC_RFIND, "rfind", 2, "subString", "offset");
@@ -159,10 +173,14 @@ void deBuiltinStart(void) {
   deUintToStringLEFunc = addMethod(deUintTclass, DE_BUILTINFUNC_UINTTOSTRINGLE, "toStringLE", 0);
   deUintToStringBEFunc = addMethod(deUintTclass, DE_BUILTINFUNC_UINTTOSTRINGBE, "toStringBE", 0);
   deUintToStringFunc = addMethod(deUintTclass, DE_BUILTINFUNC_UINTTOSTRING, "toString", 1, "base");
+  deUintFixedBaseTableFunc = addMethod(deUintTclass, DE_BUILTINFUNC_UINTFIXEDBASETABLE,
+      "fixedBaseTable", 1, "modulus");
+  deUintHashFunc = addMethod(deUintTclass, DE_BUILTINFUNC_UINTHASH, "hash", 0);
   setParameterDefault(deUintToStringFunc, 1, deIntegerExpressionCreate(deNativeUintBigintCreate(10), 0));
   deIntTclass = createBuiltinTclass("Int", DE_BUILTINTCLASS_INT, 1, "value");
   deIntToStringFunc = addMethod(deIntTclass, DE_BUILTINFUNC_INTTOSTRING, "toString", 1, "base");
   setParameterDefault(deIntToStringFunc, 1, deIntegerExpressionCreate(deNativeUintBigintCreate(10), 0));
+  deIntHashFunc = addMethod(deIntTclass, DE_BUILTINFUNC_INTHASH, "hash", 0);
   deFloatTclass = createBuiltinTclass("Float", DE_BUILTINTCLASS_FLOAT, 1, "value");
   deModintTclass = createBuiltinTclass("Modint", DE_BUILTINTCLASS_MODINT, 1, "value");
   deTupleTclass = createBuiltinTclass("Tuple", DE_BUILTINTCLASS_TUPLE, 1, "value");
@@ -178,6 +196,50 @@ void deBuiltinStart(void) {
 void deBuiltinStop(void) {
 }
 
+// Determine if the datatype is an unsigned integer wider than 64 bits, whether
+// it is a native wide integer or a bigint.
+static bool datatypeIsWideUint(deDatatype datatype) {
+  return deDatatypeGetType(datatype) == DE_TYPE_UINT && deDatatypeGetWidth(datatype) > 64;
+}
+
+// Bind Array.batchModMul and Array.batchModExp.  These compute k independent
+// modular multiplications or exponentiations sharing one public modulus in
+// parallel.  Arrays of native wide integers are converted to bigints when
+// passed to the runtime.
+static deDatatype bindBatchModularMethod(deFunction function,
+    deDatatypeArray parameterTypes, deLine line) {
+  char *name = function == deArrayBatchModMulFunc? "batchModMul" : "batchModExp";
+  if (deDatatypeArrayGetUsedDatatype(parameterTypes) != 3) {
+    deError(line, "Array.%s requires an array and a modulus", name);
+  }
+  deDatatype selfType = deDatatypeArrayGetiDatatype(parameterTypes, 0);
+  deDatatype otherType = deDatatypeArrayGetiDatatype(parameterTypes, 1);
+  deDatatype modulusType = deDatatypeArrayGetiDatatype(parameterTypes, 2);
+  deDatatype elementType = deDatatypeGetElementType(selfType);
+  if (!datatypeIsWideUint(elementType)) {
+    deError(line, "Array.%s requires an array of Uints wider than 64 bits", name);
+  }
+  if (deDatatypeGetType(otherType) != DE_TYPE_ARRAY) {
+    deError(line, "Array.%s requires an array parameter", name);
+  }
+  deDatatype otherElementType = deDatatypeGetElementType(otherType);
+  if (function == deArrayBatchModMulFunc) {
+    if (deSetDatatypeSecret(otherElementType, false) != deSetDatatypeSecret(elementType, false)) {
+      deError(line, "Array.batchModMul passed an array with a different element type");
+    }
+  } else if (!datatypeIsWideUint(otherElementType)) {
+    deError(line, "Array.batchModExp requires an array of Uints wider than 64 bits");
+  }
+  if (deSetDatatypeSecret(modulusType, false) != deSetDatatypeSecret(elementType, false)) {
+    deError(line, "Array.%s modulus must have the same type as the array elements", name);
+  }
+  if (deDatatypeSecret(modulusType)) {
+    deError(line, "Array.%s modulus cannot be secret", name);
+  }
+  bool secret = deDatatypeSecret(elementType) || deDatatypeSecret(otherElementType);
+  return deArrayDatatypeCreate(deSetDatatypeSecret(elementType, secret));
+}
+
 // Bind builtin methods of arrays.
 static deDatatype bindArrayBuiltinMethod(deBlock scopeBlock, deExpression expression,
     deFunction function, deDatatypeArray parameterTypes, deLine line) {
@@ -212,6 +274,20 @@ static deDatatype bindArrayBuiltinMethod(deBlock scopeBlock, deExpression expres
     return deNoneDatatypeCreate();
   } else if (function == deArrayToStringFunc) {
     return deStringDatatypeCreate();
+  } else if (function == deArrayBatchModMulFunc || function == deArrayBatchModExpFunc) {
+    return bindBatchModularMethod(function, parameterTypes, line);
+  } else if (function == deArrayFixedBaseExpFunc) {
+    // The table is built by Uint.fixedBaseTable.
+    deDatatype elementType = deDatatypeGetElementType(selfType);
+    if (!datatypeIsWideUint(elementType)) {
+      deError(line, "Array.fixedBaseExp requires a table built by Uint.fixedBaseTable");
+    }
+    if (deDatatypeGetType(paramType) != DE_TYPE_UINT ||
+        deDatatypeGetWidth(paramType) > deDatatypeGetWidth(elementType)) {
+      deError(line, "Array.fixedBaseExp requires a Uint exponent no wider than the modulus");
+    }
+    bool secret = deDatatypeSecret(elementType) || deDatatypeSecret(paramType);
+    return deSetDatatypeSecret(elementType, secret);
   }
   utExit("Unknown builtin Array method");
   return deDatatypeNull;  // Dummy return;
@@ -269,6 +345,18 @@ static deDatatype bindStringBuiltinMethod(deFunction function,
     return deSetDatatypeSecret(paramType, secret);
   } else if (function == deStringToHexFunc || function == deHexToStringFunc) {
     return selfType;
+  } else if (function == deStringSha256Func || function == deStringSha3Func) {
+    // Hashing is constant time, so the digest is secret if the data is.
+    return deSetDatatypeSecret(deStringDatatypeCreate(), deDatatypeSecret(selfType));
+  } else if (function == deStringHmacSha256Func) {
+    if (deDatatypeGetType(paramType) != DE_TYPE_STRING) {
+      deError(line, "String.hmacSha256 requires a string message");
+    }
+    bool secret = deDatatypeSecret(selfType) || deDatatypeSecret(paramType);
+    return deSetDatatypeSecret(deStringDatatypeCreate(), secret);
+  } else if (function == deStringHashFunc) {
+    // The hash time depends only on the length, so it is secret if the data is.
+    return deSetDatatypeSecret(deUintDatatypeCreate(64), deDatatypeSecret(selfType));
   } else if (function == deFindFunc || function == deRfindFunc) {
     if (deDatatypeSecret(selfType) || deDatatypeSecret(paramType)) {
       deError(line, "Cannot search for substrings in secret strings");
@@ -300,6 +388,22 @@ static deDatatype bindUintBuiltinMethod(deFunction function,
       deError(line, "Int.toString(base) requires a Uint base parameter");
     }
     return deStringDatatypeCreate();
+  } else if (function == deUintFixedBaseTableFunc) {
+    // The table is an array of the modulus's type: the modulus, then the comb
+    // entries.
+    deDatatype paramType = deDatatypeArrayGetiDatatype(parameterTypes, 1);
+    if (!datatypeIsWideUint(selfType)) {
+      deError(line, "Uint.fixedBaseTable requires a Uint wider than 64 bits");
+    }
+    if (deSetDatatypeSecret(paramType, false) != deSetDatatypeSecret(selfType, false)) {
+      deError(line, "Uint.fixedBaseTable modulus must have the same type as the base");
+    }
+    if (deDatatypeSecret(paramType)) {
+      deError(line, "Uint.fixedBaseTable modulus cannot be secret");
+    }
+    return deArrayDatatypeCreate(selfType);
+  } else if (function == deUintHashFunc) {
+    return deSetDatatypeSecret(deUintDatatypeCreate(64), deDatatypeSecret(selfType));
   }
   utExit("Unknown builtin Uint method");
   return deDatatypeNull;  // Dummy return;
@@ -319,6 +423,8 @@ static deDatatype bindIntBuiltinMethod(deFunction function,
       deError(line, "Int.toString(base) requires a Uint base parameter");
     }
     return deStringDatatypeCreate();
+  } else if (function == deIntHashFunc) {
+    return deSetDatatypeSecret(deUintDatatypeCreate(64), deDatatypeSecret(selfType));
   }
   utExit("Unknown builtin Int method");
   return deDatatypeNull;  // Dummy return;
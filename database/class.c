@@ -69,7 +69,47 @@ static void addDestroyMethod(deTclass tclass) {
   deVariableCreate(functionBlock, DE_VAR_PARAMETER, true, paramName, deExpressionNull, false, line);
 }
 
-// Create a new class object.  Add a destroy method.  The tclass is a child of
+// Add the compact method to the tclass.  It takes no self parameter, and is
+// called as <Tclass>.compact().  The code generator fills in the body, which
+// renumbers live objects densely and shrinks the data member arrays.  It
+// rewrites references held in data members and globals, but not in locals, so
+// callers must not hold references to the class's objects in locals across the
+// call.
+static void addCompactMethod(deTclass tclass) {
+  deBlock classBlock = deFunctionGetSubBlock(deTclassGetFunction(tclass));
+  deLine line = deBlockGetLine(classBlock);
+  utSym funcName = utSymCreate("compact");
+  deLinkage linkage = deFunctionGetLinkage(deTclassGetFunction(tclass));
+  deFunctionCreate(deBlockGetFilepath(classBlock), classBlock, DE_FUNC_COMPACTOR, funcName,
+      linkage, line);
+}
+
+// Add the allocateMany method to the tclass, called as
+// <Tclass>.allocateMany(numObjects).  The code generator fills in the body,
+// which reserves numObjects consecutive objects, growing the data member arrays
+// at most once, and returns the index of the first.  The next numObjects
+// constructor calls take them in order.  The reservation ends when the calling
+// function returns, or at the next allocateMany call.  The return statement
+// here only gives the method its u64 return type.
+static void addAllocateManyMethod(deTclass tclass) {
+  deBlock classBlock = deFunctionGetSubBlock(deTclassGetFunction(tclass));
+  deLine line = deBlockGetLine(classBlock);
+  utSym funcName = utSymCreate("allocateMany");
+  deLinkage linkage = deFunctionGetLinkage(deTclassGetFunction(tclass));
+  deFunction function = deFunctionCreate(deBlockGetFilepath(classBlock), classBlock,
+      DE_FUNC_ALLOCATOR, funcName, linkage, line);
+  deBlock functionBlock = deFunctionGetSubBlock(function);
+  utSym paramName = utSymCreate("numObjects");
+  deVariable parameter = deVariableCreate(functionBlock, DE_VAR_PARAMETER, true, paramName,
+      deExpressionNull, false, line);
+  deExpression typeExpr = deExpressionCreate(DE_EXPR_UINTTYPE, line);
+  deExpressionSetWidth(typeExpr, 64);
+  deVariableInsertTypeExpression(parameter, typeExpr);
+  deStatement retStatement = deStatementCreate(functionBlock, DE_STATEMENT_RETURN, line);
+  deStatementInsertExpression(retStatement, deIdentExpressionCreate(paramName, line));
+}
+
+// Create a new class object.  Add destroy, compact, and allocateMany methods.  The tclass is a child of
 // its constructor function, essentially implementing inheritance through
 // composition.
 deTclass deTclassCreate(deFunction constructor, uint32 refWidth, deLine line) {
@@ -81,6 +121,8 @@ deTclass deTclassCreate(deFunction constructor, uint32 refWidth, deLine line) {
   deFunctionInsertTclass(constructor, tclass);
   if (!deFunctionBuiltin(constructor)) {
     addDestroyMethod(tclass);
+    addCompactMethod(tclass);
+    addAllocateManyMethod(tclass);
   }
   deRootAppendTclass(deTheRoot, tclass);
   return tclass;
@@ -243,6 +285,13 @@ deTclass deCopyTclass(deTclass tclass, deFunction destConstructor) {
   return deTclassCreate(destConstructor, deTclassGetRefWidth(tclass), deTclassGetLine(tclass));
 }
 
+// Create a field group.  The caller adds it to a tclass or class.
+deFieldGroup deFieldGroupCreate(deLine line) {
+  deFieldGroup group = deFieldGroupAlloc();
+  deFieldGroupSetLine(group, line);
+  return group;
+}
+
 // Build a tuple expression for the class members.  Bind types as we go.
 static deExpression buildClassTupleExpression(deBlock classBlock, deExpression selfExpr) {
   deExpression tupleExpr = deExpressionCreate(DE_EXPR_TUPLE, deExpressionGetLine(selfExpr));
@@ -131,7 +131,7 @@ static inline deDatatype datatypeCreate(deDatatypeType type, uint32 width, bool
   deDatatypeSetType(datatype, type);
   deDatatypeSetWidth(datatype, width);
   if (type == DE_TYPE_ARRAY || type == DE_TYPE_STRING ||
-      (deDatatypeTypeIsInteger(type) && width > 64)) {
+      (deDatatypeTypeIsInteger(type) && width > deMaxNativeIntWidth)) {
     deDatatypeSetContainsArray(datatype, true);
   }
   deDatatypeSetConcrete(datatype, concrete);
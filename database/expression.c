@@ -742,6 +742,9 @@ deExpression deCopyExpression(deExpression expression) {
     case DE_EXPR_INTTYPE:
       deExpressionSetWidth(newExpression, deExpressionGetWidth(expression));
       break;
+    case DE_EXPR_MODINT:
+      deExpressionSetReductionType(newExpression, deExpressionGetReductionType(expression));
+      break;
     default:
       break;
   }
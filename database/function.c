@@ -30,6 +30,10 @@ char *deGetFunctionTypeName(deFunctionType type) {
       return "constructor";
     case DE_FUNC_DESTRUCTOR:
       return "destructor";
+    case DE_FUNC_COMPACTOR:
+      return "compactor";
+    case DE_FUNC_ALLOCATOR:
+      return "allocator";
     case DE_FUNC_PACKAGE:  // Initializes all modules in the package.
       return "package";
     case DE_FUNC_MODULE:  // Initializes the module.
@@ -103,6 +103,8 @@ deDatatype deGetIdentDatatype(deIdent ident) {
         case DE_FUNC_UNITTEST:
         case DE_FUNC_FINAL:
         case DE_FUNC_DESTRUCTOR:
+        case DE_FUNC_COMPACTOR:
+        case DE_FUNC_ALLOCATOR:
         case DE_FUNC_PACKAGE:
         case DE_FUNC_MODULE:
         case DE_FUNC_ITERATOR:
@@ -28,12 +28,16 @@ extern "C" {
 // The root object.
 extern deRoot deTheRoot;
 
+// The default value of deMaxNativeIntWidth, settable with -w.
+#define DE_DEFAULT_MAX_NATIVE_INT_WIDTH 256
+
 // Main functions.
 void deStart(char *fileName);
 void deStop(void);
 void deRunGenerators(void);
 deValue deEvaluateExpression(deBlock scopeBlock, deExpression expression, deBigint modulus);
 void deAddMemoryManagement(void);
+void deReadFieldProfile(char *fileName);
 void deParseBuiltinFunctions(void);
 deBlock deParseModule(char *fileName, deBlock destPackageBlock, bool isMainModule);
 void deParseString(char *string, deBlock currentBlock);
@@ -56,6 +60,7 @@ void deBind(void);
 void deBindNewStatement(deBlock scopeBlock, deStatement statement);
 void deBindBlock(deBlock block, deSignature signature, bool inlineIterators);
 void deBindExpression(deBlock scopeBlock, deExpression expression);
+void deFindRegionObjects(void);
 
 // Block methods.
 deBlock deBlockCreate(deFilepath filepath, deBlockType type, deLine line);
@@ -138,6 +143,7 @@ deTclass deCopyTclass(deTclass tclass, deFunction destConstructor);
 deFunction deGenerateDefaultToStringMethod(deClass theClass);
 deFunction deGenerateDefaultDumpMethod(deClass theClass);
 deFunction deClassFindMethod(deClass theClass, utSym methodSym);
+deFieldGroup deFieldGroupCreate(deLine line);
 static inline utSym deTclassGetSym(deTclass tclass) {
   return deFunctionGetSym(deTclassGetFunction(tclass));
 }
@@ -266,6 +272,9 @@ deBigint deBigintAdd(deBigint a, deBigint b);
 deBigint deBigintSub(deBigint a, deBigint b);
 deBigint deBigintNegate(deBigint a);
 deBigint deBigintModularReduce(deBigint a, deBigint modulus);
+deBigint deBigintFindPseudoMersenneOffset(deBigint modulus);
+deBigint deBigintFindMontgomeryR2(deBigint modulus);
+deBigint deBigintFindBarrettMu(deBigint modulus);
 void deWriteBigint(FILE *file, deBigint bigint);
 char *deBigintToString(deBigint bigint, uint32 base);
 void deDumpBigint(deBigint bigint);
@@ -478,9 +487,16 @@ extern char *deExeName;
 extern char *deLibDir;
 extern char *dePackageDir;
 extern bool deUnsafeMode;
+// Integers up to this width are native LLVM integers.  Wider integers are
+// CTTK bigints in runtime arrays.
+extern uint32 deMaxNativeIntWidth;
 extern bool deDebugMode;
 extern bool deInvertReturnCode;
 extern char *deLLVMFileName;
+// Instrument class data member accesses to write a profile to this file.
+extern char *deFieldProfileGenFile;
+// Order class data member arrays by the access counts in this profile.
+extern char *deFieldProfileUseFile;
 extern bool deTestMode;
 extern uint32 deStackPos;
 extern char *deStringVal;
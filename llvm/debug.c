@@ -308,7 +308,7 @@ static llTag createDatatypeTag(deDatatype datatype) {
   }
   char *text = NULL;
   deDatatypeType type = deDatatypeGetType(datatype);
-  if (deDatatypeTypeIsInteger(type) && deDatatypeGetWidth(datatype) > llSizeWidth) {
+  if (llDatatypeIsBigint(datatype)) {
     return createArrayTypeTag(datatype);
   }
   switch (type) {
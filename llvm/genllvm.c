@@ -55,7 +55,28 @@ static deLine llCurrentLine;
 // Helps us generate only one call the runtime_throwException for bounds checking per function.
 static utSym llLimitCheckFailedLabel;
 static utSym llBoundsCheckFailedLabel;
+static utSym llOverflowCheckFailedLabel;
 static utSym llPrevLabel;  // Most recently printed label: used in phi instructions.
+// The innermost modint expression being generated, for its reduction constant.
+static deExpression llModintExpression;
+// Set when no statement in the current function can destroy an object, so
+// reference counted locals can borrow their objects without ref/unref calls.
+static bool llBorrowLocals;
+// Classes with objects allocated in the current function's region, and the
+// value of each class's region head on entry, which is its mark.
+typedef struct {
+  deClass theClass;
+  uint32 mark;
+} llRegion;
+
+static llRegion *llRegions;
+static uint32 llRegionsAllocated;
+static uint32 llNumRegions;
+// Tclasses whose allocateMany the current function calls.  Their reservations
+// end when the function returns.
+static deTclass *llReservingTclasses;
+static uint32 llReservingTclassesAllocated;
+static uint32 llNumReservingTclasses;
 
 typedef struct {
   deDatatype datatype;
@@ -195,6 +216,10 @@ static inline llElement createElement(deDatatype datatype, char *name, bool isRe
 static  utSym  generateBlockStatements(deBlock block, utSym label);
 static void generateExpression(deExpression expression);
 static void generateModularExpression(deExpression expression, llElement modulusElement);
+static llElement toBigint(llElement element, bool secret);
+static void convertTopFromBigint(void);
+static utSym newLabel(char *name);
+static void overflowCheck(llElement overflowed);
 
 // Return the string "true" or "false" to represent a Boolean value.
 static inline char *boolVal(bool value) {
@@ -474,7 +499,7 @@ static inline void pushInteger(deExpression expression) {
   deBigint bigint = deExpressionGetBigint(expression);
   // Get width from datatype in case this integer was auto-cast to a different width.
   uint32 width = deDatatypeGetWidth(deExpressionGetDatatype(expression));
-  if (width > llSizeWidth) {
+  if (width > deMaxNativeIntWidth) {
     pushBigint(expression);
     return;
   }
@@ -605,6 +630,28 @@ static void generateCallToFreeFunc() {
       llGetVariableName(selfVar), locationInfo());
 }
 
+// Classes with a cascade-delete parent are destroyed from a worklist.  Call
+// <class>_startDestroy, and return right away if it queued self to be destroyed
+// later by the outermost destructor of the class.
+static void generateCallToStartDestroy(deBlock block) {
+  deVariable selfVar = deBlockGetFirstVariable(block);
+  deClass theClass = deDatatypeGetClass(deVariableGetDatatype(selfVar));
+  if (deTclassRefCounted(deClassGetTclass(theClass))) {
+    return;
+  }
+  deBlock classBlock = deClassGetSubBlock(theClass);
+  char* path = llEscapeIdentifier(utSprintf("%s_startDestroy", deGetBlockPath(classBlock, true)));
+  uint32 start = printNewValue();
+  llPrintf("call i1 @%s(i%u %s)%s\n", path, deClassGetRefWidth(theClass),
+      llGetVariableName(selfVar), locationInfo());
+  utSym destroyLabel = newLabel("destroy");
+  utSym queuedLabel = newLabel("destroyQueued");
+  llPrintf("  br i1 %%%u, label %%%s, label %%%s\n", start, utSymGetName(destroyLabel),
+      utSymGetName(queuedLabel));
+  llPrintf("%s:\n  ret void\n%s:\n", utSymGetName(queuedLabel), utSymGetName(destroyLabel));
+  llPrevLabel = destroyLabel;
+}
+
 // Return a default value string for the type.
 static char *getDefaultValue(deDatatype datatype) {
   switch (deDatatypeGetType(datatype)) {
@@ -650,7 +697,8 @@ static void initializeLocalVariable(deVariable variable) {
   if (deDatatypeContainsArray(datatype)) {
     llElement element = createElement(datatype, varName, true);
     addNeedsFreeElement(element);
-  } else if (!deVariableGenerated(variable) && isRefCounted(datatype)) {
+  } else if (!deVariableGenerated(variable) && isRefCounted(datatype) && !llBorrowLocals &&
+      !deVariableRegion(variable)) {
     llElement element = createElement(datatype, varName, true);
     addNeedsFreeElement(element);
   }
@@ -663,11 +711,18 @@ static void initializeLocalVariable(deVariable variable) {
 static void printMainTop(void) {
   llDeclareRuntimeFunction("runtime_arrayStart");
   llDeclareRuntimeFunction("runtime_initArrayFromC");
+  llDeclareRuntimeFunction("runtime_setMaxWideIntWidth");
   llVarNum += 2;  // For argc and argv.
   llPrevLabel = utSymCreate("2");
   llPrintf(
       "  call void @runtime_arrayStart()\n"
-      "  call void @runtime_initArrayOfStringsFromC(%%struct.runtime_array* @argv, i8** %%1, i32 %%0)\n");
+      "  call void @runtime_setMaxWideIntWidth(i32 %u)\n"
+      "  call void @runtime_initArrayOfStringsFromC(%%struct.runtime_array* @argv, i8** %%1, i32 %%0)\n",
+      deMaxNativeIntWidth);
+  llPrintf("  call void @.startClassStats()\n");
+  if (deFieldProfileGenFile != NULL) {
+    llPrintf("  call void @.startFieldProfile()\n");
+  }
 }
 
 // Declare parameter values so they are visible in gdb.
@@ -782,6 +837,8 @@ static void printFunctionHeader(deBlock block, deSignature signature) {
   llNumLocalsNeedingFree = llNeedsFreePos;
   if (signature == deSignatureNull) {
     printMainTop();
+  } else if (deFunctionGetType(deSignatureGetFunction(signature)) == DE_FUNC_DESTRUCTOR) {
+    generateCallToStartDestroy(block);
   }
 }
 
@@ -839,6 +896,15 @@ static llElement allocateTempValue(deDatatype datatype) {
   return *result;
 }
 
+// Allocate the destination of a call to the bigint runtime.  Wide integers are
+// emulated in a temporary bigint, and converted back with convertTopFromBigint.
+static llElement allocateBigintResult(deDatatype datatype) {
+  if (llDatatypeIsWideInt(datatype)) {
+    return allocateTempArray(datatype);
+  }
+  return allocateTempValue(datatype);
+}
+
 // Return the element type of the array.  For strings, return the uint8 type,
 // since strings are represented as arrays of uint8.  For bigints, return
 // uint32, since CTTK bigints are arrays of uint32.
@@ -914,13 +980,15 @@ static char *findBigintModularFunctionName(deExpression expression) {
 // Return the runtime function name that can execute this expression.
 static char *findExpressionFunction(deExpression expression) {
   deDatatype datatype = deExpressionGetDatatype(expression);
+  // Wide integers call the bigint runtime when emulated.
+  bool isBigint = llDatatypeIsBigint(datatype) || llDatatypeIsWideInt(datatype);
   if (deDatatypeGetType(datatype) == DE_TYPE_MODINT) {
-    if (llDatatypeIsBigint(datatype)) {
+    if (isBigint) {
       return findBigintModularFunctionName(expression);
     }
     return findSmallnumModularFunctionName(expression);
   }
-  if (!llDatatypeIsBigint(datatype)) {
+  if (!isBigint) {
     return findSmallnumFunction(expression);
   }
   switch (deExpressionGetType(expression)) {
@@ -983,18 +1051,23 @@ static runtime_comparisonType findBigintComparisonType(deExpression expression)
 // Generate code for a binary expression.
 static void generateBigintBinaryExpression(deExpression expression) {
   char *funcName = findExpressionFunction(expression);
+  deDatatype datatype = deExpressionGetDatatype(expression);
+  bool secret = deDatatypeSecret(datatype);
   deExpression left = deExpressionGetFirstExpression(expression);
   deExpression right = deExpressionGetNextExpression(left);
   generateExpression(left);
   llElement leftElement = popElement(true);
   generateExpression(right);
   llElement rightElement = popElement(true);
-  llElement destArray = allocateTempValue(deExpressionGetDatatype(expression));
+  leftElement = toBigint(leftElement, secret);
+  rightElement = toBigint(rightElement, secret);
+  llElement destArray = allocateBigintResult(datatype);
   llDeclareRuntimeFunction(funcName);
   llPrintf(
        "  call void @%s(%%struct.runtime_array* %s, %%struct.runtime_array* %s, %%struct.runtime_array* %s)%s\n",
       funcName, llElementGetName(destArray), llElementGetName(leftElement),
       llElementGetName(rightElement), locationInfo());
+  convertTopFromBigint();
 }
 
 // Find the size of a tuple using LLVM's pointer arithmetic.  This generates
@@ -1008,6 +1081,17 @@ static llElement findTupleSize(deDatatype datatype) {
   return createValueElement(llSizeType, size, false);
 }
 
+// Return the byte offset of the tuple's field at |index|.
+static llElement findTupleFieldOffset(deDatatype datatype, uint32 index) {
+  char *type = llGetTypeString(datatype, true);
+  char *fieldType = llGetTypeString(deDatatypeGetiTypeList(datatype, index), true);
+  uint32 tmpPtr = printNewValue();
+  llPrintf("getelementptr %s, %s* null, i32 0, i32 %u\n", type, type, index);
+  uint32 offset = printNewValue();
+  llPrintf("ptrtoint %s* %%%u to i%s\n", fieldType, tmpPtr, llSize);
+  return createValueElement(llSizeType, offset, false);
+}
+
 // Return the size element value of the datatype: NOT the size itself.
 // NOTE: This must be called stand-alone, not as an argument to fprintf, because
 // we have to instantiate a couple of lines of LLVM assembly to find the size of
@@ -1048,8 +1132,11 @@ static llElement findDatatypeSize(deDatatype datatype) {
     case DE_TYPE_UINT:
     case DE_TYPE_INT: {
       uint32_t width = deDatatypeGetWidth(datatype);
-      if (deDatatypeGetWidth(datatype) > sizeof(size_t) << 3) {
+      if (llDatatypeIsBigint(datatype)) {
         return createSmallInteger(sizeof(runtime_array), llSizeWidth, false);
+      } else if (width > sizeof(uint64_t) << 3) {
+        // LLVM rounds wide integers up to a multiple of 64 bits in memory.
+        return createSmallInteger(((width + 63) / 64) * sizeof(uint64_t), llSizeWidth, false);
       } else if (width > 32) {
         return createSmallInteger(sizeof(uint64_t), llSizeWidth, false);
       } else if (width > 16) {
@@ -1298,6 +1385,181 @@ static void generateOperatorOverloadCall(deExpression expression, deSignature si
   }
 }
 
+// Return true if the wide integer expression must be emulated with the bigint
+// runtime.  Secret values always are, since the runtime is constant time.  LLVM
+// cannot lower division wider than 128 bits, so wider division is emulated too.
+static bool wideIntNeedsRuntime(deExpression expression) {
+  deDatatype datatype = deExpressionGetDatatype(expression);
+  deExpressionType type = deExpressionGetType(expression);
+  if (!llDatatypeIsWideInt(datatype)) {
+    return false;
+  }
+  if (deDatatypeSecret(datatype)) {
+    return true;
+  }
+  return (type == DE_EXPR_DIV || type == DE_EXPR_MOD) && deDatatypeGetWidth(datatype) > 128;
+}
+
+// Generate a wide add, sub, or mul that throws an exception on overflow, like
+// the bigint runtime does.  |op| is "add", "sub", or "mul".
+static void generateCheckedWideArithmetic(deDatatype datatype, char *op,
+    llElement leftElement, llElement rightElement) {
+  uint32 width = deDatatypeGetWidth(datatype);
+  char *intrinsic = utSprintf("%s%s", deDatatypeSigned(datatype)? "s" : "u", op);
+  llDeclareOverloadedFunction(utSprintf(
+      "declare {i%u, i1} @llvm.%s.with.overflow.i%u(i%u, i%u)\n",
+      width, intrinsic, width, width, width));
+  char *location = locationInfo();
+  uint32 pair = printNewValue();
+  llPrintf("call {i%u, i1} @llvm.%s.with.overflow.i%u(i%u %s, i%u %s)%s\n",
+      width, intrinsic, width, width, llElementGetName(leftElement), width,
+      llElementGetName(rightElement), location);
+  uint32 value = printNewValue();
+  llPrintf("extractvalue {i%u, i1} %%%u, 0%s\n", width, pair, location);
+  uint32 overflowed = printNewValue();
+  llPrintf("extractvalue {i%u, i1} %%%u, 1%s\n", width, pair, location);
+  overflowCheck(createValueElement(deBoolDatatypeCreate(), overflowed, false));
+  pushValue(datatype, value, false);
+}
+
+// Allocate a stack slot of type i<width>, and initialize it here rather than at
+// the top of the function, so a loop re-initializes it each time it runs.
+static uint32 allocateLocalSlot(uint32 width, uint64 initialValue) {
+  uint32 slot = printNewTmpValue();
+  llTmpPrintf("alloca i%u\n", width);
+  llPrintf("  store i%u %llu, i%u* %%.tmp%u\n", width, initialValue, width, slot);
+  return slot;
+}
+
+// Return true if this is a secret integer division or mod that should be
+// computed inline in constant time.  Native division leaks the operands
+// through its timing.
+static bool isSecretSmallnumDivide(deExpression expression) {
+  deExpressionType type = deExpressionGetType(expression);
+  if (type != DE_EXPR_DIV && type != DE_EXPR_MOD) {
+    return false;
+  }
+  deDatatype datatype = deExpressionGetDatatype(expression);
+  deDatatypeType datatypeType = deDatatypeGetType(datatype);
+  return deDatatypeSecret(datatype) && deDatatypeGetWidth(datatype) <= 64 &&
+      (datatypeType == DE_TYPE_UINT || datatypeType == DE_TYPE_INT);
+}
+
+// Replace the value with its absolute value, and return the sign mask, which
+// is -1 if the value was negative and 0 otherwise.
+static uint32 generateAbsoluteValue(llElement *value, uint32 width) {
+  char *name = llElementGetName(*value);
+  uint32 sign = printNewValue();
+  llPrintf("ashr i%u %s, %u%s\n", width, name, width - 1, locationInfo());
+  uint32 flipped = printNewValue();
+  llPrintf("xor i%u %s, %%%u%s\n", width, name, sign, locationInfo());
+  uint32 absValue = printNewValue();
+  llPrintf("sub i%u %%%u, %%%u%s\n", width, flipped, sign, locationInfo());
+  *value = createValueElement(llElementGetDatatype(*value), absValue, false);
+  return sign;
+}
+
+// Generate a constant-time division or mod of secret integers as an inline
+// shift-and-subtract loop.  The loop always runs |width| iterations, and the
+// conditional subtraction uses a mask rather than a branch or select.  The
+// remainder is kept in width + 1 bits so the borrow out of the trial
+// subtraction is its top bit.  A reciprocal would need a division of its own
+// for a variable divisor, so it does not help here.  Signed division divides
+// the absolute values and fixes the sign of the quotient.  Mod treats the
+// operands as unsigned, like the urem generated for public values.  Division
+// by zero returns all ones, and the dividend as the remainder.
+static void generateSecretDivide(deDatatype datatype, llElement leftElement,
+    llElement rightElement, bool isMod) {
+  uint32 width = deDatatypeGetWidth(datatype);
+  uint32 wide = width + 1;
+  bool isSigned = deDatatypeSigned(datatype) && !isMod;
+  uint32 quotientSign = 0;
+  if (isSigned) {
+    uint32 dividendSign = generateAbsoluteValue(&leftElement, width);
+    uint32 divisorSign = generateAbsoluteValue(&rightElement, width);
+    quotientSign = printNewValue();
+    llPrintf("xor i%u %%%u, %%%u%s\n", width, dividendSign, divisorSign, locationInfo());
+  }
+  char *dividend = llElementGetName(leftElement);
+  uint32 wideDivisor = printNewValue();
+  llPrintf("zext i%u %s to i%u%s\n", width, llElementGetName(rightElement), wide,
+      locationInfo());
+  uint32 remainderSlot = allocateLocalSlot(wide, 0);
+  uint32 quotientSlot = allocateLocalSlot(width, 0);
+  uint32 counterSlot = allocateLocalSlot(width, width);
+  utSym loopLabel = newLabel("secretDivLoop");
+  utSym doneLabel = newLabel("secretDivDone");
+  llPrintf("  br label %%%s\n", utSymGetName(loopLabel));
+  llPrintf("%s:\n", utSymGetName(loopLabel));
+  // Decrement the counter, and shift the next dividend bit into the remainder.
+  uint32 counter = printNewValue();
+  llPrintf("load i%u, i%u* %%.tmp%u\n", width, width, counterSlot);
+  uint32 bitPos = printNewValue();
+  llPrintf("sub i%u %%%u, 1\n", width, counter);
+  llPrintf("  store i%u %%%u, i%u* %%.tmp%u\n", width, bitPos, width, counterSlot);
+  uint32 shifted = printNewValue();
+  llPrintf("lshr i%u %s, %%%u\n", width, dividend, bitPos);
+  uint32 bit = printNewValue();
+  llPrintf("and i%u %%%u, 1\n", width, shifted);
+  uint32 wideBit = printNewValue();
+  llPrintf("zext i%u %%%u to i%u\n", width, bit, wide);
+  uint32 oldRemainder = printNewValue();
+  llPrintf("load i%u, i%u* %%.tmp%u\n", wide, wide, remainderSlot);
+  uint32 doubled = printNewValue();
+  llPrintf("shl i%u %%%u, 1\n", wide, oldRemainder);
+  uint32 remainder = printNewValue();
+  llPrintf("or i%u %%%u, %%%u\n", wide, doubled, wideBit);
+  // Trial subtract.  The mask is all ones if the remainder >= the divisor.
+  uint32 difference = printNewValue();
+  llPrintf("sub i%u %%%u, %%%u\n", wide, remainder, wideDivisor);
+  uint32 borrow = printNewValue();
+  llPrintf("lshr i%u %%%u, %u\n", wide, difference, width);
+  uint32 mask = printNewValue();
+  llPrintf("sub i%u %%%u, 1\n", wide, borrow);
+  uint32 changed = printNewValue();
+  llPrintf("xor i%u %%%u, %%%u\n", wide, remainder, difference);
+  uint32 maskedChange = printNewValue();
+  llPrintf("and i%u %%%u, %%%u\n", wide, changed, mask);
+  uint32 newRemainder = printNewValue();
+  llPrintf("xor i%u %%%u, %%%u\n", wide, remainder, maskedChange);
+  llPrintf("  store i%u %%%u, i%u* %%.tmp%u\n", wide, newRemainder, wide, remainderSlot);
+  // Shift the inverted borrow into the quotient.
+  uint32 oldQuotient = printNewValue();
+  llPrintf("load i%u, i%u* %%.tmp%u\n", width, width, quotientSlot);
+  uint32 shiftedQuotient = printNewValue();
+  llPrintf("shl i%u %%%u, 1\n", width, oldQuotient);
+  uint32 narrowMask = printNewValue();
+  llPrintf("trunc i%u %%%u to i%u\n", wide, mask, width);
+  uint32 quotientBit = printNewValue();
+  llPrintf("and i%u %%%u, 1\n", width, narrowMask);
+  uint32 newQuotient = printNewValue();
+  llPrintf("or i%u %%%u, %%%u\n", width, shiftedQuotient, quotientBit);
+  llPrintf("  store i%u %%%u, i%u* %%.tmp%u\n", width, newQuotient, width, quotientSlot);
+  uint32 done = printNewValue();
+  llPrintf("icmp eq i%u %%%u, 0\n", width, bitPos);
+  llPrintf("  br i1 %%%u, label %%%s, label %%%s%s\n", done, utSymGetName(doneLabel),
+      utSymGetName(loopLabel), locationInfo());
+  llPrintf("%s:\n", utSymGetName(doneLabel));
+  llPrevLabel = doneLabel;
+  uint32 result;
+  if (isMod) {
+    uint32 finalRemainder = printNewValue();
+    llPrintf("load i%u, i%u* %%.tmp%u\n", wide, wide, remainderSlot);
+    result = printNewValue();
+    llPrintf("trunc i%u %%%u to i%u%s\n", wide, finalRemainder, width, locationInfo());
+  } else {
+    result = printNewValue();
+    llPrintf("load i%u, i%u* %%.tmp%u\n", width, width, quotientSlot);
+    if (isSigned) {
+      uint32 flipped = printNewValue();
+      llPrintf("xor i%u %%%u, %%%u\n", width, result, quotientSign);
+      result = printNewValue();
+      llPrintf("sub i%u %%%u, %%%u%s\n", width, flipped, quotientSign, locationInfo());
+    }
+  }
+  pushValue(datatype, result, false);
+}
+
 // Generate code for a binary expression.
 static void generateBinaryExpression(deExpression expression, char *op) {
   deSignature signature = deExpressionGetSignature(expression);
@@ -1306,7 +1568,7 @@ static void generateBinaryExpression(deExpression expression, char *op) {
     return;
   }
   deDatatype datatype = deExpressionGetDatatype(expression);
-  if (llDatatypeIsBigint(datatype)) {
+  if (llDatatypeIsBigint(datatype) || wideIntNeedsRuntime(expression)) {
     generateBigintBinaryExpression(expression);
     return;
   }
@@ -1327,6 +1589,15 @@ static void generateBinaryExpression(deExpression expression, char *op) {
     generateXorStringsExpression(leftElement, rightElement);
     return;
   }
+  if (isSecretSmallnumDivide(expression)) {
+    generateSecretDivide(datatype, leftElement, rightElement, exprType == DE_EXPR_MOD);
+    return;
+  }
+  if (llDatatypeIsWideInt(datatype) && !deUnsafeMode &&
+      (exprType == DE_EXPR_ADD || exprType == DE_EXPR_SUB || exprType == DE_EXPR_MUL)) {
+    generateCheckedWideArithmetic(datatype, op, leftElement, rightElement);
+    return;
+  }
   char *type = llGetTypeString(datatype, false);
   uint32 value = printNewValue();
   llPrintf("%s %s %s, %s%s\n", op, type,
@@ -1397,6 +1668,9 @@ static void generateArrayComparison(llElement left, llElement right, runtime_com
   deDatatype primDatatype = findPrimitiveDatatype(datatype);
   bool hasSubArrays = arrayHasSubArrays(datatype);
   runtime_type primType = findRuntimeType(deDatatypeGetType(primDatatype));
+  if (llDatatypeIsWideInt(primDatatype)) {
+    primType = deDatatypeSigned(primDatatype)? RN_WIDE_INT : RN_WIDE_UINT;
+  }
   llElement elementSize = findDatatypeSize(primDatatype);
   llDeclareRuntimeFunction("runtime_compareArrays");
   bool secret = deDatatypeSecret(datatype) || deDatatypeSecret(llElementGetDatatype(right));
@@ -1471,7 +1745,8 @@ static llElement storeElementAndReturnRef(llElement element) {
   char *type = llGetTypeString(llElementGetDatatype(element), true);
   uint32 value = printNewTmpValue();
   llTmpPrintf("alloca %s\n", type);
-  llTmpPrintf("  store %s %s, %s* %%.tmp%u\n",
+  // The value may be computed, so store it here rather than at the top.
+  llPrintf("  store %s %s, %s* %%.tmp%u\n",
       type, llElementGetName(element), type, value);
   return createTmpValueElement(llElementGetDatatype(element), value, true);
 }
@@ -1537,12 +1812,93 @@ static llElement convertBigintToSmallInt(llElement bigintArray, uint32 newWidth,
   return result;
 }
 
+// Return a pointer to the uint64 words of a wide integer.  This is how wide
+// integers are passed to the runtime.
+static llElement getWideIntWords(llElement element) {
+  if (!llElementIsRef(element)) {
+    element = storeElementAndReturnRef(element);
+  }
+  uint32 value = getUintPointer(element, 64);
+  return createValueElement(deUintDatatypeCreate(64), value, true);
+}
+
+// Convert a wide integer to a bigint on the array heap, with the same width and
+// sign.
+static llElement convertWideIntToBigint(llElement element, bool secret) {
+  deDatatype datatype = llElementGetDatatype(element);
+  uint32 width = deDatatypeGetWidth(datatype);
+  llElement words = getWideIntWords(element);
+  allocateTempArray(datatype);
+  llElement bigintArray = popElement(false);
+  llDeclareRuntimeFunction("runtime_wideIntegerToBigint");
+  llPrintf(
+      "  call void @runtime_wideIntegerToBigint(%%struct.runtime_array* %s, i64* %s, "
+      "i32 zeroext %u, i1 zeroext %s, i1 zeroext %s)\n", llElementGetName(bigintArray),
+      llElementGetName(words), width, boolVal(deDatatypeSigned(datatype)), boolVal(secret));
+  return bigintArray;
+}
+
+// Convert a bigint in an array to a wide integer.
+static llElement convertBigintToWideInt(llElement bigintArray, uint32 newWidth,
+    bool isSigned, bool truncate) {
+  uint32 wordsWidth = ((newWidth + 63) / 64) * 64;
+  llElement result = allocateTempValue(deUintDatatypeCreate(wordsWidth));
+  popElement(false);
+  llElement words = getWideIntWords(result);
+  llDeclareRuntimeFunction("runtime_bigintToWideInteger");
+  llPrintf(
+      "  call void @runtime_bigintToWideInteger(i64* %s, %%struct.runtime_array* %s, "
+      "i32 zeroext %u, i1 zeroext %s, i1 zeroext %s)%s\n", llElementGetName(words),
+      llElementGetName(bigintArray), newWidth, boolVal(isSigned), boolVal(truncate),
+      locationInfo());
+  derefElement(&result);
+  return resizeSmallInteger(result, newWidth, isSigned);
+}
+
+// Convert an array of wide integers to a temporary array of bigints, so the
+// bigint runtime can operate on it.  Other arrays are returned unchanged.
+static llElement wideIntArrayToBigints(llElement array) {
+  deDatatype datatype = llElementGetDatatype(array);
+  deDatatype elementType = deDatatypeGetElementType(datatype);
+  if (!llDatatypeIsWideInt(elementType)) {
+    return array;
+  }
+  llElement bigints = allocateTempArray(datatype);
+  popElement(false);
+  llDeclareRuntimeFunction("runtime_wideIntArrayToBigints");
+  llPrintf("  call void @runtime_wideIntArrayToBigints(%%struct.runtime_array* %s, "
+      "%%struct.runtime_array* %s, i32 zeroext %u, i1 zeroext %s)%s\n",
+      llElementGetName(bigints), llElementGetName(array), deDatatypeGetWidth(elementType),
+      boolVal(deDatatypeSecret(elementType)), locationInfo());
+  return bigints;
+}
+
+// Convert a wide integer element to a bigint of the same width and sign, so
+// the bigint runtime can operate on it.  Other elements are returned unchanged.
+static llElement toBigint(llElement element, bool secret) {
+  if (!llDatatypeIsWideInt(llElementGetDatatype(element))) {
+    return element;
+  }
+  return convertWideIntToBigint(element, secret);
+}
+
+// If the top of the stack is a wide integer computed by the bigint runtime,
+// convert it back to a native integer.
+static void convertTopFromBigint(void) {
+  deDatatype datatype = llElementGetDatatype(*topOfStack());
+  if (!llDatatypeIsWideInt(datatype)) {
+    return;
+  }
+  llElement bigintArray = popElement(false);
+  pushElement(convertBigintToWideInt(bigintArray, deDatatypeGetWidth(datatype),
+      deDatatypeSigned(datatype), false), false);
+}
+
 // Resize the bigint.
 static llElement resizeBigint(llElement bigintArray, uint32 newWidth,
     bool isSigned, bool truncate) {
   deDatatype datatype = llElementGetDatatype(bigintArray);
-  uint32 oldWidth = deDatatypeGetWidth(datatype);
-  utAssert(oldWidth > llSizeWidth && newWidth > llSizeWidth);
+  utAssert(newWidth > deMaxNativeIntWidth);
   deDatatype newDatatype = deDatatypeSetSigned(deDatatypeResize(datatype, newWidth), isSigned);
   llDeclareRuntimeFunction("runtime_bigintCast");
   llElement tempArray = allocateTempValue(newDatatype);
@@ -1559,13 +1915,20 @@ static llElement resizeBigint(llElement bigintArray, uint32 newWidth,
 static llElement resizeInteger(llElement element, uint32 newWidth, bool isSigned, bool truncate) {
   deDatatype oldDatatype = llElementGetDatatype(element);
   uint32 oldWidth = deDatatypeGetWidth(oldDatatype);
+  bool oldIsBigint = oldWidth > deMaxNativeIntWidth;
+  bool newIsBigint = newWidth > deMaxNativeIntWidth;
   if (newWidth == oldWidth && deDatatypeSigned(oldDatatype) == isSigned) {
     return element;
-  } else if (oldWidth <= llSizeWidth && newWidth > llSizeWidth) {
+  } else if (oldWidth <= llSizeWidth && newIsBigint) {
     return convertSmallIntToBigint(element, newWidth, isSigned);
-  } else if (oldWidth > llSizeWidth && newWidth <= llSizeWidth) {
+  } else if (!oldIsBigint && newIsBigint) {
+    llElement bigintArray = convertWideIntToBigint(element, deDatatypeSecret(oldDatatype));
+    return resizeBigint(bigintArray, newWidth, isSigned, truncate);
+  } else if (oldIsBigint && newWidth <= llSizeWidth) {
     return convertBigintToSmallInt(element, newWidth, isSigned, truncate);
-  } else if (newWidth > llSizeWidth) {
+  } else if (oldIsBigint && !newIsBigint) {
+    return convertBigintToWideInt(element, newWidth, isSigned, truncate);
+  } else if (newIsBigint) {
     return resizeBigint(element, newWidth, isSigned, truncate);
   }
   return resizeSmallInteger(element, newWidth, isSigned);
@@ -1584,9 +1947,87 @@ static llElement generateString(deString text) {
   return element;
 }
 
+// Find one of the global variables memmanage.c adds to manage the class's
+// objects, such as <path>_used.
+static deVariable findClassGlobal(deClass theClass, char *name) {
+  char *path = deGetBlockPath(deClassGetSubBlock(theClass), true);
+  deIdent ident = deBlockFindIdent(deRootGetBlock(deTheRoot),
+      utSymCreateFormatted("%s_%s", path, name));
+  utAssert(ident != deIdentNull && deIdentGetType(ident) == DE_IDENT_VARIABLE);
+  return deIdentGetVariable(ident);
+}
+
+// Determine if the variable is a region variable, which holds the only
+// reference to its object.
+static bool isRegionVariable(deVariable variable) {
+  deDatatype datatype = deVariableGetDatatype(variable);
+  return deVariableRegion(variable) && datatype != deDatatypeNull &&
+      deDatatypeGetType(datatype) == DE_TYPE_CLASS;
+}
+
+// Free the old object of a region variable about to be assigned a new one, if
+// it is next on the region's stack.  Otherwise it is released on return.
+static void freeRegionObject(deVariable variable) {
+  deClass theClass = deDatatypeGetClass(deVariableGetDatatype(variable));
+  uint32 refWidth = deClassGetRefWidth(theClass);
+  char *path = llEscapeIdentifier(utSprintf("%s_freeRegionObject",
+      deGetBlockPath(deClassGetSubBlock(theClass), true)));
+  uint32 object = printNewValue();
+  llPrintf("load i%u, i%u* %s\n", refWidth, refWidth, llGetVariableName(variable));
+  llPrintf("  call void @%s(i%u %%%u)%s\n", path, refWidth, object, locationInfo());
+}
+
+// Load the region head of each class with objects allocated in the function's
+// region.  This is done in the entry block, so the marks are available at
+// every return and throw.
+static void saveRegionMarks(deBlock block) {
+  deVariable variable;
+  deForeachBlockVariable(block, variable) {
+    if (!isRegionVariable(variable)) {
+      continue;
+    }
+    deClass theClass = deDatatypeGetClass(deVariableGetDatatype(variable));
+    uint32 xRegion = 0;
+    while (xRegion < llNumRegions && llRegions[xRegion].theClass != theClass) {
+      xRegion++;
+    }
+    if (xRegion == llNumRegions) {
+      if (llNumRegions == llRegionsAllocated) {
+        llRegionsAllocated <<= 1;
+        utResizeArray(llRegions, llRegionsAllocated);
+      }
+      uint32 refWidth = deClassGetRefWidth(theClass);
+      uint32 mark = printNewValue();
+      llPrintf("load i%u, i%u* %s\n", refWidth, refWidth,
+          llGetVariableName(findClassGlobal(theClass, "regionHead")));
+      llRegions[llNumRegions].theClass = theClass;
+      llRegions[llNumRegions].mark = mark;
+      llNumRegions++;
+    }
+  } deEndBlockVariable;
+}
+
+// Release the objects allocated in the function's region, in bulk, before
+// returning or throwing an exception.
+static void releaseRegions(void) {
+  for (uint32 i = 0; i < llNumRegions; i++) {
+    deClass theClass = llRegions[i].theClass;
+    char *path = llEscapeIdentifier(utSprintf("%s_releaseRegion",
+        deGetBlockPath(deClassGetSubBlock(theClass), true)));
+    llPrintf("  call void @%s(i%u %%%u)%s\n", path, deClassGetRefWidth(theClass),
+        llRegions[i].mark, locationInfo());
+  }
+}
+
 // Call runtime_sprintf given the format and the expression or tuple.
 static void callSprintfOrThrow(llElement destArray,
     llElement format, deExpression argument, bool isPrint, bool skipStrings) {
+  // The arguments may read members of region objects, so when throwing from a
+  // function with region variables, format the message before releasing them.
+  bool releaseBeforeThrow = !isPrint && llNumRegions != 0;
+  if (releaseBeforeThrow) {
+    destArray = allocateTempValue(deStringDatatypeCreate());
+  }
   bool isTuple = false;
   deExpressionType argType = deExpressionGetType(argument);
   if (argType == DE_EXPR_TUPLE || argType == DE_EXPR_LIST) {
@@ -1600,9 +2041,14 @@ static void callSprintfOrThrow(llElement destArray,
       if (!deExpressionIsType(argument)) {
         generateExpression(argument);
         llElement *elementPtr = topOfStack();
-        derefElement(elementPtr);
-        if (deDatatypeIsInteger(datatype) && deDatatypeGetWidth(datatype) < llSizeWidth) {
-          resizeTop(llSizeWidth);
+        if (llDatatypeIsWideInt(datatype)) {
+          // Wide integers are passed by reference.
+          pushElement(getWideIntWords(popElement(false)), false);
+        } else {
+          derefElement(elementPtr);
+          if (deDatatypeIsInteger(datatype) && deDatatypeGetWidth(datatype) < llSizeWidth) {
+            resizeTop(llSizeWidth);
+          }
         }
         numArguments++;
       }
@@ -1613,7 +2059,7 @@ static void callSprintfOrThrow(llElement destArray,
       argument = deExpressionNull;
     }
   }
-  if (isPrint) {
+  if (isPrint || releaseBeforeThrow) {
     llDeclareRuntimeFunction("runtime_sprintf");
     llPrintf(
         "  call void (%%struct.runtime_array*, %%struct.runtime_array*, ...) "
@@ -1635,6 +2081,18 @@ static void callSprintfOrThrow(llElement destArray,
              llElementGetName(element));
   }
   llPrintf(")%s\n", locationInfo());
+  if (releaseBeforeThrow) {
+    popElement(false);  // Pop the formatted message.
+    releaseRegions();
+    llElement messageFormat = generateString(deCStringCreate("%s"));
+    llDeclareRuntimeFunction("runtime_throwException");
+    llPrintf(
+        "  call void (%%struct.runtime_array*, ...) "
+        "@runtime_throwException(%s %s, %s %s)%s\n",
+        llGetTypeString(llElementGetDatatype(messageFormat), false),
+        llElementGetName(messageFormat), getElementTypeString(destArray),
+        llElementGetName(destArray), locationInfo());
+  }
   if (!isPrint) {
     resetNeedsFreeList();
     llPrintf("  unreachable\n");
@@ -1670,9 +2128,64 @@ static void generateSelect(llElement selectElement, llElement data1Element, llEl
   pushValue(datatype, value, false);
 }
 
+// Generate a constant-time select of integers, without a select instruction,
+// which LLVM is free to lower to a branch:
+//   data0 ^ (mask & (data1 ^ data0))
+// The mask is sext(select), passed through an empty asm statement, as CTTK
+// does.  Otherwise InstCombine recognizes the idiom and folds it back into a
+// select.  The barrier works on an i64, since not every integer width fits a
+// register; the mask is then truncated or sign extended to the data's width.
+static void generateSecretSelect(llElement selectElement, llElement data1Element,
+    llElement data0Element) {
+  deDatatype datatype = llElementGetDatatype(data1Element);
+  char *type = llGetTypeString(datatype, false);
+  char *data0Name = llElementGetName(data0Element);
+  deDatatype intType = datatype;
+  if (deDatatypeGetType(datatype) == DE_TYPE_MODINT) {
+    intType = deExpressionGetDatatype(deDatatypeGetModulus(datatype));
+  }
+  uint32 width = deDatatypeGetType(intType) == DE_TYPE_BOOL? 1 : deDatatypeGetWidth(intType);
+  uint32 wideMask = printNewValue();
+  llPrintf("sext i1 %s to i64%s\n", llElementGetName(selectElement), locationInfo());
+  uint32 opaqueMask = printNewValue();
+  llPrintf("call i64 asm sideeffect \"\", \"=r,0\"(i64 %%%u)%s\n", wideMask, locationInfo());
+  uint32 mask = opaqueMask;
+  if (width != 64) {
+    mask = printNewValue();
+    llPrintf("%s i64 %%%u to %s%s\n", width < 64? "trunc" : "sext", opaqueMask, type,
+        locationInfo());
+  }
+  uint32 diff = printNewValue();
+  llPrintf("xor %s %s, %s%s\n", type, llElementGetName(data1Element), data0Name,
+      locationInfo());
+  uint32 maskedDiff = printNewValue();
+  llPrintf("and %s %%%u, %%%u%s\n", type, mask, diff, locationInfo());
+  uint32 value = printNewValue();
+  llPrintf("xor %s %s, %%%u%s\n", type, data0Name, maskedDiff, locationInfo());
+  pushValue(datatype, value, false);
+}
+
+// Return true if the select bit is secret and the data are integers, which
+// can be selected with a mask.
+static bool canGenerateSecretSelect(deExpression select, deExpression data1) {
+  if (!deDatatypeSecret(deExpressionGetDatatype(select))) {
+    return false;
+  }
+  deDatatype datatype = deExpressionGetDatatype(data1);
+  switch (deDatatypeGetType(datatype)) {
+    case DE_TYPE_BOOL:
+    case DE_TYPE_UINT:
+    case DE_TYPE_INT:
+    case DE_TYPE_MODINT:
+      return !llDatatypeIsBigint(datatype);
+    default:
+      return false;
+  }
+}
+
 // Generate a select expression.
-// TODO: This does not protect the privacy of the select bit!  Write code to
-// generate a secure select when select is secret.
+// TODO: This does not protect the privacy of the select bit when selecting
+// floats, bigints, or reference types.
 static void generateSelectExpression(deExpression expression) {
   deExpression select = deExpressionGetFirstExpression(expression);
   deExpression data1 = deExpressionGetNextExpression(select);
@@ -1683,6 +2196,10 @@ static void generateSelectExpression(deExpression expression) {
   llElement data0Element = popElement(true);
   llElement data1Element = popElement(true);
   llElement selectElement = popElement(true);
+  if (canGenerateSecretSelect(select, data1)) {
+    generateSecretSelect(selectElement, data1Element, data0Element);
+    return;
+  }
   generateSelect(selectElement, data1Element, data0Element);
 }
 
@@ -1702,6 +2219,7 @@ static void generateIntegerToString(llElement value, llElement base) {
         llElementGetName(result), llSize, llElementGetName(value),
         llElementGetName(base), boolVal(isSigned), locationInfo());
   } else {
+    value = toBigint(value, false);
     llDeclareRuntimeFunction("runtime_bigintToString");
     llPrintf(
         "  call void @runtime_bigintToString(%%struct.runtime_array* %s, "
@@ -1720,13 +2238,531 @@ static void generateValueToString(llElement value) {
   format[pos++] = '%';
   format = deAppendFormatSpec(format, &len, &pos, datatype);
   llElement formatElement = generateString(deStringCreate(format, pos));
+  char *valueType = llGetTypeString(datatype, false);
+  if (llDatatypeIsWideInt(datatype)) {
+    // Wide integers are passed by reference.
+    value = getWideIntWords(value);
+    valueType = "i64*";
+  }
   llElement result = allocateTempValue(deStringDatatypeCreate());
   llDeclareRuntimeFunction("runtime_sprintf");
   llPrintf(
       "  call void (%%struct.runtime_array*, %%struct.runtime_array*, ...) "
       "@runtime_sprintf(%%struct.runtime_array* %s, %%struct.runtime_array* %s, %s %s)%s\n",
       llElementGetName(result), llElementGetName(formatElement),
-      llGetTypeString(datatype, false), llElementGetName(value), locationInfo());
+      valueType, llElementGetName(value), locationInfo());
+}
+
+// If this is the global array of a class's data member, return the class.
+static deClass findColumnsClass(deExpression expression) {
+  if (deExpressionGetType(expression) != DE_EXPR_IDENT) {
+    return deClassNull;
+  }
+  deIdent ident = deExpressionGetIdent(expression);
+  if (ident == deIdentNull || deIdentGetType(ident) != DE_IDENT_VARIABLE) {
+    return deClassNull;
+  }
+  return deVariableGetColumnsClass(deIdentGetVariable(ident));
+}
+
+// Return the profiled loads and stores of the data member's array.  All the
+// members of a field group count toward their shared array.
+static uint64 findColumnAccessCount(deVariable variable) {
+  deFieldGroup group = deVariableGetFieldGroup(variable);
+  if (group == deFieldGroupNull) {
+    return deVariableGetProfileLoads(variable) + deVariableGetProfileStores(variable);
+  }
+  uint64 count = 0;
+  deVariable member;
+  deForeachBlockVariable(deVariableGetBlock(variable), member) {
+    if (deVariableGetFieldGroup(member) == group) {
+      count += deVariableGetProfileLoads(member) + deVariableGetProfileStores(member);
+    }
+  } deEndBlockVariable;
+  return count;
+}
+
+// Determine if the data member's array is counted as its own column.  Members
+// in a field group share the array of the first of them, and a member may
+// share the nextFree array.
+static bool memberOwnsArray(deClass theClass, deVariable variable) {
+  if (variable == deClassGetFreeListVariable(theClass)) {
+    return false;
+  }
+  return deVariableGetFieldGroup(variable) == deFieldGroupNull ||
+      deVariableGetFieldGroupIndex(variable) == 0;
+}
+
+// Fill in temporary arrays of the class's data member arrays, their element
+// sizes, and whether they have sub-arrays, as the runtime column functions
+// expect.  Members in a field group share one array, found through the first
+// of them.  With a field profile, the most accessed arrays come first, so they
+// are adjacent in the shared allocation.  Set the pointers to the arrays, and
+// return the number of columns.
+static uint32 generateClassColumnArrays(deClass theClass, uint32 *columnsPtr,
+    uint32 *sizesPtr, uint32 *flagsPtr) {
+  deBlock block = deClassGetSubBlock(theClass);
+  uint32 numColumns = 0;
+  deVariable variable;
+  deForeachBlockVariable(block, variable) {
+    if (memberOwnsArray(theClass, variable)) {
+      numColumns++;
+    }
+  } deEndBlockVariable;
+  deVariable *members = utNewA(deVariable, numColumns);
+  uint64 *counts = utNewA(uint64, numColumns);
+  uint32 numMembers = 0;
+  deForeachBlockVariable(block, variable) {
+    if (memberOwnsArray(theClass, variable)) {
+      // Insertion sort, stable, so the order is unchanged without a profile.
+      // The first member holds the free list, which the runtime expects first.
+      uint64 count = variable == deBlockGetFirstVariable(block)?
+          UINT64_MAX : findColumnAccessCount(variable);
+      uint32 pos = numMembers++;
+      while (pos > 0 && counts[pos - 1] < count) {
+        members[pos] = members[pos - 1];
+        counts[pos] = counts[pos - 1];
+        pos--;
+      }
+      members[pos] = variable;
+      counts[pos] = count;
+    }
+  } deEndBlockVariable;
+  uint32 columns = printNewTmpValue();
+  llTmpPrintf("alloca [%u x %%struct.runtime_array*]\n", numColumns);
+  uint32 sizes = printNewTmpValue();
+  llTmpPrintf("alloca [%u x i%s]\n", numColumns, llSize);
+  uint32 flags = printNewTmpValue();
+  llTmpPrintf("alloca [%u x i8]\n", numColumns);
+  for (uint32 i = 0; i < numColumns; i++) {
+    deVariable arrayVar = deVariableGetGlobalArrayVariable(members[i]);
+    deDatatype datatype = deVariableGetDatatype(arrayVar);
+    llElement elementSize = findDatatypeSize(deDatatypeGetElementType(datatype));
+    uint32 columnPtr = printNewValue();
+    llPrintf("getelementptr inbounds [%u x %%struct.runtime_array*], "
+        "[%u x %%struct.runtime_array*]* %%.tmp%u, i32 0, i32 %u\n",
+        numColumns, numColumns, columns, i);
+    llPrintf("  store %%struct.runtime_array* %s, %%struct.runtime_array** %%%u\n",
+        llGetVariableName(arrayVar), columnPtr);
+    uint32 sizePtr = printNewValue();
+    llPrintf("getelementptr inbounds [%u x i%s], [%u x i%s]* %%.tmp%u, i32 0, i32 %u\n",
+        numColumns, llSize, numColumns, llSize, sizes, i);
+    llPrintf("  store i%s %s, i%s* %%%u\n", llSize, llElementGetName(elementSize),
+        llSize, sizePtr);
+    uint32 flagPtr = printNewValue();
+    llPrintf("getelementptr inbounds [%u x i8], [%u x i8]* %%.tmp%u, i32 0, i32 %u\n",
+        numColumns, numColumns, flags, i);
+    llPrintf("  store i8 %u, i8* %%%u\n", arrayHasSubArrays(datatype), flagPtr);
+  }
+  utFree(members);
+  utFree(counts);
+  *columnsPtr = printNewValue();
+  llPrintf("getelementptr inbounds [%u x %%struct.runtime_array*], "
+      "[%u x %%struct.runtime_array*]* %%.tmp%u, i32 0, i32 0\n", numColumns, numColumns, columns);
+  *sizesPtr = printNewValue();
+  llPrintf("getelementptr inbounds [%u x i%s], [%u x i%s]* %%.tmp%u, i32 0, i32 0\n",
+      numColumns, llSize, numColumns, llSize, sizes);
+  *flagsPtr = printNewValue();
+  llPrintf("getelementptr inbounds [%u x i8], [%u x i8]* %%.tmp%u, i32 0, i32 0\n",
+      numColumns, numColumns, flags);
+  return numColumns;
+}
+
+// Resize all of the class's data member arrays together, in one allocation.
+static void resizeClassColumns(deClass theClass, llElement numElements) {
+  uint32 columnsPtr, sizesPtr, flagsPtr;
+  uint32 numColumns = generateClassColumnArrays(theClass, &columnsPtr, &sizesPtr, &flagsPtr);
+  llDeclareRuntimeFunction("runtime_resizeColumns");
+  llPrintf("  call void @runtime_resizeColumns(%%struct.runtime_array** %%%u, i%s* %%%u, "
+      "i8* %%%u, i%s %u, i%s %s)%s\n", columnsPtr, llSize, sizesPtr, flagsPtr, llSize,
+      numColumns, llSize, llElementGetName(numElements), locationInfo());
+}
+
+// Load one of the class's memory management globals, as a size.
+static llElement loadClassGlobal(deClass theClass, char *name) {
+  deVariable variable = findClassGlobal(theClass, name);
+  uint32 refWidth = deClassGetRefWidth(theClass);
+  uint32 value = printNewValue();
+  llPrintf("load i%u, i%u* %s\n", refWidth, refWidth, llGetVariableName(variable));
+  llElement element = createValueElement(deVariableGetDatatype(variable), value, false);
+  return resizeSmallInteger(element, llSizeWidth, false);
+}
+
+// Store a size to one of the class's memory management globals.
+static void storeClassGlobal(deClass theClass, char *name, llElement value) {
+  deVariable variable = findClassGlobal(theClass, name);
+  uint32 refWidth = deClassGetRefWidth(theClass);
+  value = resizeSmallInteger(value, refWidth, false);
+  llPrintf("  store i%u %s, i%u* %s\n", refWidth, llElementGetName(value), refWidth,
+      llGetVariableName(variable));
+}
+
+// References can nest this many arrays deep in a data member or global.
+#define LL_MAX_REMAP_DEPTH 8
+
+// State for rewriting references to a compacted class found in one array.  The
+// path gives the element size and offset at each level of array nesting, as
+// runtime_remapReferences expects.
+typedef struct {
+  deClass theClass;
+  llElement newIds;
+  char *arrayName;
+  llElement numElements;
+  llElement path[2 * LL_MAX_REMAP_DEPTH];
+  uint32 depth;
+} llRemapState;
+
+// Determine if a value of the datatype can hold a reference to |theClass|,
+// directly, in a tuple or struct field, or in an array element.
+static bool datatypeHoldsClassRefs(deDatatype datatype, deClass theClass) {
+  switch (deDatatypeGetType(datatype)) {
+    case DE_TYPE_CLASS:
+      return deDatatypeGetClass(datatype) == theClass;
+    case DE_TYPE_ARRAY:
+      return datatypeHoldsClassRefs(deDatatypeGetElementType(datatype), theClass);
+    case DE_TYPE_STRUCT:
+      return datatypeHoldsClassRefs(deGetStructTupleDatatype(datatype), theClass);
+    case DE_TYPE_TUPLE:
+      for (uint32 i = 0; i < deDatatypeGetNumTypeList(datatype); i++) {
+        if (datatypeHoldsClassRefs(deDatatypeGetiTypeList(datatype, i), theClass)) {
+          return true;
+        }
+      }
+      return false;
+    default:
+      return false;
+  }
+}
+
+// Call runtime_remapReferences on the array, with the path in |state|.
+static void callRemapReferences(llRemapState *state) {
+  uint32 pathLen = state->depth << 1;
+  uint32 path = printNewTmpValue();
+  llTmpPrintf("alloca [%u x i%s]\n", pathLen, llSize);
+  for (uint32 i = 0; i < pathLen; i++) {
+    uint32 stepPtr = printNewValue();
+    llPrintf("getelementptr inbounds [%u x i%s], [%u x i%s]* %%.tmp%u, i32 0, i32 %u\n",
+        pathLen, llSize, pathLen, llSize, path, i);
+    llPrintf("  store i%s %s, i%s* %%%u\n", llSize, llElementGetName(state->path[i]), llSize,
+        stepPtr);
+  }
+  uint32 pathPtr = printNewValue();
+  llPrintf("getelementptr inbounds [%u x i%s], [%u x i%s]* %%.tmp%u, i32 0, i32 0\n",
+      pathLen, llSize, pathLen, llSize, path);
+  llElement refSize = findDatatypeSize(deClassGetDatatype(state->theClass));
+  llDeclareRuntimeFunction("runtime_remapReferences");
+  llPrintf("  call void @runtime_remapReferences(%%struct.runtime_array* %s, i%s* %%%u, i32 %u, "
+      "i%s %s, i32 %u, i%s %s, %%struct.runtime_array* %s)%s\n",
+      state->arrayName, llSize, pathPtr, state->depth, llSize, llElementGetName(refSize),
+      deClassGetRefWidth(state->theClass), llSize, llElementGetName(state->numElements),
+      llElementGetName(state->newIds), locationInfo());
+}
+
+// Rewrite the references to the compacted class within values of |datatype|,
+// stored |offset| bytes into each |elementSize| byte element at the current
+// level of |state|'s path.
+static void remapReferencesInValue(llRemapState *state, deDatatype datatype,
+    llElement elementSize, llElement offset) {
+  if (!datatypeHoldsClassRefs(datatype, state->theClass)) {
+    return;
+  }
+  switch (deDatatypeGetType(datatype)) {
+    case DE_TYPE_CLASS:
+      state->path[state->depth << 1] = elementSize;
+      state->path[(state->depth << 1) + 1] = offset;
+      state->depth++;
+      callRemapReferences(state);
+      state->depth--;
+      break;
+    case DE_TYPE_ARRAY: {
+      if (state->depth + 1 == LL_MAX_REMAP_DEPTH) {
+        utExit("Arrays nest too deeply to compact references in them");
+      }
+      state->path[state->depth << 1] = elementSize;
+      state->path[(state->depth << 1) + 1] = offset;
+      state->depth++;
+      deDatatype elementType = deDatatypeGetElementType(datatype);
+      remapReferencesInValue(state, elementType, findDatatypeSize(elementType),
+          createSmallInteger(0, llSizeWidth, false));
+      state->depth--;
+      break;
+    }
+    case DE_TYPE_STRUCT:
+      remapReferencesInValue(state, deGetStructTupleDatatype(datatype), elementSize, offset);
+      break;
+    case DE_TYPE_TUPLE:
+      for (uint32 i = 0; i < deDatatypeGetNumTypeList(datatype); i++) {
+        llElement fieldOffset = findTupleFieldOffset(datatype, i);
+        uint32 sum = printNewValue();
+        llPrintf("add i%s %s, %s\n", llSize, llElementGetName(offset),
+            llElementGetName(fieldOffset));
+        remapReferencesInValue(state, deDatatypeGetiTypeList(datatype, i), elementSize,
+            createValueElement(llSizeType, sum, false));
+      }
+      break;
+    default:
+      utExit("Unexpected datatype holding references");
+  }
+}
+
+// Rewrite the references to a compacted class held by data members of all
+// classes, and by global variables.  References may be nested in tuples,
+// structs, and arrays, as relationships generate.  References in local
+// variables are not rewritten, so callers of compact() must not hold
+// references to the class's objects in locals across the call.
+static void remapClassReferences(deClass theClass, llElement newIds) {
+  llRemapState state;
+  state.theClass = theClass;
+  state.newIds = newIds;
+  state.depth = 0;
+  deClass otherClass;
+  deForeachRootClass(deTheRoot, otherClass) {
+    if (!deClassBound(otherClass) || !classInstantiated(otherClass)) {
+      continue;
+    }
+    deBlock block = deClassGetSubBlock(otherClass);
+    bool loadedUsed = false;
+    deVariable variable;
+    deForeachBlockVariable(block, variable) {
+      deDatatype datatype = deVariableGetDatatype(variable);
+      // The first member, nextFree, holds reference counts and free list links.
+      if (variable == deBlockGetFirstVariable(block) ||
+          !datatypeHoldsClassRefs(datatype, theClass)) {
+        continue;
+      }
+      if (!loadedUsed) {
+        state.numElements = loadClassGlobal(otherClass, "used");
+        loadedUsed = true;
+      }
+      deVariable arrayVar = deVariableGetGlobalArrayVariable(variable);
+      deDatatype elementType = deDatatypeGetElementType(deVariableGetDatatype(arrayVar));
+      llElement elementSize = findDatatypeSize(elementType);
+      llElement offset = createSmallInteger(0, llSizeWidth, false);
+      if (deVariableGetFieldGroup(variable) != deFieldGroupNull) {
+        offset = findTupleFieldOffset(elementType, deVariableGetFieldGroupIndex(variable));
+      }
+      state.arrayName = utAllocString(llGetVariableName(arrayVar));
+      remapReferencesInValue(&state, datatype, elementSize, offset);
+      utFree(state.arrayName);
+    } deEndBlockVariable;
+  } deEndRootClass;
+  // Globals are passed to the runtime as arrays of one element.
+  deFunction function;
+  deForeachRootFunction(deTheRoot, function) {
+    deFunctionType type = deFunctionGetType(function);
+    if (type != DE_FUNC_MODULE && type != DE_FUNC_PACKAGE) {
+      continue;
+    }
+    deVariable variable;
+    deForeachBlockVariable(deFunctionGetSubBlock(function), variable) {
+      deDatatype datatype = deVariableGetDatatype(variable);
+      if (deVariableGetType(variable) != DE_VAR_LOCAL || !deVariableInstantiated(variable) ||
+          deVariableGetColumnsClass(variable) != deClassNull ||
+          !datatypeHoldsClassRefs(datatype, theClass)) {
+        continue;
+      }
+      char *type = llGetTypeString(datatype, true);
+      uint32 global = printNewTmpValue();
+      llTmpPrintf("alloca %%struct.runtime_array\n");
+      uint32 dataPtr = printNewValue();
+      llPrintf("getelementptr inbounds %%struct.runtime_array, %%struct.runtime_array* %%.tmp%u, "
+          "i32 0, i32 0\n", global);
+      uint32 data = printNewValue();
+      llPrintf("bitcast %s* %s to i64*\n", type, llGetVariableName(variable));
+      llPrintf("  store i64* %%%u, i64** %%%u\n", data, dataPtr);
+      uint32 numElementsPtr = printNewValue();
+      llPrintf("getelementptr inbounds %%struct.runtime_array, %%struct.runtime_array* %%.tmp%u, "
+          "i32 0, i32 1\n", global);
+      llPrintf("  store i64 1, i64* %%%u\n", numElementsPtr);
+      state.arrayName = utAllocString(utSprintf("%%.tmp%u", global));
+      state.numElements = createSmallInteger(1, llSizeWidth, false);
+      remapReferencesInValue(&state, datatype, findDatatypeSize(datatype),
+          createSmallInteger(0, llSizeWidth, false));
+      utFree(state.arrayName);
+    } deEndBlockVariable;
+  } deEndRootFunction;
+}
+
+// Renumber the class's live objects densely, rewrite references to them, and
+// shrink its data member arrays to fit.  This ends any reservation: objects
+// reserved by allocateMany but not yet constructed are the last ones used, and
+// are not live.
+static void compactClass(deClass theClass) {
+  uint32 refWidth = deClassGetRefWidth(theClass);
+  llElement newIds = allocateTempArray(deArrayDatatypeCreate(deUintDatatypeCreate(64)));
+  popElement(false);
+  uint32 columnsPtr, sizesPtr, flagsPtr;
+  uint32 numColumns = generateClassColumnArrays(theClass, &columnsPtr, &sizesPtr, &flagsPtr);
+  llElement allUsed = loadClassGlobal(theClass, "used");
+  llElement reserved = loadClassGlobal(theClass, "reserved");
+  uint32 constructed = printNewValue();
+  llPrintf("sub nuw i%s %s, %s\n", llSize, llElementGetName(allUsed),
+      llElementGetName(reserved));
+  llElement used = createValueElement(llSizeType, constructed, false);
+  llElement firstFree = loadClassGlobal(theClass, "firstFree");
+  llDeclareRuntimeFunction("runtime_compactColumns");
+  uint32 numLive = printNewValue();
+  llPrintf("call i%s @runtime_compactColumns(%%struct.runtime_array** %%%u, i%s* %%%u, "
+      "i8* %%%u, i%s %u, i%s %s, i%s %s, i32 %u, %%struct.runtime_array* %s)%s\n", llSize,
+      columnsPtr, llSize, sizesPtr, flagsPtr, llSize, numColumns, llSize,
+      llElementGetName(used), llSize, llElementGetName(firstFree), refWidth,
+      llElementGetName(newIds), locationInfo());
+  llElement numLiveElement = createValueElement(llSizeType, numLive, false);
+  storeClassGlobal(theClass, "used", numLiveElement);
+  llPrintf("  store i%u -1, i%u* %s\n", refWidth, refWidth,
+      llGetVariableName(findClassGlobal(theClass, "firstFree")));
+  storeClassGlobal(theClass, "reserved", createSmallInteger(0, llSizeWidth, false));
+  // Keep at least one object allocated, since allocation doubles the count.
+  uint32 isEmpty = printNewValue();
+  llPrintf("icmp eq i%s %%%u, 0\n", llSize, numLive);
+  uint32 allocated = printNewValue();
+  llPrintf("select i1 %%%u, i%s 1, i%s %%%u\n", isEmpty, llSize, llSize, numLive);
+  llElement allocatedElement = createValueElement(llSizeType, allocated, false);
+  storeClassGlobal(theClass, "allocated", allocatedElement);
+  resizeClassColumns(theClass, allocatedElement);
+  remapClassReferences(theClass, newIds);
+}
+
+// Determine if the program hashes references to the class.  The builtin
+// hashValue hashes an object as its index, so Hashed relations and Dicts keyed
+// by the class's objects, directly or in tuples and arrays, would be left with
+// entries in stale buckets, and stale cached hashes, if it were compacted.
+static bool classIsHashed(deClass theClass) {
+  deSignature signature;
+  deForeachRootSignature(deTheRoot, signature) {
+    deFunction function = deSignatureGetFunction(signature);
+    if (deSignatureInstantiated(signature) && !strcmp(deFunctionGetName(function), "hashValue") &&
+        deSignatureGetNumParamspec(signature) == 1 &&
+        datatypeHoldsClassRefs(deSignatureGetiType(signature, 0), theClass)) {
+      return true;
+    }
+  } deEndRootSignature;
+  return false;
+}
+
+// Generate the body of a tclass's compact method, which compacts each of its
+// classes.
+static void generateCompactMethod(void) {
+  deFunction compactor = deBlockGetOwningFunction(llCurrentScopeBlock);
+  deFunction constructor = deBlockGetOwningFunction(deFunctionGetBlock(compactor));
+  deClass theClass;
+  deForeachTclassClass(deFunctionGetTclass(constructor), theClass) {
+    if (deClassBound(theClass) && classInstantiated(theClass)) {
+      if (classIsHashed(theClass)) {
+        deError(deFunctionGetLine(constructor),
+            "Cannot compact %s: its objects are hashed, e.g. as keys of a Hashed "
+            "relation or Dict, and compacting would change their hashes",
+            deFunctionGetName(constructor));
+      }
+      compactClass(theClass);
+    }
+  } deEndTclassClass;
+}
+
+// Add two sizes with llvm.uadd.with.overflow.  Return the sum, and set
+// |overflowed| to the i1 value that is true if it wrapped.
+static uint32 addSizesWithOverflow(char *left, char *right, uint32 *overflowed) {
+  llDeclareOverloadedFunction(utSprintf(
+      "declare {i%s, i1} @llvm.uadd.with.overflow.i%s(i%s, i%s)\n",
+      llSize, llSize, llSize, llSize));
+  uint32 pair = printNewValue();
+  llPrintf("call {i%s, i1} @llvm.uadd.with.overflow.i%s(i%s %s, i%s %s)\n",
+      llSize, llSize, llSize, left, llSize, right);
+  uint32 sum = printNewValue();
+  llPrintf("extractvalue {i%s, i1} %%%u, 0\n", llSize, pair);
+  *overflowed = printNewValue();
+  llPrintf("extractvalue {i%s, i1} %%%u, 1\n", llSize, pair);
+  return sum;
+}
+
+// Reserve |numObjects| consecutive objects of the class, growing its data
+// member arrays at most once, and return the index of the first.  Reserved
+// objects count as used, and are the last ones used.  Those left from an
+// earlier reservation were never constructed, so they are dropped first.
+static llElement reserveClassObjects(deClass theClass, llElement numObjects) {
+  llElement used = loadClassGlobal(theClass, "used");
+  llElement allocated = loadClassGlobal(theClass, "allocated");
+  llElement reserved = loadClassGlobal(theClass, "reserved");
+  uint32 first = printNewValue();
+  llPrintf("sub nuw i%s %s, %s\n", llSize, llElementGetName(used), llElementGetName(reserved));
+  uint32 needed;
+  if (deUnsafeMode) {
+    needed = printNewValue();
+    llPrintf("add i%s %%%u, %s\n", llSize, first, llElementGetName(numObjects));
+  } else {
+    uint32 overflowed;
+    needed = addSizesWithOverflow(utSprintf("%%%u", first), llElementGetName(numObjects),
+        &overflowed);
+    // The all-ones reference is null, so at most 2^refWidth - 1 objects exist.
+    uint32 refWidth = deClassGetRefWidth(theClass);
+    uint32 tooMany = printNewValue();
+    if (refWidth >= llSizeWidth) {
+      llPrintf("icmp eq i%s %%%u, -1\n", llSize, needed);
+    } else {
+      llPrintf("icmp ugt i%s %%%u, %llu\n", llSize, needed, (1ULL << refWidth) - 1);
+    }
+    uint32 failed = printNewValue();
+    llPrintf("or i1 %%%u, %%%u\n", overflowed, tooMany);
+    overflowCheck(createValueElement(deBoolDatatypeCreate(), failed, false));
+  }
+  uint32 mustGrow = printNewValue();
+  llPrintf("icmp ugt i%s %%%u, %s\n", llSize, needed, llElementGetName(allocated));
+  uint32 newAllocated = printNewValue();
+  llPrintf("select i1 %%%u, i%s %%%u, i%s %s\n", mustGrow, llSize, needed, llSize,
+      llElementGetName(allocated));
+  llElement allocatedElement = createValueElement(llSizeType, newAllocated, false);
+  storeClassGlobal(theClass, "allocated", allocatedElement);
+  storeClassGlobal(theClass, "used", createValueElement(llSizeType, needed, false));
+  storeClassGlobal(theClass, "reserved", numObjects);
+  // This does nothing if the arrays are already big enough.
+  resizeClassColumns(theClass, allocatedElement);
+  return createValueElement(llSizeType, first, false);
+}
+
+// Generate the body of a tclass's allocateMany method, which reserves objects
+// in each of its classes, and returns the index of the first object reserved
+// in the first of them.
+static void generateAllocateManyMethod(void) {
+  deFunction allocator = deBlockGetOwningFunction(llCurrentScopeBlock);
+  deFunction constructor = deBlockGetOwningFunction(deFunctionGetBlock(allocator));
+  deVariable parameter = deBlockGetFirstVariable(llCurrentScopeBlock);
+  llElement numObjects = createElement(deVariableGetDatatype(parameter),
+      llGetVariableName(parameter), false);
+  numObjects = resizeSmallInteger(numObjects, llSizeWidth, false);
+  llElement first = createSmallInteger(0, llSizeWidth, false);
+  bool foundClass = false;
+  deClass theClass;
+  deForeachTclassClass(deFunctionGetTclass(constructor), theClass) {
+    if (deClassBound(theClass) && classInstantiated(theClass)) {
+      llElement classFirst = reserveClassObjects(theClass, numObjects);
+      if (!foundClass) {
+        first = classFirst;
+        foundClass = true;
+      }
+    }
+  } deEndTclassClass;
+  first = resizeSmallInteger(first, 64, false);
+  llPrintf("  ret i64 %s%s\n", llElementGetName(first), locationInfo());
+}
+
+// End the reservations made by the current function's allocateMany calls.
+// Reserved objects not yet constructed are the last ones used, so they are
+// given back by reducing the used count.
+static void endReservations(void) {
+  for (uint32 i = 0; i < llNumReservingTclasses; i++) {
+    deClass theClass;
+    deForeachTclassClass(llReservingTclasses[i], theClass) {
+      if (deClassBound(theClass) && classInstantiated(theClass)) {
+        llElement used = loadClassGlobal(theClass, "used");
+        llElement reserved = loadClassGlobal(theClass, "reserved");
+        uint32 newUsed = printNewValue();
+        llPrintf("sub nuw i%s %s, %s\n", llSize, llElementGetName(used),
+            llElementGetName(reserved));
+        storeClassGlobal(theClass, "used", createValueElement(llSizeType, newUsed, false));
+        storeClassGlobal(theClass, "reserved", createSmallInteger(0, llSizeWidth, false));
+      }
+    } deEndTclassClass;
+  }
 }
 
 // Generate a builtin function.  Parameters have already been pushed onto the
@@ -1770,6 +2806,12 @@ static void generateBuiltinMethod(deExpression expression) {
       generateExpression(deExpressionGetFirstExpression(parameters));
       llElement numElements = popElement(true);
       numElements = resizeInteger(numElements, llSizeWidth, false, false);
+      deClass columnsClass = findColumnsClass(deExpressionGetFirstExpression(accessExpression));
+      if (columnsClass != deClassNull) {
+        resizeClassColumns(columnsClass, numElements);
+        pushElement(access, access.needsFree);
+        break;
+      }
       bool hasSubArrays = arrayHasSubArrays(datatype);
       deDatatype elementDatatype = deDatatypeGetElementType(datatype);
       llElement elementSize = findDatatypeSize(elementDatatype);
@@ -1831,6 +2873,84 @@ static void generateBuiltinMethod(deExpression expression) {
               boolVal(hasSubArrays), location);
       break;
     }
+    case DE_BUILTINFUNC_ARRAYBATCHMODMUL:
+    case DE_BUILTINFUNC_ARRAYBATCHMODEXP: {
+      // Arrays of bigints are passed directly, and arrays of wide integers are
+      // converted to bigints and back.
+      deExpression otherExpression = deExpressionGetFirstExpression(parameters);
+      deExpression modulusExpression = deExpressionGetNextExpression(otherExpression);
+      generateExpression(otherExpression);
+      llElement other = popElement(false);
+      generateExpression(modulusExpression);
+      llElement modulus = popElement(true);
+      access = wideIntArrayToBigints(access);
+      other = wideIntArrayToBigints(other);
+      modulus = toBigint(modulus, false);
+      deDatatype datatype = deExpressionGetDatatype(expression);
+      llElement result = allocateTempArray(datatype);
+      char *location = locationInfo();
+      char *funcName = type == DE_BUILTINFUNC_ARRAYBATCHMODMUL?
+          "runtime_bigintBatchModularMul" :
+          "runtime_bigintBatchModularExp";
+      llDeclareRuntimeFunction(funcName);
+      llPrintf("  call void @%s(%%struct.runtime_array* %s, %%struct.runtime_array* %s, "
+          "%%struct.runtime_array* %s, %%struct.runtime_array* %s)%s\n", funcName,
+          llElementGetName(result), llElementGetName(access), llElementGetName(other),
+          llElementGetName(modulus), location);
+      deDatatype elementType = deDatatypeGetElementType(datatype);
+      if (llDatatypeIsWideInt(elementType)) {
+        popElement(false);
+        llElement wideResult = allocateTempArray(datatype);
+        llDeclareRuntimeFunction("runtime_bigintsToWideIntArray");
+        llPrintf("  call void @runtime_bigintsToWideIntArray(%%struct.runtime_array* %s, "
+            "%%struct.runtime_array* %s, i32 zeroext %u)%s\n", llElementGetName(wideResult),
+            llElementGetName(result), deDatatypeGetWidth(elementType), location);
+      }
+      break;
+    }
+    case DE_BUILTINFUNC_UINTFIXEDBASETABLE: {
+      // A table of wide integers is built as bigints and converted back.
+      generateExpression(deExpressionGetFirstExpression(parameters));
+      llElement modulus = popElement(true);
+      deDatatype baseType = llElementGetDatatype(access);
+      access = toBigint(access, deDatatypeSecret(baseType));
+      modulus = toBigint(modulus, false);
+      deDatatype datatype = deExpressionGetDatatype(expression);
+      llElement table = allocateTempArray(datatype);
+      char *location = locationInfo();
+      llDeclareRuntimeFunction("runtime_bigintFixedBaseTable");
+      llPrintf("  call void @runtime_bigintFixedBaseTable(%%struct.runtime_array* %s, "
+          "%%struct.runtime_array* %s, %%struct.runtime_array* %s)%s\n",
+          llElementGetName(table), llElementGetName(access), llElementGetName(modulus), location);
+      if (llDatatypeIsWideInt(baseType)) {
+        popElement(false);
+        llElement wideTable = allocateTempArray(datatype);
+        llDeclareRuntimeFunction("runtime_bigintsToWideIntArray");
+        llPrintf("  call void @runtime_bigintsToWideIntArray(%%struct.runtime_array* %s, "
+            "%%struct.runtime_array* %s, i32 zeroext %u)%s\n", llElementGetName(wideTable),
+            llElementGetName(table), deDatatypeGetWidth(baseType), location);
+      }
+      break;
+    }
+    case DE_BUILTINFUNC_ARRAYFIXEDBASEEXP: {
+      generateExpression(deExpressionGetFirstExpression(parameters));
+      llElement exponent = popElement(true);
+      deDatatype exponentType = llElementGetDatatype(exponent);
+      if (llDatatypeIsWideInt(exponentType)) {
+        exponent = toBigint(exponent, deDatatypeSecret(exponentType));
+      } else if (!llDatatypeIsBigint(exponentType)) {
+        exponent = convertSmallIntToBigint(exponent, deDatatypeGetWidth(exponentType), false);
+      }
+      access = wideIntArrayToBigints(access);
+      llElement result = allocateBigintResult(deExpressionGetDatatype(expression));
+      char *location = locationInfo();
+      llDeclareRuntimeFunction("runtime_bigintFixedBaseExp");
+      llPrintf("  call void @runtime_bigintFixedBaseExp(%%struct.runtime_array* %s, "
+          "%%struct.runtime_array* %s, %%struct.runtime_array* %s)%s\n",
+          llElementGetName(result), llElementGetName(access), llElementGetName(exponent), location);
+      convertTopFromBigint();
+      break;
+    }
     case DE_BUILTINFUNC_STRINGTOUINTBE:
     case DE_BUILTINFUNC_STRINGTOUINTLE: {
       deExpression widthExpression = deExpressionGetFirstExpression(parameters);
@@ -1853,6 +2973,8 @@ static void generateBuiltinMethod(deExpression expression) {
         popElement(false);  // Pop off bigint.
         llElement smallnum = convertBigintToSmallInt(bigint, width, false, false);
         pushElement(smallnum, false);
+      } else {
+        convertTopFromBigint();
       }
       break;
     }
@@ -1872,10 +2994,59 @@ static void generateBuiltinMethod(deExpression expression) {
           llElementGetName(binString), llElementGetName(access), location);
       break;
     }
+    case DE_BUILTINFUNC_STRINGSHA256:
+    case DE_BUILTINFUNC_STRINGSHA3: {
+      llElement digest = allocateTempArray(deExpressionGetDatatype(expression));
+      char *location = locationInfo();
+      char *funcName = type == DE_BUILTINFUNC_STRINGSHA256? "runtime_sha256" : "runtime_sha3";
+      llDeclareRuntimeFunction(funcName);
+      llPrintf("  call void @%s(%%struct.runtime_array* %s, %%struct.runtime_array* %s)%s\n",
+          funcName, llElementGetName(digest), llElementGetName(access), location);
+      break;
+    }
+    case DE_BUILTINFUNC_STRINGHMACSHA256: {
+      generateExpression(deExpressionGetFirstExpression(parameters));
+      llElement message = popElement(false);
+      llElement mac = allocateTempArray(deExpressionGetDatatype(expression));
+      char *location = locationInfo();
+      llDeclareRuntimeFunction("runtime_hmacSha256");
+      llPrintf("  call void @runtime_hmacSha256(%%struct.runtime_array* %s, "
+          "%%struct.runtime_array* %s, %%struct.runtime_array* %s)%s\n",
+          llElementGetName(mac), llElementGetName(access), llElementGetName(message), location);
+      break;
+    }
+    case DE_BUILTINFUNC_STRINGHASH:
+    case DE_BUILTINFUNC_UINTHASH:
+    case DE_BUILTINFUNC_INTHASH: {
+      deDatatype accessType = llElementGetDatatype(access);
+      if (type != DE_BUILTINFUNC_STRINGHASH && !llDatatypeIsBigint(accessType)) {
+        // Hash native integers as their value extended to the widest native
+        // width, in a stack slot, the same way runtime_hashBigint hashes the
+        // low words of bigints, so equal values hash the same.
+        access = resizeSmallInteger(access, deMaxNativeIntWidth, deDatatypeSigned(accessType));
+        access = storeElementAndReturnRef(access);
+        uint32 bytes = getUintPointer(access, 8);
+        llDeclareRuntimeFunction("runtime_hashBytes");
+        uint32 retValue = printNewValue();
+        llPrintf("call i64 @runtime_hashBytes(i8* %%%u, i64 %u)%s\n",
+            bytes, deMaxNativeIntWidth/8, locationInfo());
+        pushValue(deExpressionGetDatatype(expression), retValue, false);
+        break;
+      }
+      char *funcName = type == DE_BUILTINFUNC_STRINGHASH? "runtime_hashString" : "runtime_hashBigint";
+      llDeclareRuntimeFunction(funcName);
+      uint32 retValue = printNewValue();
+      llPrintf("call i64 @%s(%%struct.runtime_array* %s)%s\n",
+          funcName, llElementGetName(access), locationInfo());
+      pushValue(deExpressionGetDatatype(expression), retValue, false);
+      break;
+    }
     case DE_BUILTINFUNC_UINTTOSTRINGBE:
     case DE_BUILTINFUNC_UINTTOSTRINGLE: {
       deDatatype accessType = llElementGetDatatype(access);
-      if (!llDatatypeIsBigint(accessType)) {
+      if (llDatatypeIsWideInt(accessType)) {
+        access = toBigint(access, deDatatypeSecret(accessType));
+      } else if (!llDatatypeIsBigint(accessType)) {
         access = convertSmallIntToBigint( access, deDatatypeGetWidth(accessType), false);
       }
       deDatatype datatype = deStringDatatypeCreate();
@@ -2116,6 +3287,25 @@ static void copyOrMoveElement(llElement dest, llElement source, bool freeDest) {
   }
 }
 
+// Determine if the access expression is a local variable of the current
+// function that does not own a reference to its object: either it borrows the
+// object, or the object is in the function's region.
+static bool isBorrowedLocal(deExpression accessExpression) {
+  if (deExpressionGetType(accessExpression) != DE_EXPR_IDENT) {
+    return false;
+  }
+  deIdent ident = deExpressionGetIdent(accessExpression);
+  if (ident == deIdentNull || deIdentGetType(ident) != DE_IDENT_VARIABLE) {
+    return false;
+  }
+  deVariable variable = deIdentGetVariable(ident);
+  if (deVariableRegion(variable)) {
+    return true;
+  }
+  return llBorrowLocals && deVariableGetType(variable) == DE_VAR_LOCAL &&
+      !deVariableGenerated(variable) && deVariableGetBlock(variable) == llCurrentScopeBlock;
+}
+
 // Generate write expression.  The top level operator of the access expression
 // needs to be evaluated differently, since it needs to give us the address to
 // write to rather than the value contained there.
@@ -2124,7 +3314,16 @@ static void generateWriteExpression(deExpression accessExpression) {
   generateExpression(accessExpression);
   llElement access = popElement(false);
   deDatatype datatype = llElementGetDatatype(access);
-  if (deDatatypeContainsArray(datatype) || isRefCounted(datatype) ||
+  if (isRefCounted(datatype) && isBorrowedLocal(accessExpression)) {
+    // The object outlives the variable, so just copy the handle.  A region
+    // variable holds the only reference to its old object, so try to free it.
+    utAssert(!llElementNeedsFree(value));
+    deVariable variable = deIdentGetVariable(deExpressionGetIdent(accessExpression));
+    if (isRegionVariable(variable)) {
+      freeRegionObject(variable);
+    }
+    storeBasicType(access, value);
+  } else if (deDatatypeContainsArray(datatype) || isRefCounted(datatype) ||
       deDatatypeGetType(datatype) == DE_TYPE_TUPLE ||
       deDatatypeGetType(datatype) == DE_TYPE_STRUCT) {
     copyOrMoveElement(access, value, !deStatementIsFirstAssignment(llCurrentStatement));
@@ -2233,6 +3432,12 @@ static void generateCallExpression(deExpression expression) {
     returnType = deNoneDatatypeCreate();
   }
   bool returnsVal = deDatatypeGetType(returnType) != DE_TYPE_NONE;
+  bool regionAlloc = deExpressionRegionAlloc(expression);
+  if (regionAlloc) {
+    // Tell the class's allocate function to put the object in our region.
+    llPrintf("  store i1 true, i1* %s\n",
+        llGetVariableName(findClassGlobal(deDatatypeGetClass(returnType), "inRegion")));
+  }
   uint32 retVal = 0;
   if (returnsVal) {
     retVal = printNewValue();
@@ -2259,7 +3464,7 @@ static void generateCallExpression(deExpression expression) {
   if (returnsVal) {
     // If returned value is a reference counted object, add it to the needsFree list.
     llElement result = createValueElement(returnType, retVal, false);
-    pushElement(result, isRefCounted(returnType));
+    pushElement(result, isRefCounted(returnType) && !regionAlloc);
   } else if (returnsValuePassedByReference) {
     pushElement(returnElement, false);
   }
@@ -2298,6 +3503,30 @@ static void limitCheck(llElement index, llElement limit) {
       utSymGetName(llLimitCheckFailedLabel), locationInfo());
   if (!generatedFailBlock) {
     llPrintf("%s:\n", utSymGetName(llLimitCheckFailedLabel));
+    releaseRegions();
+    llDeclareRuntimeFunction("runtime_throwException");
+    llPrintf("  call void (%%struct.runtime_array*, ...) @runtime_throwException(%%struct.runtime_array* %s)%s\n",
+        llElementGetName(string), locationInfo());
+    llPrintf("  unreachable\n");
+  }
+  llPrintf("%s:\n", utSymGetName(passedLabel));
+  llPrevLabel = passedLabel;
+}
+
+// Throw an exception if |overflowed| is true.
+static void overflowCheck(llElement overflowed) {
+  llElement string = generateString(deCStringCreate("Integer overflow"));
+  utSym passedLabel = newLabel("overflowCheckPassed");
+  bool generatedFailBlock = llOverflowCheckFailedLabel != utSymNull;
+  if (!generatedFailBlock) {
+    llOverflowCheckFailedLabel = newLabel("overflowCheckFailed");
+  }
+  llPrintf("  br i1 %s, label %%%s, label %%%s%s\n",
+      llElementGetName(overflowed), utSymGetName(llOverflowCheckFailedLabel),
+      utSymGetName(passedLabel), locationInfo());
+  if (!generatedFailBlock) {
+    llPrintf("%s:\n", utSymGetName(llOverflowCheckFailedLabel));
+    releaseRegions();
     llDeclareRuntimeFunction("runtime_throwException");
     llPrintf("  call void (%%struct.runtime_array*, ...) @runtime_throwException(%%struct.runtime_array* %s)%s\n",
         llElementGetName(string), locationInfo());
@@ -2332,6 +3561,7 @@ static void boundsCheck(llElement array, llElement index, char *message) {
       utSymGetName(llBoundsCheckFailedLabel), locationInfo());
   if (!generatedFailBlock) {
     llPrintf("%s:\n", utSymGetName(llBoundsCheckFailedLabel));
+    releaseRegions();
     llDeclareRuntimeFunction("runtime_throwException");
     llPrintf("  call void (%%struct.runtime_array*, ...) @runtime_throwException(%%struct.runtime_array* %s)%s\n",
         llElementGetName(string), locationInfo());
@@ -2372,6 +3602,39 @@ static void generateMemberAccess(deIdent ident, deExpression left, deExpression
   char *arrayName = llGetVariableName(arrayVar);
   llElement array = createElement(deVariableGetDatatype(arrayVar), arrayName, true);
   indexArray(array, index, true);
+  if (deVariableGetFieldGroup(variable) != deFieldGroupNull) {
+    // The member shares an array of tuples with members accessed with it.
+    llElement tuple = popElement(false);
+    llElement element = indexTuple(tuple, deVariableGetFieldGroupIndex(variable), true);
+    pushElement(element, false);
+  }
+}
+
+// Index into an array with a secret index.  The runtime reads every element,
+// and selects the one we want with a mask, so neither timing nor the cache
+// reveal the index.
+static void generateSecretIndexExpression(deExpression expression, llElement array,
+    llElement index) {
+  deDatatype datatype = deExpressionGetDatatype(expression);
+  deDatatype elementDatatype = getElementType(llElementGetDatatype(array));
+  index = resizeInteger(index, 64, false, false);
+  llElement elementSize = findDatatypeSize(elementDatatype);
+  llDeclareRuntimeFunction("runtime_secretLookup");
+  uint32 value = printNewValue();
+  llPrintf("call i64 @runtime_secretLookup(%%struct.runtime_array* %s, i64 %s, i%s %s)%s\n",
+      llElementGetName(array), llElementGetName(index), llSize,
+      llElementGetName(elementSize), locationInfo());
+  deDatatype intType = datatype;
+  if (deDatatypeGetType(datatype) == DE_TYPE_MODINT) {
+    intType = deExpressionGetDatatype(deDatatypeGetModulus(datatype));
+  }
+  uint32 width = deDatatypeGetType(intType) == DE_TYPE_BOOL? 1 : deDatatypeGetWidth(intType);
+  if (width < 64) {
+    uint32 truncValue = printNewValue();
+    llPrintf("trunc i64 %%%u to %s\n", value, llGetTypeString(datatype, false));
+    value = truncValue;
+  }
+  pushValue(datatype, value, false);
 }
 
 // Generate an index expression.
@@ -2379,7 +3642,13 @@ static void generateIndexExpression(deExpression expression) {
   deExpression left = deExpressionGetFirstExpression(expression);
   deExpression right = deExpressionGetNextExpression(left);
   deDatatypeType type = deDatatypeGetType(deExpressionGetDatatype(left));
-  if (type == DE_TYPE_ARRAY || type == DE_TYPE_STRING) {
+  if (deDatatypeSecret(deExpressionGetDatatype(right))) {
+    generateExpression(left);
+    llElement array = popElement(false);
+    generateExpression(right);
+    llElement index = popElement(true);
+    generateSecretIndexExpression(expression, array, index);
+  } else if (type == DE_TYPE_ARRAY || type == DE_TYPE_STRING) {
     generateExpression(left);
     llElement array = popElement(false);
     generateExpression(right);
@@ -2423,6 +3692,33 @@ static void generateSliceExpression(deExpression expression) {
       llSize, llElementGetName(sizeValue), boolVal(hasSubArrays), location);
 }
 
+// Count a load or store of a data member in the profile written with -profgen.
+// Each site is a column, member, function, and access type, with its own
+// counter.  Assignments to the member are stores, operator-assignments are both
+// a load and a store, and all other uses are loads.
+static void countFieldAccess(deExpression expression, deVariable variable) {
+  deExpression parent = deExpressionGetExpression(expression);
+  // An op-equals assignment, like x.f += 1, generates its target twice: first
+  // as the left operand, while its type is temporarily the plain operator, and
+  // then to write it.  The first counts as a load, and the second as a store.
+  bool isStore = false;
+  if (parent != deExpressionNull && deExpressionGetFirstExpression(parent) == expression) {
+    deExpressionType parentType = deExpressionGetType(parent);
+    isStore = parentType == DE_EXPR_EQUALS ||
+        (parentType >= DE_EXPR_ADD_EQUALS && parentType <= DE_EXPR_MULTRUNC_EQUALS);
+  }
+  deVariable arrayVar = deVariableGetGlobalArrayVariable(variable);
+  char *function = *llPath != '\0'? llPath : "main";
+  uint32 num = llAddFieldSite(utSymCreateFormatted("%s\t%s\t%s\t%s",
+      deVariableGetName(arrayVar), deVariableGetName(variable), function,
+      isStore? "store" : "load"));
+  uint32 count = printNewValue();
+  llPrintf("load i64, i64* @.fieldCount%u\n", num);
+  uint32 newCount = printNewValue();
+  llPrintf("add i64 %%%u, 1\n", count);
+  llPrintf("  store i64 %%%u, i64* @.fieldCount%u\n", newCount, num);
+}
+
 // Generate code to read a member variable.
 static void generateClassAccess(deExpression expression) {
   deExpression left = deExpressionGetFirstExpression(expression);
@@ -2436,6 +3732,9 @@ static void generateClassAccess(deExpression expression) {
   utAssert(ident != deIdentNull);
   switch (deIdentGetType(ident)) {
     case DE_IDENT_VARIABLE:
+      if (deFieldProfileGenFile != NULL) {
+        countFieldAccess(expression, deIdentGetVariable(ident));
+      }
       generateMemberAccess(ident, left, right);
       break;
     case DE_IDENT_FUNCTION: {
@@ -2562,7 +3861,7 @@ static bool isConstant(deExpression expression) {
   deExpressionType type = deExpressionGetType(expression);
   if (type == DE_EXPR_INTEGER) {
     deDatatype datatype = deExpressionGetDatatype(expression);
-    if (deDatatypeGetWidth(datatype) > llSizeWidth) {
+    if (llDatatypeIsBigint(datatype)) {
       return false;
     }
   }
@@ -2734,7 +4033,7 @@ static void generateSignedCastExpression(deExpression expression, bool isSigned)
   deExpression child = deExpressionGetFirstExpression(expression);
   generateExpression(child);
   uint32 width = deDatatypeGetWidth(datatype);
-  if (width <= llSizeWidth) {
+  if (!llDatatypeIsBigint(datatype)) {
     llElement *element = topOfStack();
     deDatatype datatype = deDatatypeSetSigned(llElementGetDatatype(*element), isSigned);
     element->datatype = datatype;
@@ -2753,6 +4052,7 @@ static void generateSignedCastExpression(deExpression expression, bool isSigned)
 // Generate a call to runtime_bigintExp.
 static void generateBigintExp(deExpression expression) {
   llDeclareRuntimeFunction("runtime_bigintExp");
+  deDatatype datatype = deExpressionGetDatatype(expression);
   deExpression base = deExpressionGetFirstExpression(expression);
   deExpression exp = deExpressionGetNextExpression(base);
   generateExpression(base);
@@ -2760,12 +4060,14 @@ static void generateBigintExp(deExpression expression) {
   generateExpression(exp);
   llElement expElement = popElement(true);
   expElement = resizeInteger(expElement, 32, false, false);
-  llElement destArray = allocateTempValue(deExpressionGetDatatype(expression));
+  baseElement = toBigint(baseElement, deDatatypeSecret(datatype));
+  llElement destArray = allocateBigintResult(datatype);
   llPrintf(
       "  call void @runtime_bigintExp(%%struct.runtime_array* %s, %%struct.runtime_array* %s, "
       "i32 %s)%s\n",
       llElementGetName(destArray), llElementGetName(baseElement),
       llElementGetName(expElement), locationInfo());
+  convertTopFromBigint();
 }
 
 // Generate a call to runtime_smallnumExp.
@@ -2799,16 +4101,101 @@ static void generateExpExpression(deExpression expression) {
     return;
   }
   deDatatype datatype = deExpressionGetDatatype(expression);
-  if (llDatatypeIsBigint(datatype)) {
+  if (llDatatypeIsBigint(datatype) || llDatatypeIsWideInt(datatype)) {
     generateBigintExp(expression);
   } else {
     generateSmallnumExp(expression);
   }
 }
 
+// Return the reduction constant of the modint expression being generated, or
+// deExpressionNull if its modulus is not a constant.
+static deExpression findReductionConstant(void) {
+  if (llModintExpression == deExpressionNull ||
+      deExpressionGetReductionType(llModintExpression) == DE_REDUCE_GENERIC) {
+    return deExpressionNull;
+  }
+  return deExpressionGetLastExpression(llModintExpression);
+}
+
+// Return the name of the runtime_constModulus global for the constant modulus
+// of the modint expression being generated.
+static char *findConstModulusName(void) {
+  deExpression valueExpression = deExpressionGetFirstExpression(llModintExpression);
+  deExpression modulusExpression = deExpressionGetNextExpression(valueExpression);
+  uint32 num = llAddConstModulus(modulusExpression, findReductionConstant(),
+      deExpressionGetReductionType(llModintExpression));
+  return utSprintf("@.constModulus%u", num);
+}
+
+// Generate a call to the runtime modular multiply or exponentiation for a
+// constant modulus.  |right| is the second factor or the exponent.  The
+// runtime caches the reduction context in the modulus's global.  Native wide
+// integers are passed by reference as words, rather than converted to bigints,
+// unless the exponent is signed or a bigint.
+static void generateReducedModularCall(deExpression expression, llElement left,
+    llElement right) {
+  deDatatype datatype = deExpressionGetDatatype(expression);
+  bool isExp = deExpressionGetType(expression) == DE_EXPR_EXP;
+  char *constModulus = utAllocString(findConstModulusName());
+  deDatatype rightType = llElementGetDatatype(right);
+  char *location = locationInfo();
+  if (llDatatypeIsWideInt(datatype) && (!isExp ||
+      (!llDatatypeIsBigint(rightType) && !deDatatypeSigned(rightType)))) {
+    uint32 width = deDatatypeGetWidth(datatype);
+    llElement leftWords = getWideIntWords(left);
+    if (!llDatatypeIsWideInt(rightType)) {
+      right = resizeSmallInteger(right, llSizeWidth, false);
+    }
+    uint32 rightWidth = deDatatypeGetWidth(llElementGetDatatype(right));
+    llElement rightWords = getWideIntWords(right);
+    llElement result = allocateTempValue(deUintDatatypeCreate((width + 63) & ~63));
+    popElement(false);
+    llElement resultWords = getWideIntWords(result);
+    if (isExp) {
+      llDeclareRuntimeFunction("runtime_wideIntConstModularExp");
+      llPrintf("  call void @runtime_wideIntConstModularExp(i64* %s, i64* %s, i64* %s, "
+          "i32 zeroext %u, %%struct.runtime_constModulus* %s)%s\n",
+          llElementGetName(resultWords), llElementGetName(leftWords),
+          llElementGetName(rightWords), rightWidth, constModulus, location);
+    } else {
+      llDeclareRuntimeFunction("runtime_wideIntConstModularMul");
+      llPrintf("  call void @runtime_wideIntConstModularMul(i64* %s, i64* %s, i64* %s, "
+          "%%struct.runtime_constModulus* %s)%s\n",
+          llElementGetName(resultWords), llElementGetName(leftWords),
+          llElementGetName(rightWords), constModulus, location);
+    }
+    derefElement(&result);
+    pushElement(resizeSmallInteger(result, width, false), false);
+    utFree(constModulus);
+    return;
+  }
+  bool secret = deDatatypeSecret(datatype);
+  left = toBigint(left, secret);
+  if (!isExp) {
+    right = toBigint(right, secret);
+  } else if (llDatatypeIsWideInt(rightType)) {
+    right = toBigint(right, deDatatypeSecret(rightType));
+  } else if (!llDatatypeIsBigint(rightType)) {
+    right = convertSmallIntToBigint(right, deDatatypeGetWidth(rightType),
+        deDatatypeSigned(rightType));
+  }
+  char *function = isExp? "runtime_bigintConstModularExp" : "runtime_bigintConstModularMul";
+  llDeclareRuntimeFunction(function);
+  llElement destArray = allocateBigintResult(datatype);
+  llPrintf("  call void @%s(%%struct.runtime_array* %s, %%struct.runtime_array* %s, "
+           "%%struct.runtime_array* %s, %%struct.runtime_constModulus* %s)%s\n",
+      function, llElementGetName(destArray), llElementGetName(left),
+      llElementGetName(right), constModulus, location);
+  convertTopFromBigint();
+  utFree(constModulus);
+}
+
 // Generate a modular exponentiation bigint call.
 static void generateModularBigintExp(deExpression expression, llElement modulusElement) {
   llDeclareRuntimeFunction("runtime_bigintModularExp");
+  deDatatype datatype = deExpressionGetDatatype(expression);
+  bool secret = deDatatypeSecret(datatype);
   deExpression base = deExpressionGetFirstExpression(expression);
   deExpression exp = deExpressionGetNextExpression(base);
   generateModularExpression(base, modulusElement);
@@ -2817,11 +4204,19 @@ static void generateModularBigintExp(deExpression expression, llElement modulusE
   // factorization of the modulus.
   generateExpression(exp);
   llElement expElement = popElement(true);
-  if (!llDatatypeIsBigint(expElement.datatype)) {
+  if (findReductionConstant() != deExpressionNull) {
+    generateReducedModularCall(expression, baseElement, expElement);
+    return;
+  }
+  if (llDatatypeIsWideInt(expElement.datatype)) {
+    expElement = toBigint(expElement, deDatatypeSecret(deExpressionGetDatatype(exp)));
+  } else if (!llDatatypeIsBigint(expElement.datatype)) {
     expElement = convertSmallIntToBigint(expElement, deDatatypeGetWidth(expElement.datatype),
         deDatatypeSigned(llElementGetDatatype(expElement)));
   }
-  llElement destArray = allocateTempValue(deExpressionGetDatatype(expression));
+  baseElement = toBigint(baseElement, secret);
+  modulusElement = toBigint(modulusElement, false);
+  llElement destArray = allocateBigintResult(datatype);
   llPrintf(
       "  call void @runtime_bigintModularExp(%%struct.runtime_array* %s, %%struct.runtime_array* "
       "%s, "
@@ -2829,6 +4224,7 @@ static void generateModularBigintExp(deExpression expression, llElement modulusE
       llElementGetName(destArray), llElementGetName(baseElement),
       llElementGetName(expElement), llElementGetName(modulusElement),
       locationInfo());
+  convertTopFromBigint();
 }
 
 // Generate a modular exponentiation smallnum call.
@@ -2857,7 +4253,7 @@ static void generateModularSmallnumExp(deExpression expression, llElement modulu
 // Generate a non-modular exponentiation expression.
 static void generateModularExpExpression(deExpression expression, llElement modulusElement) {
   deDatatype datatype = deExpressionGetDatatype(expression);
-  if (llDatatypeIsBigint(datatype)) {
+  if (llDatatypeIsBigint(datatype) || llDatatypeIsWideInt(datatype)) {
     generateModularBigintExp(expression, modulusElement);
   } else {
     generateModularSmallnumExp(expression, modulusElement);
@@ -2926,7 +4322,7 @@ static void generateNegateExpression(deExpression expression) {
     uint32 value = printNewValue();
     llPrintf("fneg %s %s\n", type, llElementGetName(leftElement));
     pushValue(datatype, value, false);
-  } else if (deDatatypeGetWidth(datatype) > llSizeWidth) {
+  } else if (llDatatypeIsBigint(datatype)) {
     llDeclareRuntimeFunction("runtime_bigintNegate");
     llElement resultArray = allocateTempValue(datatype);
     llPrintf(
@@ -2946,10 +4342,11 @@ static void generateRandomUint(deExpression expression) {
   uint32 width = deDatatypeGetWidth(datatype);
   char *location = locationInfo();
   if (width > llSizeWidth) {
-    llElement dest = allocateTempValue(datatype);
+    llElement dest = allocateBigintResult(datatype);
     llDeclareRuntimeFunction("runtime_generateTrueRandomBigint");
     llPrintf("  call void @runtime_generateTrueRandomBigint(%%struct.runtime_array* %s, i32 %u)%s\n",
         llElementGetName(dest), width, location);
+    convertTopFromBigint();
   } else {
     uint32 value = printNewValue();
     llDeclareRuntimeFunction("runtime_generateTrueRandomValue");
@@ -2978,7 +4375,7 @@ static bool couldBeGreaterOrEqual(deExpression expression, uint32 width) {
 static void generateBigintShiftOrRotateExpression(deExpression expression) {
   deDatatype datatype = deExpressionGetDatatype(expression);
   uint32 width = deDatatypeGetWidth(datatype);
-  utAssert(width > llSizeWidth);
+  utAssert(llDatatypeIsBigint(datatype));
   deExpression left = deExpressionGetFirstExpression(expression);
   deExpression right = deExpressionGetNextExpression(left);
   generateExpression(left);
@@ -3001,6 +4398,30 @@ static void generateBigintShiftOrRotateExpression(deExpression expression) {
       llElementGetName(rightElement), locationInfo());
 }
 
+// Generate a rotate of a wide integer with a pair of shifts, rather than the
+// funnel-shift intrinsics.  Shifting the other way by 1 and then by
+// width - 1 - dist avoids a poison shift by width when dist is 0.
+static void generateWideRotate(deDatatype datatype, llElement value, llElement dist,
+    bool rotateLeft) {
+  uint32 width = deDatatypeGetWidth(datatype);
+  char *location = locationInfo();
+  char *valueName = llElementGetName(value);
+  char *distName = llElementGetName(dist);
+  char *forward = rotateLeft? "shl" : "lshr";
+  char *backward = rotateLeft? "lshr" : "shl";
+  uint32 forwardValue = printNewValue();
+  llPrintf("%s i%u %s, %s%s\n", forward, width, valueName, distName, location);
+  uint32 backwardDist = printNewValue();
+  llPrintf("sub i%u %u, %s%s\n", width, width - 1, distName, location);
+  uint32 backwardOne = printNewValue();
+  llPrintf("%s i%u %s, 1%s\n", backward, width, valueName, location);
+  uint32 backwardValue = printNewValue();
+  llPrintf("%s i%u %%%u, %%%u%s\n", backward, width, backwardOne, backwardDist, location);
+  uint32 result = printNewValue();
+  llPrintf("or i%u %%%u, %%%u%s\n", width, forwardValue, backwardValue, location);
+  pushValue(datatype, result, false);
+}
+
 // Generate a rotate left/right intrinsic.
 static void generateShiftOrRotateExpression(deExpression expression) {
   deSignature signature = deExpressionGetSignature(expression);
@@ -3010,7 +4431,7 @@ static void generateShiftOrRotateExpression(deExpression expression) {
   }
   deDatatype datatype = deExpressionGetDatatype(expression);
   uint32 width = deDatatypeGetWidth(datatype);
-  if (width > llSizeWidth) {
+  if (llDatatypeIsBigint(datatype)) {
     generateBigintShiftOrRotateExpression(expression);
     return;
   }
@@ -3054,6 +4475,10 @@ static void generateShiftOrRotateExpression(deExpression expression) {
     default:
       utExit("Unexpected shift/rotate type");
   }
+  if (isRotate && width > llSizeWidth) {
+    generateWideRotate(datatype, leftElement, rightElement, !strcmp(operation, "fshl"));
+    return;
+  }
   uint32 value = printNewValue();
   char *location = locationInfo();
   if (isRotate) {
@@ -3072,28 +4497,40 @@ static void generateShiftOrRotateExpression(deExpression expression) {
 // Write a binary modular expression.
 static void generateBinaryModularExpression(deExpression expression, llElement modulusElement) {
   deDatatype datatype = deExpressionGetDatatype(expression);
+  // Wide modular integers are emulated with the bigint runtime.
+  bool isBigint = llDatatypeIsBigint(datatype) || llDatatypeIsWideInt(datatype);
   deExpression left = deExpressionGetFirstExpression(expression);
   deExpression right = deExpressionGetNextExpression(left);
   generateModularExpression(left, modulusElement);
-  if (!llDatatypeIsBigint(datatype)) {
+  if (!isBigint) {
     resizeTop(llSizeWidth);
   }
   llElement leftElement = popElement(true);
   generateModularExpression(right, modulusElement);
-  if (!llDatatypeIsBigint(datatype)) {
+  if (!isBigint) {
     resizeTop(llSizeWidth);
     modulusElement = resizeSmallInteger(modulusElement, llSizeWidth, false);
   }
   llElement rightElement = popElement(true);
+  if (isBigint && deExpressionGetType(expression) == DE_EXPR_MUL &&
+      findReductionConstant() != deExpressionNull) {
+    generateReducedModularCall(expression, leftElement, rightElement);
+    return;
+  }
   char *function = findExpressionFunction(expression);
   char *location = locationInfo();
   llDeclareRuntimeFunction(function);
-  if (llDatatypeIsBigint(datatype)) {
-    llElement resultArray = allocateTempValue(datatype);
+  if (isBigint) {
+    bool secret = deDatatypeSecret(datatype);
+    leftElement = toBigint(leftElement, secret);
+    rightElement = toBigint(rightElement, secret);
+    modulusElement = toBigint(modulusElement, false);
+    llElement resultArray = allocateBigintResult(datatype);
     llPrintf("  call void @%s(%%struct.runtime_array* %s, %%struct.runtime_array* %s, "
              "%%struct.runtime_array* %s, %%struct.runtime_array* %s)%s\n",
         function, llElementGetName(resultArray), llElementGetName(leftElement),
         llElementGetName(rightElement), llElementGetName(modulusElement), location);
+    convertTopFromBigint();
   } else {
     bool secret = deDatatypeSecret(datatype);
     uint32 value = printNewValue();
@@ -3125,17 +4562,24 @@ static void modularReduction(deExpression expression,
     modDatatype = llElementGetDatatype(modulusElement);
   }
   char *location = locationInfo();
-  if (llDatatypeIsBigint(modDatatype)) {
+  bool isSigned = deDatatypeGetType(valDatatype) == DE_TYPE_INT;
+  bool secret = deDatatypeSecret(valDatatype);
+  // Wide integers use urem when LLVM can lower it, and otherwise the bigint
+  // runtime.
+  bool wideNeedsRuntime = llDatatypeIsWideInt(modDatatype) &&
+      (isSigned || secret || deDatatypeGetWidth(modDatatype) > 128);
+  if (llDatatypeIsBigint(modDatatype) || wideNeedsRuntime) {
     char *function = "runtime_bigintMod";
     llDeclareRuntimeFunction(function);
-    llElement resultArray = allocateTempValue(modDatatype);
+    valueElement = toBigint(valueElement, secret);
+    modulusElement = toBigint(modulusElement, false);
+    llElement resultArray = allocateBigintResult(modDatatype);
     llPrintf("  call void @%s(%%struct.runtime_array* %s, %%struct.runtime_array* %s, "
              "%%struct.runtime_array* %s)%s\n",
         function, llElementGetName(resultArray), llElementGetName(valueElement),
         llElementGetName(modulusElement), location);
+    convertTopFromBigint();
   } else {
-    bool isSigned = deDatatypeGetType(valDatatype) == DE_TYPE_INT;
-    bool secret = deDatatypeSecret(valDatatype);
     if (!isSigned && !secret) {
       // The simple case where the value is unsigned maps to urem.
       char *type = llGetTypeString(modDatatype, false);
@@ -3264,7 +4708,10 @@ static void generateModintExpression(deExpression expression) {
   deExpression modulusExpr = deExpressionGetNextExpression(left);
   generateExpression(modulusExpr);
   llElement modulusElement = popElement(true);
+  deExpression savedModintExpression = llModintExpression;
+  llModintExpression = expression;
   generateModularExpression(left, modulusElement);
+  llModintExpression = savedModintExpression;
 }
 
 // Jump to the label.
@@ -3912,10 +5359,16 @@ static void generateReturnStatement(deStatement statement) {
   deFunctionType funcType = deFunctionGetType(deBlockGetOwningFunction(llCurrentScopeBlock));
   if (funcType == DE_FUNC_DESTRUCTOR) {
     generateCallToFreeFunc();
+  } else if (funcType == DE_FUNC_COMPACTOR) {
+    generateCompactMethod();
+  } else if (funcType == DE_FUNC_ALLOCATOR) {
+    generateAllocateManyMethod();
+    return;
   }
   if (funcType == DE_FUNC_CONSTRUCTOR) {
     // This is a constructor.  Return self.
     freeElements(true);
+    endReservations();
     deVariable self = deBlockGetFirstVariable(llCurrentScopeBlock);
     deDatatype selfType = deVariableGetDatatype(self);
     utAssert(deDatatypeGetType(selfType) == DE_TYPE_CLASS);
@@ -3924,6 +5377,8 @@ static void generateReturnStatement(deStatement statement) {
     llPrintf("  ret i%u %s%s\n", deClassGetRefWidth(theClass), llGetVariableName(self), location);
   } else if (expression == deExpressionNull) {
     freeElements(true);
+    releaseRegions();
+    endReservations();
     char *location = locationInfo();
     llPrintf("  ret void%s\n", location);
   } else {
@@ -3934,6 +5389,8 @@ static void generateReturnStatement(deStatement statement) {
       llElement retVal = createElement(returnType, "%.retVal", true);
       copyOrMoveElement(retVal, *elementPtr, false);
       freeElements(true);
+      releaseRegions();
+      endReservations();
       llPrintf("  ret void%s\n", locationInfo());
     } else {
       llElement element = popElement(true);
@@ -3942,6 +5399,8 @@ static void generateReturnStatement(deStatement statement) {
         refObject(element);
       }
       freeElements(true);
+      releaseRegions();
+      endReservations();
       llPrintf("  ret %s %s%s\n", llGetTypeString(returnType, false),
           llElementGetName(element), locationInfo());
     }
@@ -4069,6 +5528,165 @@ static utSym generateBlockStatements(deBlock block, utSym label) {
   return label;
 }
 
+// Determine if the datatype is a reference counted class, whether or not the
+// current statement is generated.
+static bool classIsRefCounted(deDatatype datatype) {
+  return deDatatypeGetType(datatype) == DE_TYPE_CLASS &&
+      deTclassRefCounted(deClassGetTclass(deDatatypeGetClass(datatype)));
+}
+
+// Determine if the datatype holds reference counted objects inside an array,
+// tuple, or struct.  Copies of these ref and unref their objects as a side
+// effect, which we do not try to track.
+static bool datatypeHoldsRefCountedObjects(deDatatype datatype) {
+  switch (deDatatypeGetType(datatype)) {
+    case DE_TYPE_ARRAY:
+      return classIsRefCounted(deArrayDatatypeGetBaseDatatype(datatype)) ||
+          datatypeHoldsRefCountedObjects(deArrayDatatypeGetBaseDatatype(datatype));
+    case DE_TYPE_STRUCT:
+      return datatypeHoldsRefCountedObjects(deGetStructTupleDatatype(datatype));
+    case DE_TYPE_TUPLE:
+      for (uint32 i = 0; i < deDatatypeGetNumTypeList(datatype); i++) {
+        deDatatype subType = deDatatypeGetiTypeList(datatype, i);
+        if (classIsRefCounted(subType) || datatypeHoldsRefCountedObjects(subType)) {
+          return true;
+        }
+      }
+      return false;
+    default:
+      return false;
+  }
+}
+
+// Determine if evaluating the expression could destroy an object.  Objects are
+// only destroyed when their last reference is dropped, so we look for calls,
+// which could do anything, and overwrites of references held outside of the
+// function's local variables.
+static bool expressionCanDestroy(deBlock block, deExpression expression) {
+  deDatatype datatype = deExpressionGetDatatype(expression);
+  if (datatype != deDatatypeNull && datatypeHoldsRefCountedObjects(datatype)) {
+    return true;
+  }
+  deExpressionType type = deExpressionGetType(expression);
+  if (type == DE_EXPR_CALL && !isBuiltinCall(expression)) {
+    return true;
+  }
+  if (type == DE_EXPR_EQUALS) {
+    deExpression access = deExpressionGetFirstExpression(expression);
+    deDatatype accessType = deExpressionGetDatatype(access);
+    if (accessType != deDatatypeNull && classIsRefCounted(accessType)) {
+      if (deExpressionGetType(access) != DE_EXPR_IDENT) {
+        return true;
+      }
+      deIdent ident = deExpressionGetIdent(access);
+      if (ident == deIdentNull || deIdentGetType(ident) != DE_IDENT_VARIABLE) {
+        return true;
+      }
+      deVariable variable = deIdentGetVariable(ident);
+      if (deVariableGetType(variable) != DE_VAR_LOCAL || deVariableGetBlock(variable) != block) {
+        return true;
+      }
+    }
+  }
+  deExpression child;
+  deForeachExpressionExpression(expression, child) {
+    if (expressionCanDestroy(block, child)) {
+      return true;
+    }
+  } deEndExpressionExpression;
+  return false;
+}
+
+// Determine if any statement in the sub-block could destroy an object.
+static bool statementsCanDestroy(deBlock block, deBlock subBlock) {
+  deStatement statement;
+  deForeachBlockStatement(subBlock, statement) {
+    if (!deStatementInstantiated(statement)) {
+      continue;
+    }
+    if (deStatementGetType(statement) == DE_STATEMENT_UNREF) {
+      return true;
+    }
+    deExpression expression = deStatementGetExpression(statement);
+    if (expression != deExpressionNull && expressionCanDestroy(block, expression)) {
+      return true;
+    }
+    deBlock statementBlock = deStatementGetSubBlock(statement);
+    if (statementBlock != deBlockNull && statementsCanDestroy(block, statementBlock)) {
+      return true;
+    }
+  } deEndBlockStatement;
+  return false;
+}
+
+// Determine if reference counted locals of the function can borrow their
+// objects.  If nothing in the function can destroy an object, every object a
+// local points to stays alive until the function returns, because whoever
+// owned it on entry still does.  The locals then need no ref when assigned and
+// no unref when overwritten or going out of scope.  This is decided per
+// signature, since each signature binds the block to different datatypes.
+static bool canBorrowLocals(deBlock block) {
+  deFunctionType type = deFunctionGetType(deBlockGetOwningFunction(block));
+  if (type != DE_FUNC_PLAIN && type != DE_FUNC_OPERATOR) {
+    return false;
+  }
+  deVariable variable;
+  deForeachBlockVariable(block, variable) {
+    deDatatype datatype = deVariableGetDatatype(variable);
+    if (datatype != deDatatypeNull && datatypeHoldsRefCountedObjects(datatype)) {
+      return false;
+    }
+  } deEndBlockVariable;
+  return !statementsCanDestroy(block, block);
+}
+
+// Add the tclass of each allocateMany call in the expression to
+// llReservingTclasses.
+static void findAllocateManyCalls(deExpression expression) {
+  if (deExpressionGetType(expression) == DE_EXPR_CALL) {
+    deSignature signature = deExpressionGetSignature(expression);
+    if (signature != deSignatureNull &&
+        deFunctionGetType(deSignatureGetFunction(signature)) == DE_FUNC_ALLOCATOR) {
+      deFunction allocator = deSignatureGetFunction(signature);
+      deFunction constructor = deBlockGetOwningFunction(deFunctionGetBlock(allocator));
+      deTclass tclass = deFunctionGetTclass(constructor);
+      uint32 i = 0;
+      while (i < llNumReservingTclasses && llReservingTclasses[i] != tclass) {
+        i++;
+      }
+      if (i == llNumReservingTclasses) {
+        if (llNumReservingTclasses == llReservingTclassesAllocated) {
+          llReservingTclassesAllocated <<= 1;
+          utResizeArray(llReservingTclasses, llReservingTclassesAllocated);
+        }
+        llReservingTclasses[llNumReservingTclasses++] = tclass;
+      }
+    }
+  }
+  deExpression child;
+  deForeachExpressionExpression(expression, child) {
+    findAllocateManyCalls(child);
+  } deEndExpressionExpression;
+}
+
+// Find the tclasses whose allocateMany is called by statements in the block.
+static void findReservingTclasses(deBlock block) {
+  deStatement statement;
+  deForeachBlockStatement(block, statement) {
+    if (!deStatementInstantiated(statement)) {
+      continue;
+    }
+    deExpression expression = deStatementGetExpression(statement);
+    if (expression != deExpressionNull) {
+      findAllocateManyCalls(expression);
+    }
+    deBlock subBlock = deStatementGetSubBlock(statement);
+    if (subBlock != deBlockNull) {
+      findReservingTclasses(subBlock);
+    }
+  } deEndBlockStatement;
+}
+
 // Reset LLVM local data on variables in the block.
 static void resetBlock(deBlock block, deSignature signature) {
   uint32 xParam = 0;
@@ -4104,10 +5722,18 @@ static void generateBlockAssemblyCode(deBlock block, deSignature signature) {
   }
   llStackPos = 0;
   llCurrentScopeBlock = block;
+  llBorrowLocals = signature != deSignatureNull && canBorrowLocals(block);
+  llNumReservingTclasses = 0;
+  findReservingTclasses(block);
   printFunctionHeader(block, signature);
+  llNumRegions = 0;
+  if (signature != deSignatureNull) {
+    saveRegionMarks(block);
+  }
   llLabelNum = 1;
   llLimitCheckFailedLabel = utSymNull;
   llBoundsCheckFailedLabel = utSymNull;
+  llOverflowCheckFailedLabel = utSymNull;
   generateBlockStatements(block, utSymNull);
   llPrintf("}\n\n");
   utFree(llPath);
@@ -4131,7 +5757,143 @@ static void printHeader(void) {
       "%s\n\n"
       "%%struct.runtime_array = type {i64*, i64}\n",
       triple);
+  fputs("%struct.runtime_constModulus = type { i8*, i64*, i64*, i32, i32, i32 }\n", llAsmFile);
   fputs("%struct.runtime_bool = type { i32 }\n", llAsmFile);
+  fputs("%struct.runtime_columnInfo = type { i8*, i8*, %struct.runtime_array*, i64 }\n"
+      "%struct.runtime_classInfo = type { i8*, i32, i64, %struct.runtime_columnInfo*, "
+      "i8*, i8*, i8* }\n", llAsmFile);
+}
+
+// Return the name of the class's column owned by |variable|.  Members in a field
+// group share a column, as does the member overlaid on nextFree.
+static char *findColumnName(deClass theClass, deVariable variable) {
+  deFieldGroup fieldGroup = deVariableGetFieldGroup(variable);
+  if (fieldGroup == deFieldGroupNull) {
+    deVariable overlay = deClassGetFreeListVariable(theClass);
+    if (overlay != deVariableNull &&
+        variable == deBlockGetFirstVariable(deClassGetSubBlock(theClass))) {
+      return utSprintf("%s,%s", deVariableGetName(variable), deVariableGetName(overlay));
+    }
+    return deVariableGetName(variable);
+  }
+  char *name = "";
+  char *separator = "";
+  deVariable member;
+  deForeachFieldGroupVariable(fieldGroup, member) {
+    name = utSprintf("%s%s%s", name, separator, deVariableGetName(member));
+    separator = ",";
+  } deEndFieldGroupVariable;
+  return name;
+}
+
+// Write a C string constant named @.<name>, and return a pointer to it for use
+// in constant initializers.
+static char *writeTableString(char *name, char *text) {
+  uint32 len = strlen(text) + 1;
+  fprintf(llAsmFile, "@.%s = private unnamed_addr constant [%u x i8] c\"%s\\00\"\n",
+      name, len, llEscapeText(text));
+  return utSprintf("i8* getelementptr inbounds ([%u x i8], [%u x i8]* @.%s, i32 0, i32 0)",
+      len, len, name);
+}
+
+// Write the column descriptions of a class for the class table, as
+// @.classColumns<classNum>.  Return the number of columns.
+static uint32 writeClassColumns(deClass theClass, uint32 classNum) {
+  deBlock block = deClassGetSubBlock(theClass);
+  uint32 numColumns = 0;
+  deVariable variable;
+  deForeachBlockVariable(block, variable) {
+    if (memberOwnsArray(theClass, variable)) {
+      numColumns++;
+    }
+  } deEndBlockVariable;
+  char **entries = utNewA(char *, numColumns);
+  uint32 column = 0;
+  deForeachBlockVariable(block, variable) {
+    if (memberOwnsArray(theClass, variable)) {
+      deVariable arrayVar = deVariableGetGlobalArrayVariable(variable);
+      deDatatype elementType = deDatatypeGetElementType(deVariableGetDatatype(arrayVar));
+      char *type = llGetTypeString(elementType, true);
+      char *name = writeTableString(utSprintf("columnName%u.%u", classNum, column),
+          findColumnName(theClass, variable));
+      name = utAllocString(name);
+      char *typeName = writeTableString(utSprintf("columnType%u.%u", classNum, column),
+          deDatatypeGetTypeString(elementType));
+      entries[column] = utAllocString(utSprintf("%%struct.runtime_columnInfo { %s, %s, "
+          "%%struct.runtime_array* %s, i64 ptrtoint (%s* getelementptr (%s, %s* null, i32 1) "
+          "to i64) }", name, typeName, llGetVariableName(arrayVar), type, type, type));
+      utFree(name);
+      column++;
+    }
+  } deEndBlockVariable;
+  fprintf(llAsmFile, "@.classColumns%u = internal constant [%u x %%struct.runtime_columnInfo] ",
+      classNum, numColumns);
+  char *separator = "[";
+  for (column = 0; column < numColumns; column++) {
+    fprintf(llAsmFile, "%s%s", separator, entries[column]);
+    separator = ", ";
+    utFree(entries[column]);
+  }
+  fputs(numColumns == 0? "zeroinitializer\n" : "]\n", llAsmFile);
+  utFree(entries);
+  return numColumns;
+}
+
+// Write the class table, describing each class's memory management globals and
+// columns, and @.startClassStats, which main calls to register it with the
+// runtime for runtime_classStats.
+static void writeClassTable(void) {
+  llDeclareRuntimeFunction("runtime_setClassTable");
+  uint32 numClasses = 0;
+  deClass theClass;
+  deForeachRootClass(deTheRoot, theClass) {
+    if (deClassBound(theClass) && classInstantiated(theClass)) {
+      numClasses++;
+    }
+  } deEndRootClass;
+  char **entries = utNewA(char *, numClasses);
+  uint32 classNum = 0;
+  deForeachRootClass(deTheRoot, theClass) {
+    if (!deClassBound(theClass) || !classInstantiated(theClass)) {
+      continue;
+    }
+    uint32 numColumns = writeClassColumns(theClass, classNum);
+    char *name = writeTableString(utSprintf("className%u", classNum),
+        deGetBlockPath(deClassGetSubBlock(theClass), false));
+    name = utAllocString(name);
+    uint32 refWidth = deClassGetRefWidth(theClass);
+    char *used = utAllocString(llGetVariableName(findClassGlobal(theClass, "used")));
+    char *allocated = utAllocString(llGetVariableName(findClassGlobal(theClass, "allocated")));
+    char *firstFree = llGetVariableName(findClassGlobal(theClass, "firstFree"));
+    entries[classNum] = utAllocString(utSprintf("%%struct.runtime_classInfo { %s, i32 %u, "
+        "i64 %u, %%struct.runtime_columnInfo* getelementptr inbounds ([%u x "
+        "%%struct.runtime_columnInfo], [%u x %%struct.runtime_columnInfo]* @.classColumns%u, "
+        "i32 0, i32 0), i8* bitcast (i%u* %s to i8*), i8* bitcast (i%u* %s to i8*), "
+        "i8* bitcast (i%u* %s to i8*) }", name, refWidth, numColumns, numColumns, numColumns,
+        classNum, refWidth, used, refWidth, allocated, refWidth, firstFree));
+    utFree(name);
+    utFree(used);
+    utFree(allocated);
+    classNum++;
+  } deEndRootClass;
+  fprintf(llAsmFile, "@.classTable = internal constant [%u x %%struct.runtime_classInfo] ",
+      numClasses);
+  char *separator = "[";
+  for (classNum = 0; classNum < numClasses; classNum++) {
+    fprintf(llAsmFile, "%s%s", separator, entries[classNum]);
+    separator = ", ";
+    utFree(entries[classNum]);
+  }
+  fputs(numClasses == 0? "zeroinitializer\n" : "]\n", llAsmFile);
+  utFree(entries);
+  fprintf(llAsmFile,
+      "define internal void @.startClassStats() {\n"
+      "  call void @runtime_setClassTable(%%struct.runtime_classInfo* getelementptr inbounds "
+      "([%u x %%struct.runtime_classInfo], [%u x %%struct.runtime_classInfo]* @.classTable, "
+      "i32 0, i32 0), i64 %u)\n"
+      "  ret void\n"
+      "}\n",
+      numClasses, numClasses, numClasses);
 }
 
 // Generate LLVM assembly code.
@@ -4143,6 +5905,10 @@ void llGenerateLLVMAssemblyCode(char* fileName, bool debugMode) {
   llNumLocalsNeedingFree = 0;
   llNeedsFreeAllocated = 32;
   llNeedsFree = utNewA(llElement, llNeedsFreeAllocated);
+  llRegionsAllocated = 4;
+  llRegions = utNewA(llRegion, llRegionsAllocated);
+  llReservingTclassesAllocated = 4;
+  llReservingTclasses = utNewA(deTclass, llReservingTclassesAllocated);
   llAsmFile = fopen(fileName, "w");
   if (llAsmFile == NULL) {
     deError(0, "Unable to write to %s", fileName);
@@ -4193,10 +5959,16 @@ void llGenerateLLVMAssemblyCode(char* fileName, bool debugMode) {
       }
     }
   } deEndRootSignature;
+  if (deFieldProfileGenFile != NULL) {
+    llWriteFieldProfile();
+  }
+  writeClassTable();
   llWriteDeclarations();
   flushStringBuffer();
   fclose(llAsmFile);
   llStop();
+  utFree(llReservingTclasses);
+  utFree(llRegions);
   utFree(llNeedsFree);
   utFree(llStack);
   utFree(llModuleName);
@@ -29,6 +29,9 @@ char *llGetTypeString(deDatatype datatype, bool isDefinition);
 void llDeclareRuntimeFunction(char *funcName);
 void llDeclareOverloadedFunction(char *text);
 void llAddStringConstant(deString string);
+uint32 llAddFieldSite(utSym sym);
+void llWriteFieldProfile(void);
+uint32 llAddConstModulus(deExpression modulus, deExpression constant, deReductionType reduction);
 utSym llAddArrayConstant(deExpression expression);
 void llDeclareBlockGlobals(deBlock block);
 void llDeclareExternCFunctions(void);
@@ -49,6 +52,7 @@ llTag llCreateLocationTag(llTag scopeTag, deLine line);
 char *llGetVariableName(deVariable variable);
 void llDeclareNewTuples(void);
 bool llDatatypeIsBigint(deDatatype datatype);
+bool llDatatypeIsWideInt(deDatatype datatype);
 bool llDatatypeIsArray(deDatatype datatype);
 uint32 llBigintBitsToWords(uint32 width, bool isSigned);
 bool llDatatypePassedByReference(deDatatype datatype);
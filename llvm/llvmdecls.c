@@ -20,15 +20,28 @@
 
 static uint32 llStringNum;
 static uint32 llArrayNum;
+static uint32 llFieldSiteNum;
+static uint32 llConstModulusNum;
 static uint32 llTupleNum;
 
-// Return true if the datatype is an int or uint > uint64 width.  These
+// Return true if the datatype is an int or uint > deMaxNativeIntWidth.  These
 // integers are represented as bigints.
 bool llDatatypeIsBigint(deDatatype datatype) {
   deDatatypeType type = deDatatypeGetType(datatype);
   if (type == DE_TYPE_UINT || type == DE_TYPE_INT || type == DE_TYPE_MODINT) {
     uint32 width = deDatatypeGetWidth(datatype);
-    return width > llSizeWidth;
+    return width > deMaxNativeIntWidth;
+  }
+  return false;
+}
+
+// Return true if the datatype is an int or uint wider than uint64, but still
+// represented as a native LLVM integer, such as i128 or i256.
+bool llDatatypeIsWideInt(deDatatype datatype) {
+  deDatatypeType type = deDatatypeGetType(datatype);
+  if (type == DE_TYPE_UINT || type == DE_TYPE_INT || type == DE_TYPE_MODINT) {
+    uint32 width = deDatatypeGetWidth(datatype);
+    return width > llSizeWidth && width <= deMaxNativeIntWidth;
   }
   return false;
 }
@@ -41,7 +54,7 @@ bool llDatatypeIsArray(deDatatype datatype) {
   }
   if (type == DE_TYPE_UINT || type == DE_TYPE_INT || type == DE_TYPE_MODINT) {
     uint32 width = deDatatypeGetWidth(datatype);
-    return width > llSizeWidth;
+    return width > deMaxNativeIntWidth;
   }
   return false;
 }
@@ -204,7 +217,7 @@ static char *getTypeString(deDatatype datatype, bool isDefinition) {
     case DE_TYPE_UINT:
     case DE_TYPE_INT: {
       uint32 width = deDatatypeGetWidth(datatype);
-      if (width <= llSizeWidth) {
+      if (width <= deMaxNativeIntWidth) {
         return utSprintf("i%u", width);
       } else {
         if (isDefinition) {
@@ -304,6 +317,10 @@ static void declareRuntimeFunctions(void) {
   createFuncDecl("runtime_appendArrayElement", utSprintf(
       "declare dso_local void @runtime_appendArrayElement(%%struct.runtime_array*, i8*, i%s, i1 zeroext, i1 zeroext)",
       llSize));
+  createFuncDecl("runtime_startFieldProfile",
+      "declare dso_local void @runtime_startFieldProfile(i8*, i8*, i64**, i64)");
+  createFuncDecl("runtime_setClassTable",
+      "declare dso_local void @runtime_setClassTable(%struct.runtime_classInfo*, i64)");
   createFuncDecl("runtime_arrayStart", utSprintf("declare dso_local void @runtime_arrayStart()"));
   createFuncDecl("runtime_arrayStop", "declare dso_local void @runtime_arrayStop()");
   createFuncDecl("runtime_compactArrayHeap", "declare dso_local void @runtime_compactArrayHeap()");
@@ -316,12 +333,25 @@ static void declareRuntimeFunctions(void) {
       "i%s, i%s, i%s, i1 zeroext)", llSize, llSize, llSize));
   createFuncDecl("runtime_reverseArray", utSprintf(
       "declare dso_local void @runtime_reverseArray(%%struct.runtime_array*, i%s, i1 zeroext)", llSize));
+  createFuncDecl("runtime_secretLookup", utSprintf(
+      "declare dso_local i64 @runtime_secretLookup(%%struct.runtime_array*, i64, i%s)", llSize));
   createFuncDecl("runtime_nativeIntToString", utSprintf(
       "declare dso_local void @runtime_nativeIntToString(%%struct.runtime_array*, i%s, i32, i1 zeroext)",
       llSize));
   createFuncDecl("runtime_panic", "declare dso_local void @runtime_panic(%struct.runtime_array*, ...) noreturn");
   createFuncDecl("runtime_putsCstr", "declare dso_local void @runtime_putsCstr(i8*)");
   createFuncDecl("runtime_puts", "declare dso_local void @runtime_puts(%struct.runtime_array*)");
+  createFuncDecl("runtime_resizeColumns", utSprintf(
+      "declare dso_local void @runtime_resizeColumns(%%struct.runtime_array**, i%s*, i8*, i%s, i%s)",
+      llSize, llSize, llSize));
+  createFuncDecl("runtime_compactColumns", utSprintf(
+      "declare dso_local i%s @runtime_compactColumns(%%struct.runtime_array**, i%s*, i8*, i%s, "
+      "i%s, i%s, i32, %%struct.runtime_array*)", llSize, llSize, llSize, llSize, llSize));
+  createFuncDecl("runtime_remapReferences", utSprintf(
+      "declare dso_local void @runtime_remapReferences(%%struct.runtime_array*, i%s*, i32, i%s, "
+      "i32, i%s, %%struct.runtime_array*)", llSize, llSize, llSize));
+  createFuncDecl("runtime_remapReference",
+      "declare dso_local i64 @runtime_remapReference(i64, i32, %struct.runtime_array*)");
   createFuncDecl("runtime_resizeArray", utSprintf(
       "declare dso_local void @runtime_resizeArray(%%struct.runtime_array*, i%s, i%s, i1 zeroext)",
       llSize, llSize));
@@ -329,6 +359,19 @@ static void declareRuntimeFunctions(void) {
       "declare dso_local void @runtime_stringToHex(%struct.runtime_array*, %struct.runtime_array*)");
   createFuncDecl("runtime_hexToString",
       "declare dso_local void @runtime_hexToString(%struct.runtime_array*, %struct.runtime_array*)");
+  createFuncDecl("runtime_sha256",
+      "declare dso_local void @runtime_sha256(%struct.runtime_array*, %struct.runtime_array*)");
+  createFuncDecl("runtime_hmacSha256",
+      "declare dso_local void @runtime_hmacSha256(%struct.runtime_array*, %struct.runtime_array*, "
+      "%struct.runtime_array*)");
+  createFuncDecl("runtime_sha3",
+      "declare dso_local void @runtime_sha3(%struct.runtime_array*, %struct.runtime_array*)");
+  createFuncDecl("runtime_hashBytes",
+      "declare dso_local i64 @runtime_hashBytes(i8*, i64)");
+  createFuncDecl("runtime_hashString",
+      "declare dso_local i64 @runtime_hashString(%struct.runtime_array*)");
+  createFuncDecl("runtime_hashBigint",
+      "declare dso_local i64 @runtime_hashBigint(%struct.runtime_array*)");
   createFuncDecl("runtime_stringFind", utSprintf(
       "declare dso_local i%s @runtime_stringFind(%%struct.runtime_array*, %%struct.runtime_array*, i%s)", llSize, llSize));
   createFuncDecl("runtime_stringRfind", utSprintf(
@@ -364,6 +407,20 @@ static void declareRuntimeFunctions(void) {
   createFuncDecl("runtime_integerToBigint", utSprintf(
       "declare dso_local void @runtime_integerToBigint(%%struct.runtime_array*, "
       "i%s, i32, i1, i1)", llSize));
+  createFuncDecl("runtime_wideIntegerToBigint",
+      "declare void @runtime_wideIntegerToBigint(%struct.runtime_array*, i64*, "
+      "i32 zeroext, i1 zeroext, i1 zeroext)");
+  createFuncDecl("runtime_bigintToWideInteger",
+      "declare void @runtime_bigintToWideInteger(i64*, %struct.runtime_array*, "
+      "i32 zeroext, i1 zeroext, i1 zeroext)");
+  createFuncDecl("runtime_wideIntArrayToBigints",
+      "declare void @runtime_wideIntArrayToBigints(%struct.runtime_array*, "
+      "%struct.runtime_array*, i32 zeroext, i1 zeroext)");
+  createFuncDecl("runtime_bigintsToWideIntArray",
+      "declare void @runtime_bigintsToWideIntArray(%struct.runtime_array*, "
+      "%struct.runtime_array*, i32 zeroext)");
+  createFuncDecl("runtime_setMaxWideIntWidth",
+      "declare void @runtime_setMaxWideIntWidth(i32 zeroext)");
   createFuncDecl("runtime_bigintToInteger", utSprintf(
       "declare i%s @runtime_bigintToInteger(%%struct.runtime_array*)", llSize));
   createFuncDecl("runtime_bigintToIntegerTrunc", utSprintf(
@@ -438,6 +495,30 @@ static void declareRuntimeFunctions(void) {
       "%struct.runtime_array*, %struct.runtime_array*);");
   createFuncDecl("runtime_bigintModularNegate", "declare void @runtime_bigintModularNegate("
       "%struct.runtime_array*, %struct.runtime_array*, %struct.runtime_array*)");
+  createFuncDecl("runtime_bigintBatchModularMul",
+      "declare void @runtime_bigintBatchModularMul(%struct.runtime_array*, %struct.runtime_array*, "
+      "%struct.runtime_array*, %struct.runtime_array*)");
+  createFuncDecl("runtime_bigintBatchModularExp",
+      "declare void @runtime_bigintBatchModularExp(%struct.runtime_array*, %struct.runtime_array*, "
+      "%struct.runtime_array*, %struct.runtime_array*)");
+  createFuncDecl("runtime_bigintFixedBaseTable",
+      "declare void @runtime_bigintFixedBaseTable(%struct.runtime_array*, %struct.runtime_array*, "
+      "%struct.runtime_array*)");
+  createFuncDecl("runtime_bigintFixedBaseExp",
+      "declare void @runtime_bigintFixedBaseExp(%struct.runtime_array*, %struct.runtime_array*, "
+      "%struct.runtime_array*)");
+  createFuncDecl("runtime_bigintConstModularMul",
+      "declare void @runtime_bigintConstModularMul(%struct.runtime_array*, %struct.runtime_array*, "
+      "%struct.runtime_array*, %struct.runtime_constModulus*)");
+  createFuncDecl("runtime_bigintConstModularExp",
+      "declare void @runtime_bigintConstModularExp(%struct.runtime_array*, %struct.runtime_array*, "
+      "%struct.runtime_array*, %struct.runtime_constModulus*)");
+  createFuncDecl("runtime_wideIntConstModularMul",
+      "declare void @runtime_wideIntConstModularMul(i64*, i64*, i64*, "
+      "%struct.runtime_constModulus*)");
+  createFuncDecl("runtime_wideIntConstModularExp",
+      "declare void @runtime_wideIntConstModularExp(i64*, i64*, i64*, i32 zeroext, "
+      "%struct.runtime_constModulus*)");
   createFuncDecl("runtime_smallnumMul", utSprintf(
       "declare i%s @runtime_smallnumMul(i%s, i%s, i1 zeroext, i1 zeroext)", llSize, llSize, llSize));
   createFuncDecl("runtime_smallnumDiv", utSprintf(
@@ -483,6 +564,8 @@ void llStart(void) {
   llDatabaseStart();
   llStringNum = 1;
   llArrayNum = 1;
+  llFieldSiteNum = 0;
+  llConstModulusNum = 0;
   llTupleNum = 1;
   declareRuntimeFunctions();
   if (llDebugMode) {
@@ -545,6 +628,114 @@ void llAddStringConstant(deString string) {
   writeString(string);
 }
 
+// Return the number of the field site's counter, @.fieldCount<num>, adding the
+// site if it is new.
+uint32 llAddFieldSite(utSym sym) {
+  llFieldSite site = llRootFindFieldSite(deTheRoot, sym);
+  if (site == llFieldSiteNull) {
+    site = llFieldSiteAlloc();
+    llFieldSiteSetSym(site, sym);
+    llFieldSiteSetNum(site, llFieldSiteNum);
+    llFieldSiteNum++;
+    llRootAppendFieldSite(deTheRoot, site);
+  }
+  return llFieldSiteGetNum(site);
+}
+
+// Return the width of the 64-bit words holding an integer constant.
+static uint32 findWordsWidth(deExpression expression) {
+  return (deDatatypeGetWidth(deExpressionGetDatatype(expression)) + 63) & ~63;
+}
+
+// Write an integer constant as 64-bit words, for the runtime to read.
+static void writeWordsConstant(char *name, deExpression expression) {
+  fprintf(llAsmFile, "@.%s = private unnamed_addr constant i%u %s, align 8\n", name,
+      findWordsWidth(expression), deBigintToString(deExpressionGetBigint(expression), 10));
+}
+
+// Return the number of the constant modulus's global, @.constModulus<num>,
+// adding it if it is new.  The runtime builds the reduction context from the
+// modulus and the reduction constant on first use.
+uint32 llAddConstModulus(deExpression modulus, deExpression constant, deReductionType reduction) {
+  uint32 width = deDatatypeGetWidth(deExpressionGetDatatype(modulus));
+  utSym sym = utSymCreateFormatted("%u:%s", width,
+      deBigintToString(deExpressionGetBigint(modulus), 16));
+  llConstModulus constModulus = llRootFindConstModulus(deTheRoot, sym);
+  if (constModulus != llConstModulusNull) {
+    return llConstModulusGetNum(constModulus);
+  }
+  uint32 num = llConstModulusNum;
+  llConstModulusNum++;
+  constModulus = llConstModulusAlloc();
+  llConstModulusSetSym(constModulus, sym);
+  llConstModulusSetNum(constModulus, num);
+  llRootAppendConstModulus(deTheRoot, constModulus);
+  char *modulusName = utSprintf("constModulus%u.modulus", num);
+  writeWordsConstant(modulusName, modulus);
+  char *constantName = utSprintf("constModulus%u.constant", num);
+  writeWordsConstant(constantName, constant);
+  uint32 modulusWidth = findWordsWidth(modulus);
+  uint32 constantWidth = findWordsWidth(constant);
+  fprintf(llAsmFile,
+      "@.constModulus%u = internal global %%struct.runtime_constModulus {i8* null, "
+      "i64* bitcast (i%u* @.constModulus%u.modulus to i64*), "
+      "i64* bitcast (i%u* @.constModulus%u.constant to i64*), i32 %u, i32 %u, i32 %u}\n",
+      num, modulusWidth, num, constantWidth, num, width,
+      deDatatypeGetWidth(deExpressionGetDatatype(constant)), reduction);
+  return num;
+}
+
+// Write a C string constant named @.<name>.
+static void writeCString(char *name, char *text) {
+  uint32 len = strlen(text) + 1;
+  fprintf(llAsmFile, "@.%s = private unnamed_addr constant [%u x i8] c\"%s\\00\"\n",
+      name, len, llEscapeText(text));
+}
+
+// Write the field site counters, and @.startFieldProfile, which main calls to
+// register them with the runtime.  Each site's line in the profile is its name.
+void llWriteFieldProfile(void) {
+  llDeclareRuntimeFunction("runtime_startFieldProfile");
+  uint32 len = 0;
+  llFieldSite site;
+  llForeachRootFieldSite(deTheRoot, site) {
+    fprintf(llAsmFile, "@.fieldCount%u = internal global i64 0\n", llFieldSiteGetNum(site));
+    len += strlen(llFieldSiteGetName(site)) + 1;
+  } llEndRootFieldSite;
+  char *sites = utNewA(char, len + 1);
+  char *p = sites;
+  llForeachRootFieldSite(deTheRoot, site) {
+    p += sprintf(p, "%s\n", llFieldSiteGetName(site));
+  } llEndRootFieldSite;
+  *p = '\0';
+  fprintf(llAsmFile, "@.fieldCounters = internal constant [%u x i64*] ", llFieldSiteNum);
+  if (llFieldSiteNum == 0) {
+    fputs("zeroinitializer\n", llAsmFile);
+  } else {
+    char *separator = "[";
+    llForeachRootFieldSite(deTheRoot, site) {
+      fprintf(llAsmFile, "%si64* @.fieldCount%u", separator, llFieldSiteGetNum(site));
+      separator = ", ";
+    } llEndRootFieldSite;
+    fputs("]\n", llAsmFile);
+  }
+  writeCString("fieldSites", sites);
+  writeCString("fieldProfileName", deFieldProfileGenFile);
+  uint32 sitesLen = len + 1;
+  uint32 nameLen = strlen(deFieldProfileGenFile) + 1;
+  fprintf(llAsmFile,
+      "define internal void @.startFieldProfile() {\n"
+      "  call void @runtime_startFieldProfile("
+      "i8* getelementptr inbounds ([%u x i8], [%u x i8]* @.fieldProfileName, i32 0, i32 0), "
+      "i8* getelementptr inbounds ([%u x i8], [%u x i8]* @.fieldSites, i32 0, i32 0), "
+      "i64** getelementptr inbounds ([%u x i64*], [%u x i64*]* @.fieldCounters, i32 0, i32 0), "
+      "i64 %u)\n"
+      "  ret void\n"
+      "}\n",
+      nameLen, nameLen, sitesLen, sitesLen, llFieldSiteNum, llFieldSiteNum, llFieldSiteNum);
+  utFree(sites);
+}
+
 // Write a constant bigint array, in CTTK format.
 static void writeBigintArray(llArray array) {
   deExpression expression = llArrayGetExpression(array);
@@ -213,6 +213,7 @@ static void moveImportsToBlock(deFunction function, deBlock destBlock) {
 %token <lineVal> KWCASE
 %token <lineVal> KWCASTTRUNC
 %token <lineVal> KWCLASS
+%token <lineVal> KWCOLOCATE
 %token <lineVal> KWCONST
 %token <lineVal> KWDEBUG
 %token <lineVal> KWDEFAULT
@@ -339,6 +340,7 @@ statement: appendCode
 | assignmentStatement
 | callStatement
 | class
+| colocateStatement
 | debugStatement
 | enum
 | externFunction
@@ -450,6 +452,21 @@ exportClassHeader: KWEXPORT KWCLASS IDENT optWidth  // Means the constructor is
 }
 ;
 
+colocateStatement: KWCOLOCATE oneOrMoreExpressions newlines
+{
+  if (deBlockGetType(deCurrentBlock) != DE_BLOCK_FUNCTION) {
+    deError($1, "colocate statements only allowed at the top level of a class");
+  }
+  deFunction constructor = deBlockGetOwningFunction(deCurrentBlock);
+  if (deFunctionGetType(constructor) != DE_FUNC_CONSTRUCTOR) {
+    deError($1, "colocate statements only allowed at the top level of a class");
+  }
+  deFieldGroup group = deFieldGroupCreate($1);
+  deFieldGroupInsertExpression(group, $2);
+  deTclassAppendFieldGroup(deFunctionGetTclass(constructor), group);
+}
+;
+
 struct: structHeader '{' newlines structMembers '}' newlines
 {
   deCurrentBlock = deBlockGetOwningBlock(deCurrentBlock);
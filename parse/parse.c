@@ -22,9 +22,12 @@
 deRoot deTheRoot;
 uint32 deDumpIndentLevel;
 bool deUnsafeMode;
+uint32 deMaxNativeIntWidth = DE_DEFAULT_MAX_NATIVE_INT_WIDTH;
 bool deDebugMode;
 bool deInvertReturnCode;
 char *deLLVMFileName;
+char *deFieldProfileGenFile;
+char *deFieldProfileUseFile;
 bool deTestMode;
 char *deExeName;
 char *deLibDir;
@@ -17,7 +17,10 @@
 numPassed="0"
 numFailed="0"
 
-rm -f tests/*.result tests/*.ll
+# Fix the hash seed so hash table iteration order is repeatable.
+export RUNE_HASH_SEED=0
+
+rm -f tests/*.result tests/*.ll cttests/*.ll
 
 for outFile in tests/*.stdout crypto_class/*.stdout; do
   test=$(echo "$outFile" | sed 's/stdout$/rn/')
@@ -37,6 +40,39 @@ for outFile in tests/*.stdout crypto_class/*.stdout; do
   fi
 done
 
+# These tests also run with -U, which changes how objects are stored.
+for test in tests/overlayfreelist.rn; do
+  outFile=$(echo "$test" | sed 's/rn$/stdout/')
+  resFile=$(echo "$test" | sed 's/rn$/unsafe.result/')
+  exeFile=$(echo "$test" | sed 's/\.rn$//')
+  ./rune -U -g "$test" && ./"$exeFile" > "$resFile"
+  if cmp -s "$outFile" "$resFile"; then
+    echo "$test passed with -U"
+    numPassed=$((numPassed + 1))
+  else
+    echo "$test failed with -U *****************************************"
+    numFailed=$((numFailed + 1))
+  fi
+done
+
+# Build with -profgen and run, then rebuild with -profuse, which must report
+# the member that is only stored, and not the one updated with +=.
+for test in tests/fieldprofile.rn; do
+  profFile=$(echo "$test" | sed 's/rn$/prof/')
+  exeFile=$(echo "$test" | sed 's/\.rn$//')
+  rm -f "$profFile"
+  result=$(./rune -profgen "$profFile" -g "$test" && ./"$exeFile" > /dev/null &&
+      ./rune -profuse "$profFile" -g "$test")
+  if echo "$result" | grep -q "Data member Counter.label is never read" &&
+      ! echo "$result" | grep -q "Data member Counter.count"; then
+    echo "$test passed with -profuse"
+    numPassed=$((numPassed + 1))
+  else
+    echo "$test failed with -profuse *****************************************"
+    numFailed=$((numFailed + 1))
+  fi
+done
+
 for test in errortests/*.rn; do
   result=$(./runl "$test" | egrep "(Exiting due to error|Exception)")
   if [[ "$result" != "" ]]; then
@@ -48,5 +84,21 @@ for test in errortests/*.rn; do
   fi
 done
 
+# Functions named ct* in these tests are passed secrets.  After LLVM optimizes
+# them, they must not branch or select on them.
+for test in cttests/*.rn; do
+  llvmFile=$(echo "$test" | sed 's/\.rn$/.ll/')
+  # Keep the functions out of main, so each is checked on its own.
+  result=$(./rune -n "$test" && opt-14 -O3 -inline-threshold=-10000 -S "$llvmFile" |
+      awk '/^define .*@[^(]*ct[A-Z]/,/^}/')
+  if [[ "$result" != "" ]] && ! echo "$result" | egrep -q "( select | br i1 )"; then
+    echo "$test passed"
+    numPassed=$((numPassed + 1))
+  else
+    echo "*************************************** $test failed"
+    numFailed=$((numFailed + 1))
+  fi
+done
+
 echo "Passed: $numPassed"
 echo "Failed: $numFailed"
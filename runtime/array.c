@@ -18,7 +18,11 @@
 #include <stdio.h>
 #include <sys/types.h>
 #include <stdlib.h>  // For calloc, realloc, and free.
+#include <string.h>
 #include <sys/sysinfo.h>  // To find total RAM available.
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 // These are verified with static_assert in runtime_arrayStart.
 #ifdef RN_DEBUG
@@ -29,6 +33,9 @@ static size_t runtime_arrayCounter = 0;
 #define RN_HEADER_WORDS 2u
 #endif
 #define RN_ARRAY_WORDS 2u
+// A stripe of a shared column allocation is preceded by a pointer to the start
+// of the allocation, and then a normal heap header.
+#define RN_STRIPE_WORDS (RN_HEADER_WORDS + 1u)
 
 static size_t runtime_totalRam;
 
@@ -202,8 +209,15 @@ static void resetArray(runtime_array *array) {
       childArray++;
     }
   }
-  runtime_zeroMemory((size_t*)header, RN_HEADER_WORDS + header->allocatedWords);
-  free(header);
+  if (header->isStripe) {
+    // The memory belongs to the shared allocation, which is freed when the
+    // columns are next resized.
+    runtime_zeroMemory(array->data, header->allocatedWords);
+    header->backPointer = NULL;
+  } else {
+    runtime_zeroMemory((size_t*)header, RN_HEADER_WORDS + header->allocatedWords);
+    free(header);
+  }
   array->data = NULL;
   array->numElements = 0;
 }
@@ -324,6 +338,40 @@ void runtime_arrayStart(void) {
 void runtime_arrayStop(void) {
 }
 
+// Free the sub-arrays of elements |start| and up.
+static void resetSubArrays(runtime_array *array, size_t start) {
+  runtime_array *p = (runtime_array*)array->data + start;
+  for (size_t i = start; i < array->numElements; i++) {
+    resetArray(p);
+    p++;
+  }
+}
+
+// Return the shared allocation holding the stripe.
+static inline size_t *getStripeBlock(const runtime_array *array) {
+  return (size_t*)array->data[-(ptrdiff_t)RN_STRIPE_WORDS];
+}
+
+// Resize a stripe of a shared column allocation.  Stripes cannot be resized
+// in place, so move it to an allocation of its own.
+static void detachStripe(runtime_array *array, size_t numElements, size_t elementSize,
+    bool hasSubArrays) {
+  size_t keptElements = numElements < array->numElements? numElements : array->numElements;
+  if (hasSubArrays) {
+    resetSubArrays(array, keptElements);
+  }
+  size_t numWords = runtime_bytesToWords(runtime_multCheckForOverflow(numElements, elementSize));
+  size_t *data = allocArrayBuffer(numWords, hasSubArrays);
+  runtime_memcopy(data, array->data, keptElements * elementSize);
+  runtime_zeroMemory(array->data, runtime_getArrayHeader(array)->allocatedWords);
+  array->data = data;
+  array->numElements = numElements;
+  updateArrayBackPointer(array);
+  if (hasSubArrays) {
+    updateSubArrayBackPointers(array);
+  }
+}
+
 // Resize the array.
 static void arrayResize(runtime_array *array, size_t numElements, size_t elementSize,
     bool hasSubArrays, bool allocateExtra) {
@@ -336,6 +384,12 @@ static void arrayResize(runtime_array *array, size_t numElements, size_t element
     return runtime_allocArray(array, numElements, elementSize, hasSubArrays);
   }
   runtime_heapHeader *header = runtime_getArrayHeader(array);
+  if (header->isStripe) {
+    if (numElements != oldNumElements) {
+      detachStripe(array, numElements, elementSize, hasSubArrays);
+    }
+    return;
+  }
   size_t allocatedBytes = runtime_multCheckForOverflow(numElements, elementSize);
   if (allocatedBytes > runtime_totalRam) {
     runtime_throwExceptionCstr("Out of memory");
@@ -381,6 +435,210 @@ void runtime_resizeArray(runtime_array *array, size_t numElements, size_t elemen
   arrayResize(array, numElements, elementSize, hasSubArrays, false);
 }
 
+// Resize the data member arrays of a class, which we call columns, together.
+// Rather than reallocating each column, move all of them to stripes of one new
+// allocation, so a class with many data members grows with one calloc and one
+// free.  Each column is still a normal array, so element access is unchanged.
+// The new allocation starts with its size in words, so it can be zeroed when
+// it is freed.
+void runtime_resizeColumns(runtime_array **columns, const size_t *elementSizes,
+    const uint8_t *hasSubArrays, size_t numColumns, uint64_t numElements) {
+  bool sameSize = true;
+  for (size_t i = 0; i < numColumns; i++) {
+    sameSize &= columns[i]->numElements == numElements;
+  }
+  if (sameSize) {
+    return;
+  }
+  size_t *oldBlock = NULL;
+  if (numElements == 0) {
+    for (size_t i = 0; i < numColumns; i++) {
+      runtime_array *array = columns[i];
+      if (array->data != NULL && runtime_getArrayHeader(array)->isStripe) {
+        oldBlock = getStripeBlock(array);
+      }
+      resetArray(array);
+    }
+  } else {
+    size_t totalWords = 1;
+    for (size_t i = 0; i < numColumns; i++) {
+      size_t numBytes = runtime_multCheckForOverflow(numElements, elementSizes[i]);
+      totalWords += RN_STRIPE_WORDS + runtime_bytesToWords(numBytes);
+      if (isOutOfRange(totalWords)) {
+        runtime_throwExceptionCstr("Out of memory");
+      }
+    }
+    size_t *block = (size_t*)calloc(totalWords, sizeof(size_t));
+    block[0] = totalWords;
+    size_t *stripe = block + 1;
+    for (size_t i = 0; i < numColumns; i++) {
+      runtime_array *array = columns[i];
+      size_t elementSize = elementSizes[i];
+      size_t numWords = runtime_bytesToWords(numElements * elementSize);
+      stripe[0] = (size_t)block;
+      runtime_heapHeader *header = (runtime_heapHeader*)(stripe + 1);
+      header->hasSubArrays = hasSubArrays[i];
+      header->isStripe = true;
+      header->allocatedWords = numWords;
+      size_t *data = stripe + RN_STRIPE_WORDS;
+      if (array->data != NULL) {
+        size_t keptElements = numElements < array->numElements? numElements : array->numElements;
+        if (hasSubArrays[i]) {
+          resetSubArrays(array, keptElements);
+        }
+        runtime_memcopy(data, array->data, keptElements * elementSize);
+        runtime_heapHeader *oldHeader = runtime_getArrayHeader(array);
+        if (oldHeader->isStripe) {
+          oldBlock = getStripeBlock(array);
+        } else {
+          runtime_zeroMemory((size_t*)oldHeader, RN_HEADER_WORDS + oldHeader->allocatedWords);
+          free(oldHeader);
+        }
+      }
+      array->data = data;
+      array->numElements = numElements;
+      updateArrayBackPointer(array);
+      if (hasSubArrays[i]) {
+        updateSubArrayBackPointers(array);
+      }
+      stripe = data + numWords;
+    }
+  }
+  if (oldBlock != NULL) {
+    runtime_zeroMemory(oldBlock, oldBlock[0]);
+    free(oldBlock);
+  }
+}
+
+// Return the all-ones null reference of a class with |refWidth| bit references.
+static inline uint64_t nullReference(uint32_t refWidth) {
+  return refWidth < 64? ((uint64_t)1 << refWidth) - 1 : UINT64_MAX;
+}
+
+// Read a little-endian reference of |refSize| bytes.
+static inline uint64_t readReference(const uint8_t *p, size_t refSize, uint64_t nullRef) {
+  uint64_t ref = 0;
+  runtime_memcopy(&ref, p, refSize);
+  return ref & nullRef;
+}
+
+// Renumber the live objects of a class densely, moving the elements of each
+// column down over the holes left by destroyed objects.  Column 0 must be the
+// class's nextFree array, which links the free objects into a list starting at
+// |firstFree|.  On return, |newIds| maps each old object index to its new
+// index, or to the null reference for free objects.  Return the number of live
+// objects.
+uint64_t runtime_compactColumns(runtime_array **columns, const size_t *elementSizes,
+    const uint8_t *hasSubArrays, size_t numColumns, uint64_t used, uint64_t firstFree,
+    uint32_t refWidth, runtime_array *newIds) {
+  uint64_t nullRef = nullReference(refWidth);
+  runtime_resizeArray(newIds, used, sizeof(uint64_t), false);
+  uint64_t *ids = (uint64_t*)newIds->data;
+  const uint8_t *nextFree = (const uint8_t*)columns[0]->data;
+  size_t refSize = elementSizes[0];
+  uint64_t object = firstFree & nullRef;
+  while (object < used) {
+    ids[object] = nullRef;
+    object = readReference(nextFree + object * refSize, refSize, nullRef);
+  }
+  uint64_t numLive = 0;
+  for (object = 0; object < used; object++) {
+    if (ids[object] != nullRef) {
+      ids[object] = numLive++;
+    }
+  }
+  for (size_t i = 0; i < numColumns; i++) {
+    runtime_array *array = columns[i];
+    size_t elementSize = elementSizes[i];
+    uint8_t *data = (uint8_t*)array->data;
+    for (object = 0; object < used; object++) {
+      uint64_t newId = ids[object];
+      if (newId != nullRef && newId != object) {
+        runtime_memcopy(data + newId * elementSize, data + object * elementSize, elementSize);
+      }
+    }
+    // Free objects were reset by their destructor, and live ones past the end
+    // have been moved, so nothing here owns memory.
+    memset(data + numLive * elementSize, 0, (used - numLive) * elementSize);
+    if (hasSubArrays[i]) {
+      updateSubArrayBackPointers(array);
+    }
+  }
+  return numLive;
+}
+
+// Count the objects on a class's free list, starting at |firstFree| and linked
+// through |nextFree|, the class's column 0.  Only the first |used| objects can
+// be on the list.
+uint64_t runtime_countFreeObjects(const runtime_array *nextFree, size_t refSize,
+    uint32_t refWidth, uint64_t used, uint64_t firstFree) {
+  uint64_t nullRef = nullReference(refWidth);
+  const uint8_t *data = (const uint8_t*)nextFree->data;
+  uint64_t numFree = 0;
+  uint64_t object = firstFree & nullRef;
+  while (object < used && object < nextFree->numElements && numFree < used) {
+    numFree++;
+    object = readReference(data + object * refSize, refSize, nullRef);
+  }
+  return numFree;
+}
+
+// Return the bytes of heap the array's data uses, including its header, and
+// those used by any sub-arrays.  A stripe counts its share of the column
+// allocation.
+uint64_t runtime_arrayHeapBytes(const runtime_array *array) {
+  if (array->numElements == 0) {
+    return 0;
+  }
+  runtime_heapHeader *header = runtime_getArrayHeader(array);
+  size_t headerWords = header->isStripe? RN_STRIPE_WORDS : RN_HEADER_WORDS;
+  uint64_t bytes = (uint64_t)(header->allocatedWords + headerWords) * sizeof(size_t);
+  if (header->hasSubArrays) {
+    const runtime_array *subArray = (const runtime_array*)array->data;
+    for (size_t i = 0; i < array->numElements; i++) {
+      bytes += runtime_arrayHeapBytes(subArray + i);
+    }
+  }
+  return bytes;
+}
+
+// Rewrite references to a compacted class in the first |numElements| elements
+// of |array|, using the |newIds| map from runtime_compactColumns.  |path| holds
+// |depth| pairs of element size and offset, one per level of array nesting.
+// At each level but the last, the field at the offset of each element is an
+// array, rewritten in full at the next level.  At the last level, it is a
+// reference of |refSize| bytes.  This reaches references inside tuples,
+// arrays of references, and arrays of tuples holding references.
+void runtime_remapReferences(runtime_array *array, const size_t *path, uint32_t depth,
+    size_t refSize, uint32_t refWidth, uint64_t numElements, const runtime_array *newIds) {
+  if (numElements > array->numElements) {
+    numElements = array->numElements;
+  }
+  size_t elementSize = path[0];
+  uint8_t *p = (uint8_t*)array->data + path[1];
+  for (uint64_t i = 0; i < numElements; i++) {
+    if (depth > 1) {
+      runtime_array *subArray = (runtime_array*)p;
+      runtime_remapReferences(subArray, path + 2, depth - 1, refSize, refWidth,
+          subArray->numElements, newIds);
+    } else {
+      uint64_t newRef = runtime_remapReference(readReference(p, refSize,
+          nullReference(refWidth)), refWidth, newIds);
+      runtime_memcopy(p, &newRef, refSize);
+    }
+    p += elementSize;
+  }
+}
+
+// Return the new index of one reference to a compacted class.
+uint64_t runtime_remapReference(uint64_t ref, uint32_t refWidth, const runtime_array *newIds) {
+  if (ref >= newIds->numElements) {
+    return ref;  // Null, or not a live object.
+  }
+  uint64_t newRef = ((const uint64_t*)newIds->data)[ref];
+  return newRef & nullReference(refWidth);
+}
+
 // Make a copy of the array's data.  |dest| should be empty.  |source| cannot be empty.
 static void replicateArrayData(runtime_array *dest, runtime_array *source, size_t numBytes, bool hasSubArrays) {
   size_t numElements = source->numElements;
@@ -632,6 +890,38 @@ static void findSubArrayFirstDifferentElements(const runtime_array *a, const run
   }
 }
 
+// Compare two wide integers, represented as arrays of uint64_t, least
+// significant word first.  Return -1 if a < b, 0 if a == b, and 1 if a > b.
+static int32_t compareWideInts(const uint64_t *a, const uint64_t *b, size_t elementSize,
+    bool isSigned, bool secret) {
+  uint32_t width = elementSize * 8;
+  if (secret) {
+    runtime_array bigA = runtime_makeEmptyArray();
+    runtime_array bigB = runtime_makeEmptyArray();
+    runtime_wideIntegerToBigint(&bigA, a, width, isSigned, true);
+    runtime_wideIntegerToBigint(&bigB, b, width, isSigned, true);
+    int32_t result = 1;
+    if (runtime_compareBigints(RN_EQUAL, &bigA, &bigB)) {
+      result = 0;
+    } else if (runtime_compareBigints(RN_LT, &bigA, &bigB)) {
+      result = -1;
+    }
+    runtime_freeArray(&bigA);
+    runtime_freeArray(&bigB);
+    return result;
+  }
+  size_t i = elementSize / sizeof(uint64_t) - 1;
+  if (isSigned && a[i] != b[i]) {
+    return (int64_t)a[i] < (int64_t)b[i] ? -1 : 1;
+  }
+  do {
+    if (a[i] != b[i]) {
+      return a[i] < b[i] ? -1 : 1;
+    }
+  } while (i-- != 0);
+  return 0;
+}
+
 // Compare two basic types.  Return -1 if a < b, 0 if a == b, and 1 if a > b.
 static int32_t compareElements(runtime_type elementType, void *aPtr, void *bPtr,
     size_t elementSize, bool secret) {
@@ -644,6 +934,9 @@ static int32_t compareElements(runtime_type elementType, void *aPtr, void *bPtr,
     }
     return 1;
   }
+  if (elementType == RN_WIDE_UINT || elementType == RN_WIDE_INT) {
+    return compareWideInts(aPtr, bPtr, elementSize, elementType == RN_WIDE_INT, secret);
+  }
   size_t a = 0;
   size_t b = 0;
   switch (elementSize) {
@@ -763,3 +1056,79 @@ void runtime_xorStrings(runtime_array *dest, runtime_array *a, runtime_array *b)
     *destPtr++ = *aPtr++ ^ *bPtr++;
   }
 }
+
+// Return all ones if a == b, and 0 otherwise, without branching.
+static inline uint64_t equalMask(uint64_t a, uint64_t b) {
+  uint64_t x = a ^ b;
+  return ((x | -x) >> 63) - 1;
+}
+
+// Load an element of up to 8 bytes, zero-extended.
+static inline uint64_t loadElement(const uint8_t *p, size_t elementSize) {
+  uint64_t value = 0;
+  memcpy(&value, p, elementSize);
+  return value;
+}
+
+// OR together the masked elements from |start| on.
+static uint64_t secretLookupScalar(const uint8_t *data, size_t start, size_t numElements,
+    uint64_t index, size_t elementSize) {
+  uint64_t value = 0;
+  for (size_t i = start; i < numElements; i++) {
+    value |= loadElement(data + i*elementSize, elementSize) & equalMask(i, index);
+  }
+  return value;
+}
+
+#if defined(__SSE2__)
+// Scan 16 bytes at a time.  Each byte is compared against the lane of the
+// element it belongs to, so one byte compare works for every element size, and
+// the lane mask is ANDed with a mask for the block holding the index.
+static uint64_t secretLookupSse2(const uint8_t *data, size_t numElements, uint64_t index,
+    size_t elementSize) {
+  size_t lanes = 16/elementSize;
+  uint32_t laneShift = __builtin_ctz(lanes);
+  uint8_t laneIds[16];
+  for (uint32_t i = 0; i < 16; i++) {
+    laneIds[i] = i/elementSize;
+  }
+  __m128i laneIdVector = _mm_loadu_si128((const __m128i*)laneIds);
+  __m128i target = _mm_set1_epi8(index & (lanes - 1));
+  __m128i laneMask = _mm_cmpeq_epi8(laneIdVector, target);
+  __m128i acc = _mm_setzero_si128();
+  uint64_t indexBlock = index >> laneShift;
+  size_t numBlocks = numElements >> laneShift;
+  for (size_t block = 0; block < numBlocks; block++) {
+    __m128i blockMask = _mm_set1_epi64x(equalMask(block, indexBlock));
+    __m128i values = _mm_loadu_si128((const __m128i*)(data + 16*block));
+    acc = _mm_or_si128(acc, _mm_and_si128(values, _mm_and_si128(laneMask, blockMask)));
+  }
+  // Only one lane can be non-zero, so OR the lanes together.
+  uint8_t bytes[16];
+  _mm_storeu_si128((__m128i*)bytes, acc);
+  uint8_t folded[8] = {0};
+  for (uint32_t i = 0; i < 16; i++) {
+    folded[i % elementSize] |= bytes[i];
+  }
+  uint64_t value = loadElement(folded, elementSize);
+  return value | secretLookupScalar(data, numBlocks << laneShift, numElements, index,
+      elementSize);
+}
+#endif
+
+// Read array[index] without revealing the index through timing or the cache:
+// every element is read, and the one we want is selected with a mask.  The
+// element size must be 1, 2, 4, or 8 bytes.  Only whether the index is in
+// bounds is revealed, by throwing an exception.
+uint64_t runtime_secretLookup(const runtime_array *array, uint64_t index, size_t elementSize) {
+  size_t numElements = array->numElements;
+  if (index >= numElements) {
+    runtime_throwExceptionCstr("Index out of bounds");
+  }
+  const uint8_t *data = (const uint8_t*)array->data;
+#if defined(__SSE2__)
+  return secretLookupSse2(data, numElements, index, elementSize);
+#else
+  return secretLookupScalar(data, 0, numElements, index, elementSize);
+#endif
+}
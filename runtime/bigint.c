@@ -18,6 +18,8 @@
 // them after any operation that effects the heap.
 #include "runtime.h"
 #include "../../CTTK/cttk.h"
+#include <stdlib.h>
+#include <string.h>
 #include <sys/types.h>
 
 // TODO: disable this.
@@ -294,6 +296,139 @@ uint64_t runtime_bigintToIntegerTrunc(const runtime_array *source) {
   return result;
 }
 
+// Integers wider than 64 bits, up to this width, are native integers in the
+// generated code.  They are passed to the runtime as arrays of uint64_t,
+// least significant word first.
+uint32_t runtime_maxWideIntWidth = sizeof(uint64_t)*8;
+
+// Called from main to set the widest native integer generated by the compiler.
+void runtime_setMaxWideIntWidth(uint32_t width) {
+  runtime_maxWideIntWidth = width;
+}
+
+// Return the number of uint64_t words used to represent a wide integer.
+static inline uint32_t findWideIntNumWords(uint32_t width) {
+  return (width + 63) / 64;
+}
+
+// Return word |index| of the |width|-bit wide integer in |words|.  Bits past
+// |width| are garbage in memory written by LLVM, so replace them with |fill|,
+// which is 0 or all 1's.
+static inline uint64_t getWideIntWord(const uint64_t *words, uint32_t width, uint32_t index,
+    uint64_t fill) {
+  uint32_t numWords = findWideIntNumWords(width);
+  if (index >= numWords) {
+    return fill;
+  }
+  uint64_t word = words[index];
+  uint32_t topBits = width & 0x3f;
+  if (index == numWords - 1 && topBits != 0) {
+    uint64_t mask = ((uint64_t)1 << topBits) - 1;
+    word = (word & mask) | (fill & ~mask);
+  }
+  return word;
+}
+
+// Return the 31 bits starting at |pos| in the wide integer.
+static inline uint32_t getWideIntBits(const uint64_t *words, uint32_t width, uint32_t pos,
+    uint64_t fill) {
+  uint32_t index = pos >> 6;
+  uint32_t shift = pos & 0x3f;
+  uint64_t bits = getWideIntWord(words, width, index, fill) >> shift;
+  if (shift > 64 - 31) {
+    bits |= getWideIntWord(words, width, index + 1, fill) << (64 - shift);
+  }
+  return bits & 0x7fffffff;
+}
+
+// Initialize an array to hold the |width|-bit wide integer in |words| as a
+// bigint.
+void runtime_wideIntegerToBigint(runtime_array *dest, const uint64_t *words, uint32_t width,
+    bool isSigned, bool secret) {
+  initBigint(dest, width, isSigned, secret);
+  uint64_t fill = 0;
+  if (isSigned) {
+    fill = -((words[(width - 1) >> 6] >> ((width - 1) & 0x3f)) & 1);
+  }
+  uint32_t *data = getBigintData(dest);
+  uint32_t numLimbs = dest->numElements;
+  for (uint32_t i = 2; i < numLimbs; i++) {
+    data[i] = getWideIntBits(words, width, (i - 2)*31, fill);
+  }
+}
+
+// Write the bigint into |words| as a wide integer of |width| bits, sign-extended
+// to a multiple of 64 bits.  If the bigint does not fit, throw an exception,
+// unless truncate is true.
+void runtime_bigintToWideInteger(uint64_t *words, const runtime_array *source, uint32_t width,
+    bool isSigned, bool truncate) {
+  runtime_array temp = runtime_makeEmptyArray();
+  if (runtime_bigintWidth(source) != width || runtime_bigintSigned(source) != isSigned) {
+    runtime_bigintCast(&temp, (runtime_array*)source, width, isSigned,
+        runtime_bigintSecret(source), truncate);
+    source = &temp;
+  }
+  const uint32_t *data = getConstBigintData(source);
+  uint32_t numLimbs = source->numElements;
+  uint32_t numWords = findWideIntNumWords(width);
+  uint64_t fill = -(uint64_t)(data[numLimbs - 1] >> 30);
+  for (uint32_t i = 0; i < numWords; i++) {
+    words[i] = fill;
+  }
+  // Clear the bits we are about to fill in from the limbs.
+  uint32_t numBits = (numLimbs - 2)*31;
+  for (uint32_t i = 0; i < numWords && i*64 < numBits; i++) {
+    uint32_t remaining = numBits - i*64;
+    words[i] &= remaining >= 64? 0 : ~(uint64_t)0 << remaining;
+  }
+  for (uint32_t i = 2; i < numLimbs; i++) {
+    uint32_t pos = (i - 2)*31;
+    uint32_t index = pos >> 6;
+    uint32_t shift = pos & 0x3f;
+    uint64_t limb = data[i] & 0x7fffffff;
+    if (index < numWords) {
+      words[index] |= limb << shift;
+    }
+    if (shift > 64 - 31 && index + 1 < numWords) {
+      words[index + 1] |= limb >> (64 - shift);
+    }
+  }
+  runtime_freeArray(&temp);
+}
+
+// Convert an array of unsigned |width|-bit wide integers to an array of
+// bigints, so the bigint array functions can operate on it.
+void runtime_wideIntArrayToBigints(runtime_array *dest, const runtime_array *source,
+    uint32_t width, bool secret) {
+  uint32_t numWords = findWideIntNumWords(width);
+  uint64_t numValues = source->numElements;
+  uint64_t *words = calloc(numWords, sizeof(uint64_t));
+  runtime_freeArray(dest);
+  runtime_allocArray(dest, numValues, sizeof(runtime_array), true);
+  for (uint64_t i = 0; i < numValues; i++) {
+    // Copy the words first, since allocating the bigint may move the source.
+    memcpy(words, (const uint64_t*)source->data + i*numWords, numWords*sizeof(uint64_t));
+    runtime_wideIntegerToBigint((runtime_array*)dest->data + i, words, width, false, secret);
+  }
+  runtime_zeroMemory(words, numWords);
+  free(words);
+}
+
+// Convert an array of bigints to an array of unsigned |width|-bit wide integers.
+void runtime_bigintsToWideIntArray(runtime_array *dest, const runtime_array *source,
+    uint32_t width) {
+  uint32_t numWords = findWideIntNumWords(width);
+  uint64_t numValues = source->numElements;
+  uint64_t *words = calloc(numWords, sizeof(uint64_t));
+  runtime_resizeArray(dest, numValues, numWords*sizeof(uint64_t), false);
+  for (uint64_t i = 0; i < numValues; i++) {
+    runtime_bigintToWideInteger(words, (const runtime_array*)source->data + i, width, false, false);
+    memcpy((uint64_t*)dest->data + i*numWords, words, numWords*sizeof(uint64_t));
+  }
+  runtime_zeroMemory(words, numWords);
+  free(words);
+}
+
 // Convert a string (u8 array) to a bigint, little-endian.
 void runtime_bigintDecodeLittleEndian(runtime_array *dest, runtime_array *byteArray,
     uint32_t width, bool isSigned, bool secret) {
@@ -867,6 +1002,993 @@ void runtime_bigintModularExp(runtime_array *dest, runtime_array *base, runtime_
   runtime_freeArray(&t);
 }
 
+// Batched modular arithmetic.  Independent Montgomery multiplications with a
+// shared odd modulus are computed RN_MONT_LANES at a time.  Operands are stored
+// lane-interleaved: limb j of lane l is at group[j*RN_MONT_LANES + l], with one
+// 31-bit limb per uint64_t, so SIMD multiplies of the low 32 bits of each
+// 64-bit lane produce full products.  R = 2^(31*numLimbs), where numLimbs
+// leaves 2 spare bits above the modulus, so intermediate values in [0, 2m)
+// never need reducing until the end.  All kernels are constant time.
+#define RN_MONT_LANES 8u
+#define RN_LIMB_MASK 0x7fffffffu
+
+typedef void (*montMulFunc)(uint64_t *dest, const uint64_t *a, const uint64_t *b,
+    const uint64_t *modulus, uint64_t m0i, uint32_t numLimbs, uint64_t *t);
+
+// Copy the low numLimbs rows of the accumulator |t| to |dest|.  |dest| may
+// alias |a| or |b|, so this is done only after the product is complete.
+static inline void copyMontResult(uint64_t *dest, const uint64_t *t, uint32_t numLimbs) {
+  for (uint32_t i = 0; i < numLimbs*RN_MONT_LANES; i++) {
+    dest[i] = t[i];
+  }
+}
+
+// Compute dest = a*b/R mod modulus in each lane, using CIOS Montgomery
+// multiplication.  |t| is scratch space for (numLimbs + 1) rows of lanes.
+static void montMulScalar(uint64_t *dest, const uint64_t *a, const uint64_t *b,
+    const uint64_t *modulus, uint64_t m0i, uint32_t numLimbs, uint64_t *t) {
+  for (uint32_t i = 0; i < (numLimbs + 1)*RN_MONT_LANES; i++) {
+    t[i] = 0;
+  }
+  for (uint32_t i = 0; i < numLimbs; i++) {
+    for (uint32_t l = 0; l < RN_MONT_LANES; l++) {
+      uint64_t ai = a[i*RN_MONT_LANES + l];
+      uint64_t u = (((t[l] + ai*b[l]) & RN_LIMB_MASK)*m0i) & RN_LIMB_MASK;
+      uint64_t carry = 0;
+      for (uint32_t j = 0; j < numLimbs; j++) {
+        uint64_t z = t[j*RN_MONT_LANES + l] + ai*b[j*RN_MONT_LANES + l] + u*modulus[j] + carry;
+        if (j != 0) {
+          t[(j - 1)*RN_MONT_LANES + l] = z & RN_LIMB_MASK;
+        }
+        carry = z >> 31;
+      }
+      uint64_t z = t[numLimbs*RN_MONT_LANES + l] + carry;
+      t[(numLimbs - 1)*RN_MONT_LANES + l] = z & RN_LIMB_MASK;
+      t[numLimbs*RN_MONT_LANES + l] = z >> 31;
+    }
+  }
+  copyMontResult(dest, t, numLimbs);
+}
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define RN_X86_SIMD
+#include <immintrin.h>
+
+// The AVX2 version of montMulScalar, computing 4 lanes per vector.
+__attribute__((target("avx2")))
+static void montMulAvx2(uint64_t *dest, const uint64_t *a, const uint64_t *b,
+    const uint64_t *modulus, uint64_t m0i, uint32_t numLimbs, uint64_t *t) {
+  const __m256i mask = _mm256_set1_epi64x(RN_LIMB_MASK);
+  const __m256i m0iVec = _mm256_set1_epi64x(m0i);
+  const __m256i zero = _mm256_setzero_si256();
+  for (uint32_t h = 0; h < RN_MONT_LANES; h += 4) {
+    for (uint32_t j = 0; j <= numLimbs; j++) {
+      _mm256_storeu_si256((__m256i*)(t + j*RN_MONT_LANES + h), zero);
+    }
+    for (uint32_t i = 0; i < numLimbs; i++) {
+      __m256i ai = _mm256_loadu_si256((const __m256i*)(a + i*RN_MONT_LANES + h));
+      __m256i z = _mm256_add_epi64(_mm256_loadu_si256((const __m256i*)(t + h)),
+          _mm256_mul_epu32(ai, _mm256_loadu_si256((const __m256i*)(b + h))));
+      __m256i u = _mm256_and_si256(_mm256_mul_epu32(_mm256_and_si256(z, mask), m0iVec), mask);
+      __m256i carry = zero;
+      for (uint32_t j = 0; j < numLimbs; j++) {
+        uint64_t *tj = t + j*RN_MONT_LANES + h;
+        __m256i bj = _mm256_loadu_si256((const __m256i*)(b + j*RN_MONT_LANES + h));
+        __m256i mj = _mm256_set1_epi64x(modulus[j]);
+        z = _mm256_add_epi64(_mm256_loadu_si256((const __m256i*)tj), _mm256_mul_epu32(ai, bj));
+        z = _mm256_add_epi64(z, _mm256_add_epi64(_mm256_mul_epu32(u, mj), carry));
+        if (j != 0) {
+          _mm256_storeu_si256((__m256i*)(tj - RN_MONT_LANES), _mm256_and_si256(z, mask));
+        }
+        carry = _mm256_srli_epi64(z, 31);
+      }
+      uint64_t *tn = t + numLimbs*RN_MONT_LANES + h;
+      z = _mm256_add_epi64(_mm256_loadu_si256((const __m256i*)tn), carry);
+      _mm256_storeu_si256((__m256i*)(tn - RN_MONT_LANES), _mm256_and_si256(z, mask));
+      _mm256_storeu_si256((__m256i*)tn, _mm256_srli_epi64(z, 31));
+    }
+  }
+  copyMontResult(dest, t, numLimbs);
+}
+
+// The AVX-512 version of montMulScalar, computing all 8 lanes per vector.
+__attribute__((target("avx512f")))
+static void montMulAvx512(uint64_t *dest, const uint64_t *a, const uint64_t *b,
+    const uint64_t *modulus, uint64_t m0i, uint32_t numLimbs, uint64_t *t) {
+  const __m512i mask = _mm512_set1_epi64(RN_LIMB_MASK);
+  const __m512i m0iVec = _mm512_set1_epi64(m0i);
+  const __m512i zero = _mm512_setzero_si512();
+  for (uint32_t j = 0; j <= numLimbs; j++) {
+    _mm512_storeu_si512(t + j*RN_MONT_LANES, zero);
+  }
+  for (uint32_t i = 0; i < numLimbs; i++) {
+    __m512i ai = _mm512_loadu_si512(a + i*RN_MONT_LANES);
+    __m512i z = _mm512_add_epi64(_mm512_loadu_si512(t), _mm512_mul_epu32(ai, _mm512_loadu_si512(b)));
+    __m512i u = _mm512_and_si512(_mm512_mul_epu32(_mm512_and_si512(z, mask), m0iVec), mask);
+    __m512i carry = zero;
+    for (uint32_t j = 0; j < numLimbs; j++) {
+      uint64_t *tj = t + j*RN_MONT_LANES;
+      __m512i bj = _mm512_loadu_si512(b + j*RN_MONT_LANES);
+      __m512i mj = _mm512_set1_epi64(modulus[j]);
+      z = _mm512_add_epi64(_mm512_loadu_si512(tj), _mm512_mul_epu32(ai, bj));
+      z = _mm512_add_epi64(z, _mm512_add_epi64(_mm512_mul_epu32(u, mj), carry));
+      if (j != 0) {
+        _mm512_storeu_si512(tj - RN_MONT_LANES, _mm512_and_si512(z, mask));
+      }
+      carry = _mm512_srli_epi64(z, 31);
+    }
+    uint64_t *tn = t + numLimbs*RN_MONT_LANES;
+    z = _mm512_add_epi64(_mm512_loadu_si512(tn), carry);
+    _mm512_storeu_si512(tn - RN_MONT_LANES, _mm512_and_si512(z, mask));
+    _mm512_storeu_si512(tn, _mm512_srli_epi64(z, 31));
+  }
+  copyMontResult(dest, t, numLimbs);
+}
+#endif  // RN_X86_SIMD
+
+// Select the fastest Montgomery kernel this CPU supports.
+static montMulFunc findMontMulFunc(void) {
+  static montMulFunc montMul = NULL;
+  if (montMul != NULL) {
+    return montMul;
+  }
+  montMul = montMulScalar;
+#ifdef RN_X86_SIMD
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    montMul = montMulAvx512;
+  } else if (__builtin_cpu_supports("avx2")) {
+    montMul = montMulAvx2;
+  }
+#endif
+  return montMul;
+}
+
+// Return -modulus^-1 mod 2^31, given the low limb of an odd modulus.
+static uint64_t findMontgomeryM0i(uint32_t m0) {
+  // m0 is its own inverse mod 8, and each Newton step doubles the good bits.
+  uint32_t x = m0;
+  for (uint32_t i = 0; i < 4; i++) {
+    x *= 2 - m0*x;
+  }
+  return (-x) & RN_LIMB_MASK;
+}
+
+// Copy the limbs of |bigint| into lane |lane| of |group|, zero extending it to
+// numLimbs limbs.
+static void loadMontLane(uint64_t *group, uint32_t lane, const runtime_array *bigint,
+    uint32_t numLimbs) {
+  const uint32_t *data = getConstBigintData(bigint);
+  uint32_t bigintLimbs = bigint->numElements - 2;
+  for (uint32_t j = 0; j < numLimbs; j++) {
+    group[j*RN_MONT_LANES + lane] = j < bigintLimbs? data[2 + j] : 0;
+  }
+}
+
+// Set every lane of |group| to the same value.
+static void broadcastMontValue(uint64_t *group, const uint64_t *limbs, uint32_t numLimbs) {
+  for (uint32_t j = 0; j < numLimbs; j++) {
+    for (uint32_t l = 0; l < RN_MONT_LANES; l++) {
+      group[j*RN_MONT_LANES + l] = limbs[j];
+    }
+  }
+}
+
+// Constant-time subtract the modulus from lane |lane| of |group| if the value
+// is >= modulus.  Values are < 2*modulus, so this fully reduces them.
+static void reduceMontLane(uint64_t *group, uint32_t lane, const uint64_t *modulus,
+    uint32_t numLimbs) {
+  uint64_t borrow = 0;
+  for (uint32_t j = 0; j < numLimbs; j++) {
+    borrow = (group[j*RN_MONT_LANES + lane] - modulus[j] - borrow) >> 63;
+  }
+  uint64_t mask = borrow - 1;
+  borrow = 0;
+  for (uint32_t j = 0; j < numLimbs; j++) {
+    uint64_t *limb = group + j*RN_MONT_LANES + lane;
+    uint64_t diff = *limb - (modulus[j] & mask) - borrow;
+    *limb = diff & RN_LIMB_MASK;
+    borrow = diff >> 63;
+  }
+}
+
+// Set r2 to R^2 mod modulus, where R = 2^(31*numLimbs).  The modulus is
+// public, so it is fine to use the general bigint modulus.
+static void findMontgomeryR2Bigint(runtime_array *r2, runtime_array *modulus,
+    uint32_t numLimbs) {
+  uint32_t width = 62*numLimbs + 1;
+  runtime_array bigModulus = runtime_makeEmptyArray();
+  runtime_integerToBigint(r2, 0, width, false, false);
+  getBigintData(r2)[2 + 2*numLimbs] = 1;
+  runtime_bigintCast(&bigModulus, modulus, width, false, false, false);
+  runtime_bigintMod(r2, r2, &bigModulus);
+  runtime_freeArray(&bigModulus);
+}
+
+// Compute R^2 mod modulus into 64-bit limbs.
+static void findMontgomeryR2(uint64_t *r2Limbs, runtime_array *modulus, uint32_t numLimbs) {
+  runtime_array r2 = runtime_makeEmptyArray();
+  findMontgomeryR2Bigint(&r2, modulus, numLimbs);
+  const uint32_t *data = getConstBigintData(&r2);
+  for (uint32_t j = 0; j < numLimbs; j++) {
+    r2Limbs[j] = data[2 + j];
+  }
+  runtime_freeArray(&r2);
+}
+
+// Return the i'th bigint in an array of bigints.
+static inline runtime_array *indexBigintArray(const runtime_array *array, uint64_t index) {
+  return (runtime_array*)(array->data) + index;
+}
+
+// Check the modulus and operands passed to a batched modular operation, and
+// return the number of Montgomery limbs needed.
+static uint32_t checkBatchOperands(runtime_array *a, runtime_array *b, runtime_array *modulus,
+    bool checkB) {
+  if (runtime_bigintSecret(modulus)) {
+    runtime_throwExceptionCstr("Modulus cannot be secret");
+  }
+  if (runtime_bigintSigned(modulus)) {
+    runtime_throwExceptionCstr("Modulus must be unsigned");
+  }
+  if ((getConstBigintData(modulus)[2] & 1) == 0) {
+    runtime_throwExceptionCstr("Batched modular arithmetic requires an odd modulus");
+  }
+  if (a->numElements != b->numElements) {
+    runtime_throwExceptionCstr("Batched modular operands must have the same length");
+  }
+  uint32_t width = runtime_bigintWidth(modulus);
+  for (uint64_t i = 0; i < a->numElements; i++) {
+    runtime_array *operand = indexBigintArray(a, i);
+    if (runtime_bigintSigned(operand) || runtime_bigintWidth(operand) > width) {
+      runtime_throwExceptionCstr("Batched modular operands must be unsigned and no wider than the modulus");
+    }
+    if (checkB) {
+      operand = indexBigintArray(b, i);
+      if (runtime_bigintSigned(operand) || runtime_bigintWidth(operand) > width) {
+        runtime_throwExceptionCstr("Batched modular operands must be unsigned and no wider than the modulus");
+      }
+    }
+  }
+  // Leave 2 spare bits so 4*modulus < R.
+  return (width + 2 + 30)/31;
+}
+
+// Fill |dest| with the results in |groups|, as bigints the width of the
+// modulus.  A result is secret if either of its operands was.
+static void storeBatchResults(runtime_array *dest, const uint64_t *groups, const bool *secrets,
+    uint64_t numValues, uint32_t width, uint32_t numLimbs) {
+  runtime_freeArray(dest);
+  runtime_allocArray(dest, numValues, sizeof(runtime_array), true);
+  for (uint64_t i = 0; i < numValues; i++) {
+    // Recompute the address each iteration, since allocating may move dest.
+    runtime_array *result = indexBigintArray(dest, i);
+    initBigint(result, width, false, secrets[i]);
+    uint32_t *data = getBigintData(result);
+    const uint64_t *group = groups + (i/RN_MONT_LANES)*numLimbs*RN_MONT_LANES;
+    uint32_t lane = i % RN_MONT_LANES;
+    for (uint32_t j = 0; j < result->numElements - 2; j++) {
+      data[2 + j] = group[j*RN_MONT_LANES + lane];
+    }
+  }
+}
+
+// Zero and free a buffer that may hold secrets.
+static void freeMontBuffer(uint64_t *buffer, uint64_t numWords) {
+  runtime_zeroMemory(buffer, numWords);
+  free(buffer);
+}
+
+// Compute dest[i] = a[i]*b[i] mod modulus for arrays of bigints, using SIMD
+// lanes where available.  This is constant time.
+void runtime_bigintBatchModularMul(runtime_array *dest, runtime_array *a, runtime_array *b,
+    runtime_array *modulus) {
+  uint32_t numLimbs = checkBatchOperands(a, b, modulus, true);
+  uint64_t numValues = a->numElements;
+  uint64_t numGroups = (numValues + RN_MONT_LANES - 1)/RN_MONT_LANES;
+  uint64_t groupWords = numLimbs*RN_MONT_LANES;
+  uint64_t *modulusLimbs = calloc(numLimbs, sizeof(uint64_t));
+  uint64_t *r2 = calloc(groupWords, sizeof(uint64_t));
+  uint64_t *t = calloc(groupWords + RN_MONT_LANES, sizeof(uint64_t));
+  uint64_t *aGroups = calloc(numGroups*groupWords, sizeof(uint64_t));
+  uint64_t *bGroups = calloc(numGroups*groupWords, sizeof(uint64_t));
+  bool *secrets = calloc(numValues + 1, sizeof(bool));
+  const uint32_t *modulusData = getConstBigintData(modulus);
+  for (uint32_t j = 0; j < numLimbs; j++) {
+    modulusLimbs[j] = j < modulus->numElements - 2? modulusData[2 + j] : 0;
+  }
+  for (uint64_t i = 0; i < numValues; i++) {
+    uint64_t offset = (i/RN_MONT_LANES)*groupWords;
+    runtime_array *aValue = indexBigintArray(a, i);
+    runtime_array *bValue = indexBigintArray(b, i);
+    loadMontLane(aGroups + offset, i % RN_MONT_LANES, aValue, numLimbs);
+    loadMontLane(bGroups + offset, i % RN_MONT_LANES, bValue, numLimbs);
+    secrets[i] = runtime_bigintSecret(aValue) || runtime_bigintSecret(bValue);
+  }
+  uint32_t width = runtime_bigintWidth(modulus);
+  findMontgomeryR2(t, modulus, numLimbs);
+  broadcastMontValue(r2, t, numLimbs);
+  uint64_t m0i = findMontgomeryM0i(modulusLimbs[0]);
+  montMulFunc montMul = findMontMulFunc();
+  for (uint64_t g = 0; g < numGroups; g++) {
+    uint64_t *aGroup = aGroups + g*groupWords;
+    // (a*R^2)/R = a*R, and then (a*R*b)/R = a*b.
+    montMul(aGroup, aGroup, r2, modulusLimbs, m0i, numLimbs, t);
+    montMul(aGroup, aGroup, bGroups + g*groupWords, modulusLimbs, m0i, numLimbs, t);
+    for (uint32_t l = 0; l < RN_MONT_LANES; l++) {
+      reduceMontLane(aGroup, l, modulusLimbs, numLimbs);
+    }
+  }
+  storeBatchResults(dest, aGroups, secrets, numValues, width, numLimbs);
+  free(modulusLimbs);
+  free(r2);
+  free(secrets);
+  freeMontBuffer(t, groupWords + RN_MONT_LANES);
+  freeMontBuffer(aGroups, numGroups*groupWords);
+  freeMontBuffer(bGroups, numGroups*groupWords);
+}
+
+// Compute dest[i] = bases[i]^exponents[i] mod modulus for arrays of bigints,
+// using SIMD lanes where available.  This is constant time: every lane does a
+// square and a multiply for every bit of the widest exponent.
+void runtime_bigintBatchModularExp(runtime_array *dest, runtime_array *bases,
+    runtime_array *exponents, runtime_array *modulus) {
+  uint32_t numLimbs = checkBatchOperands(bases, exponents, modulus, false);
+  uint64_t numValues = bases->numElements;
+  uint32_t expLimbs = 0;
+  for (uint64_t i = 0; i < numValues; i++) {
+    runtime_array *exponent = indexBigintArray(exponents, i);
+    if (runtime_rnBoolToBool(runtime_bigintNegative(exponent))) {
+      runtime_throwExceptionCstr("Tried to exponentiate with negative exponent");
+    }
+    if (exponent->numElements - 2 > expLimbs) {
+      expLimbs = exponent->numElements - 2;
+    }
+  }
+  uint64_t numGroups = (numValues + RN_MONT_LANES - 1)/RN_MONT_LANES;
+  uint64_t groupWords = numLimbs*RN_MONT_LANES;
+  uint64_t expGroupWords = expLimbs*RN_MONT_LANES;
+  uint64_t *modulusLimbs = calloc(numLimbs, sizeof(uint64_t));
+  uint64_t *r2 = calloc(groupWords, sizeof(uint64_t));
+  uint64_t *one = calloc(groupWords, sizeof(uint64_t));
+  uint64_t *acc = calloc(groupWords, sizeof(uint64_t));
+  uint64_t *product = calloc(groupWords, sizeof(uint64_t));
+  uint64_t *t = calloc(groupWords + RN_MONT_LANES, sizeof(uint64_t));
+  uint64_t *baseGroups = calloc(numGroups*groupWords, sizeof(uint64_t));
+  uint64_t *expGroups = calloc(numGroups*expGroupWords + 1, sizeof(uint64_t));
+  bool *secrets = calloc(numValues + 1, sizeof(bool));
+  const uint32_t *modulusData = getConstBigintData(modulus);
+  for (uint32_t j = 0; j < numLimbs; j++) {
+    modulusLimbs[j] = j < modulus->numElements - 2? modulusData[2 + j] : 0;
+  }
+  for (uint64_t i = 0; i < numValues; i++) {
+    runtime_array *base = indexBigintArray(bases, i);
+    runtime_array *exponent = indexBigintArray(exponents, i);
+    uint32_t lane = i % RN_MONT_LANES;
+    loadMontLane(baseGroups + (i/RN_MONT_LANES)*groupWords, lane, base, numLimbs);
+    loadMontLane(expGroups + (i/RN_MONT_LANES)*expGroupWords, lane, exponent, expLimbs);
+    secrets[i] = runtime_bigintSecret(base) || runtime_bigintSecret(exponent);
+  }
+  uint32_t width = runtime_bigintWidth(modulus);
+  findMontgomeryR2(t, modulus, numLimbs);
+  broadcastMontValue(r2, t, numLimbs);
+  for (uint32_t l = 0; l < RN_MONT_LANES; l++) {
+    one[l] = 1;
+  }
+  uint64_t m0i = findMontgomeryM0i(modulusLimbs[0]);
+  montMulFunc montMul = findMontMulFunc();
+  for (uint64_t g = 0; g < numGroups; g++) {
+    uint64_t *base = baseGroups + g*groupWords;
+    const uint64_t *expGroup = expGroups + g*expGroupWords;
+    // Convert the base and 1 to Montgomery form.
+    montMul(base, base, r2, modulusLimbs, m0i, numLimbs, t);
+    montMul(acc, one, r2, modulusLimbs, m0i, numLimbs, t);
+    for (uint32_t bit = expLimbs*31; bit-- != 0;) {
+      montMul(acc, acc, acc, modulusLimbs, m0i, numLimbs, t);
+      montMul(product, acc, base, modulusLimbs, m0i, numLimbs, t);
+      const uint64_t *expLimb = expGroup + (bit/31)*RN_MONT_LANES;
+      for (uint32_t l = 0; l < RN_MONT_LANES; l++) {
+        uint64_t mask = -((expLimb[l] >> (bit % 31)) & 1);
+        for (uint32_t j = 0; j < numLimbs; j++) {
+          uint64_t *accLimb = acc + j*RN_MONT_LANES + l;
+          *accLimb = (product[j*RN_MONT_LANES + l] & mask) | (*accLimb & ~mask);
+        }
+      }
+    }
+    // Convert back out of Montgomery form.
+    montMul(base, acc, one, modulusLimbs, m0i, numLimbs, t);
+    for (uint32_t l = 0; l < RN_MONT_LANES; l++) {
+      reduceMontLane(base, l, modulusLimbs, numLimbs);
+    }
+  }
+  storeBatchResults(dest, baseGroups, secrets, numValues, width, numLimbs);
+  free(modulusLimbs);
+  free(r2);
+  free(one);
+  free(secrets);
+  freeMontBuffer(acc, groupWords);
+  freeMontBuffer(product, groupWords);
+  freeMontBuffer(t, groupWords + RN_MONT_LANES);
+  freeMontBuffer(baseGroups, numGroups*groupWords);
+  freeMontBuffer(expGroups, numGroups*expGroupWords + 1);
+}
+
+// Specialized modular reduction for moduli known at compile time.  The compiler
+// picks a reduction for each constant modulus wider than 64 bits, and
+// precomputes the constant it needs: c for a pseudo-Mersenne modulus 2^k - c,
+// R^2 mod m for other odd moduli, and floor(4^k/m) for Barrett reduction of
+// even moduli.  Values are held in numLimbs 31-bit limbs, with the same 2 spare
+// bits and R = 2^(31*numLimbs) as the batched Montgomery code.  All of these
+// are constant time.
+//
+// The compiler emits a runtime_constModulus global for each constant modulus,
+// and the context below is built from it on first use, and kept until exit.
+typedef struct constModulusStruct constModulus;
+
+// Multiply a and b, which must be fully reduced, setting dest.  dest may alias
+// a or b.
+typedef void (*constModMulFunc)(constModulus *cm, uint32_t *dest, const uint32_t *a,
+    const uint32_t *b);
+
+struct constModulusStruct {
+  constModMulFunc mul;
+  uint32_t numLimbs;
+  uint32_t modulusBits;  // The bit length, k, of the modulus.
+  uint32_t m0i;  // -modulus^-1 mod 2^31, used only by Montgomery reduction.
+  uint32_t *modulus;
+  uint32_t *constant;
+  // Scratch space: 2*numLimbs + 2 limbs each.
+  uint32_t *product;
+  uint32_t *temp;
+  uint32_t *scratch;
+  // Operands and result: numLimbs limbs each.
+  uint32_t *a;
+  uint32_t *b;
+  uint32_t *result;
+  uint32_t *buffer;
+  uint32_t bufferLimbs;
+};
+
+// Set dest to the 2*numLimbs limb product of a and b.  dest must not alias a
+// or b.
+static void mulLimbs(uint32_t *dest, const uint32_t *a, const uint32_t *b, uint32_t numLimbs) {
+  for (uint32_t i = 0; i < 2*numLimbs; i++) {
+    dest[i] = 0;
+  }
+  for (uint32_t i = 0; i < numLimbs; i++) {
+    uint64_t carry = 0;
+    for (uint32_t j = 0; j < numLimbs; j++) {
+      uint64_t z = dest[i + j] + (uint64_t)a[i]*b[j] + carry;
+      dest[i + j] = z & RN_LIMB_MASK;
+      carry = z >> 31;
+    }
+    dest[i + numLimbs] = carry;
+  }
+}
+
+// Set dest = a - b mod 2^(31*numLimbs), and return the borrow.  dest may alias
+// a or b.
+static uint32_t subLimbs(uint32_t *dest, const uint32_t *a, const uint32_t *b,
+    uint32_t numLimbs) {
+  uint32_t borrow = 0;
+  for (uint32_t j = 0; j < numLimbs; j++) {
+    uint32_t diff = a[j] - b[j] - borrow;
+    dest[j] = diff & RN_LIMB_MASK;
+    borrow = diff >> 31;
+  }
+  return borrow;
+}
+
+// Set dest to the destLimbs low limbs of source >> shift.  dest may alias
+// source.
+static void shiftLimbsRight(uint32_t *dest, const uint32_t *source, uint32_t sourceLimbs,
+    uint32_t shift, uint32_t destLimbs) {
+  uint32_t limbShift = shift/31;
+  uint32_t bitShift = shift % 31;
+  for (uint32_t j = 0; j < destLimbs; j++) {
+    uint32_t low = limbShift + j < sourceLimbs? source[limbShift + j] : 0;
+    uint32_t high = limbShift + j + 1 < sourceLimbs? source[limbShift + j + 1] : 0;
+    dest[j] = ((low >> bitShift) | (high << (31 - bitShift))) & RN_LIMB_MASK;
+  }
+}
+
+// Subtract the modulus from value if value >= modulus, in constant time.
+static void condSubModulus(constModulus *cm, uint32_t *value) {
+  uint32_t mask = subLimbs(cm->temp, value, cm->modulus, cm->numLimbs) - 1;
+  for (uint32_t j = 0; j < cm->numLimbs; j++) {
+    value[j] = (cm->temp[j] & mask) | (value[j] & ~mask);
+  }
+}
+
+// Replace the 2*numLimbs limb value in cm->product with hi*c + lo, where hi and
+// lo are the bits above and below bit k.  This preserves the value mod 2^k - c.
+static void foldPseudoMersenne(constModulus *cm) {
+  uint32_t numLimbs = 2*cm->numLimbs;
+  uint32_t k = cm->modulusBits;
+  uint32_t *product = cm->product;
+  shiftLimbsRight(cm->temp, product, numLimbs, k, numLimbs);
+  for (uint32_t j = k/31; j < numLimbs; j++) {
+    product[j] &= j == k/31? (1u << (k % 31)) - 1 : 0;
+  }
+  uint64_t c = cm->constant[0];
+  uint64_t carry = 0;
+  for (uint32_t j = 0; j < numLimbs; j++) {
+    uint64_t z = product[j] + c*cm->temp[j] + carry;
+    product[j] = z & RN_LIMB_MASK;
+    carry = z >> 31;
+  }
+}
+
+// Multiply modulo 2^k - c.  After two folds the value is below 2^k + c^2,
+// which is less than twice the modulus, since c < 2^31 and k >= 64.
+static void pseudoMersenneMul(constModulus *cm, uint32_t *dest, const uint32_t *a,
+    const uint32_t *b) {
+  mulLimbs(cm->product, a, b, cm->numLimbs);
+  foldPseudoMersenne(cm);
+  foldPseudoMersenne(cm);
+  condSubModulus(cm, cm->product);
+  for (uint32_t j = 0; j < cm->numLimbs; j++) {
+    dest[j] = cm->product[j];
+  }
+}
+
+// Multiply using Barrett reduction, with mu = floor(4^k/m) in cm->constant.
+// The quotient estimate is at most 2 too small, so two conditional
+// subtractions fully reduce the result.
+static void barrettMul(constModulus *cm, uint32_t *dest, const uint32_t *a, const uint32_t *b) {
+  uint32_t numLimbs = cm->numLimbs;
+  uint32_t k = cm->modulusBits;
+  mulLimbs(cm->product, a, b, numLimbs);
+  shiftLimbsRight(cm->temp, cm->product, 2*numLimbs, k - 1, numLimbs);
+  mulLimbs(cm->scratch, cm->temp, cm->constant, numLimbs);
+  shiftLimbsRight(cm->temp, cm->scratch, 2*numLimbs, k + 1, numLimbs);
+  mulLimbs(cm->scratch, cm->temp, cm->modulus, numLimbs);
+  // The remainder is less than 3*m, which fits in numLimbs limbs.
+  subLimbs(dest, cm->product, cm->scratch, numLimbs);
+  condSubModulus(cm, dest);
+  condSubModulus(cm, dest);
+}
+
+// Set dest = a*b/R mod m, using CIOS Montgomery multiplication.  The result is
+// less than 2*m if a and b are.
+static void montgomeryMul(constModulus *cm, uint32_t *dest, const uint32_t *a,
+    const uint32_t *b) {
+  uint32_t numLimbs = cm->numLimbs;
+  const uint32_t *modulus = cm->modulus;
+  uint32_t *t = cm->temp;
+  for (uint32_t j = 0; j < numLimbs + 2; j++) {
+    t[j] = 0;
+  }
+  for (uint32_t i = 0; i < numLimbs; i++) {
+    uint64_t carry = 0;
+    for (uint32_t j = 0; j < numLimbs; j++) {
+      uint64_t z = t[j] + (uint64_t)a[i]*b[j] + carry;
+      t[j] = z & RN_LIMB_MASK;
+      carry = z >> 31;
+    }
+    uint64_t z = t[numLimbs] + carry;
+    t[numLimbs] = z & RN_LIMB_MASK;
+    t[numLimbs + 1] = z >> 31;
+    uint64_t u = (t[0]*cm->m0i) & RN_LIMB_MASK;
+    carry = (t[0] + u*modulus[0]) >> 31;
+    for (uint32_t j = 1; j < numLimbs; j++) {
+      z = t[j] + u*modulus[j] + carry;
+      t[j - 1] = z & RN_LIMB_MASK;
+      carry = z >> 31;
+    }
+    z = t[numLimbs] + carry;
+    t[numLimbs - 1] = z & RN_LIMB_MASK;
+    t[numLimbs] = t[numLimbs + 1] + (z >> 31);
+  }
+  for (uint32_t j = 0; j < numLimbs; j++) {
+    dest[j] = t[j];
+  }
+}
+
+// Multiply fully reduced values with Montgomery reduction, with R^2 mod m in
+// cm->constant.  The second multiply by R^2 cancels the 1/R from the first.
+static void montgomeryModularMul(constModulus *cm, uint32_t *dest, const uint32_t *a,
+    const uint32_t *b) {
+  montgomeryMul(cm, cm->product, a, b);
+  montgomeryMul(cm, dest, cm->product, cm->constant);
+  condSubModulus(cm, dest);
+}
+
+// Set acc = acc^(2^expBits)*base^exponent using mul, scanning every exponent
+// bit so the time depends only on the exponent's width.  Uses cm->b as
+// scratch.
+static void constModularExp(constModulus *cm, constModMulFunc mul, uint32_t *acc,
+    const uint32_t *base, const uint32_t *expData, uint32_t expBits) {
+  uint32_t *t = cm->b;
+  for (uint32_t i = expBits; i-- != 0;) {
+    mul(cm, acc, acc, acc);
+    mul(cm, t, acc, base);
+    uint32_t mask = -((expData[i/31] >> (i % 31)) & 1);
+    for (uint32_t j = 0; j < cm->numLimbs; j++) {
+      acc[j] = (t[j] & mask) | (acc[j] & ~mask);
+    }
+  }
+}
+
+// Return the bit length of a value held in limbs.  Only used on public moduli.
+static uint32_t findLimbsBitLength(const uint32_t *limbs, uint32_t numLimbs) {
+  for (uint32_t j = numLimbs; j-- != 0;) {
+    if (limbs[j] != 0) {
+      return 31*j + 32 - __builtin_clz(limbs[j]);
+    }
+  }
+  return 0;
+}
+
+// Copy the limbs of |bigint| into |limbs|, zero extending it to numLimbs limbs.
+static void loadLimbs(uint32_t *limbs, const runtime_array *bigint, uint32_t numLimbs) {
+  const uint32_t *data = getConstBigintData(bigint);
+  uint32_t bigintLimbs = bigint->numElements - 2;
+  for (uint32_t j = 0; j < numLimbs; j++) {
+    limbs[j] = j < bigintLimbs? data[2 + j] : 0;
+  }
+}
+
+// Copy the low |width| bits of a native wide integer's 64-bit words into
+// |limbs|, zero extending it to numLimbs limbs.  Bits above width are ignored.
+static void loadLimbsFromWords(uint32_t *limbs, const uint64_t *words, uint32_t width,
+    uint32_t numLimbs) {
+  for (uint32_t j = 0; j < numLimbs; j++) {
+    uint32_t bit = 31*j;
+    uint32_t limb = 0;
+    if (bit < width) {
+      uint32_t shift = bit % 64;
+      uint64_t value = words[bit/64] >> shift;
+      if (shift > 33 && bit/64 + 1 < (width + 63)/64) {
+        value |= words[bit/64 + 1] << (64 - shift);
+      }
+      limb = value & RN_LIMB_MASK;
+      if (width - bit < 31) {
+        limb &= (1u << (width - bit)) - 1;
+      }
+    }
+    limbs[j] = limb;
+  }
+}
+
+// Set the 64-bit words of a native wide integer of |width| bits to the value
+// held in limbs, which must fit.
+static void storeLimbsToWords(uint64_t *words, const uint32_t *limbs, uint32_t numLimbs,
+    uint32_t width) {
+  uint32_t numWords = (width + 63)/64;
+  for (uint32_t i = 0; i < numWords; i++) {
+    words[i] = 0;
+  }
+  for (uint32_t j = 0; j < numLimbs; j++) {
+    uint32_t bit = 31*j;
+    if (bit < width) {
+      words[bit/64] |= (uint64_t)limbs[j] << (bit % 64);
+      if (bit % 64 > 33 && bit/64 + 1 < numWords) {
+        words[bit/64 + 1] |= (uint64_t)limbs[j] >> (64 - bit % 64);
+      }
+    }
+  }
+}
+
+// Return the number of limbs needed for the buffers of a modulus of |width|
+// bits, rounded up to a whole number of uint64_t words for runtime_zeroMemory.
+static uint32_t findConstModulusBufferLimbs(uint32_t width) {
+  uint32_t numLimbs = (width + 2 + 30)/31;
+  return (11*numLimbs + 6 + 1) & ~1u;
+}
+
+// Lay out the buffers of |cm| in |buffer|, for a modulus of |width| bits.
+static void layoutConstModulus(constModulus *cm, uint32_t width, uint32_t *buffer) {
+  uint32_t numLimbs = (width + 2 + 30)/31;
+  cm->numLimbs = numLimbs;
+  cm->bufferLimbs = findConstModulusBufferLimbs(width);
+  cm->buffer = buffer;
+  cm->modulus = cm->buffer;
+  cm->constant = cm->modulus + numLimbs;
+  cm->product = cm->constant + numLimbs;
+  cm->temp = cm->product + 2*numLimbs + 2;
+  cm->scratch = cm->temp + 2*numLimbs + 2;
+  cm->a = cm->scratch + 2*numLimbs + 2;
+  cm->b = cm->a + numLimbs;
+  cm->result = cm->b + numLimbs;
+}
+
+// Set up |cm| for a public modulus held in a bigint, for Montgomery
+// multiplication.  The caller fills in cm->constant if needed.  Free it with
+// freeConstModulus.
+static void initConstModulus(constModulus *cm, runtime_array *modulus) {
+  if (runtime_bigintSecret(modulus)) {
+    runtime_throwExceptionCstr("Modulus cannot be secret");
+  }
+  if (runtime_bigintSigned(modulus)) {
+    runtime_throwExceptionCstr("Modulus must be unsigned");
+  }
+  uint32_t width = runtime_bigintWidth(modulus);
+  layoutConstModulus(cm, width, calloc(findConstModulusBufferLimbs(width), sizeof(uint32_t)));
+  loadLimbs(cm->modulus, modulus, cm->numLimbs);
+  cm->modulusBits = findLimbsBitLength(cm->modulus, cm->numLimbs);
+  cm->m0i = findMontgomeryM0i(cm->modulus[0]);
+  cm->mul = montgomeryModularMul;
+}
+
+// Zero and free the buffers, which may hold secrets.
+static void freeConstModulus(constModulus *cm) {
+  runtime_zeroMemory((uint64_t*)cm->buffer, cm->bufferLimbs/2);
+  free(cm->buffer);
+}
+
+// Return the context for a constant modulus emitted by the compiler, building
+// it on first use.  The modulus and reduction constant were checked by the
+// compiler.  The context and its buffers are one allocation.
+static constModulus *findConstModulus(runtime_constModulus *constMod) {
+  if (constMod->context != NULL) {
+    return constMod->context;
+  }
+  uint32_t bufferLimbs = findConstModulusBufferLimbs(constMod->width);
+  constModulus *cm = calloc(1, sizeof(constModulus) + bufferLimbs*sizeof(uint32_t));
+  layoutConstModulus(cm, constMod->width, (uint32_t*)(cm + 1));
+  loadLimbsFromWords(cm->modulus, constMod->modulus, constMod->width, cm->numLimbs);
+  loadLimbsFromWords(cm->constant, constMod->constant, constMod->constantWidth, cm->numLimbs);
+  cm->modulusBits = findLimbsBitLength(cm->modulus, cm->numLimbs);
+  cm->m0i = findMontgomeryM0i(cm->modulus[0]);
+  switch (constMod->reduction) {
+    case RN_REDUCE_PSEUDO_MERSENNE:
+      cm->mul = pseudoMersenneMul;
+      break;
+    case RN_REDUCE_MONTGOMERY:
+      cm->mul = montgomeryModularMul;
+      break;
+    case RN_REDUCE_BARRETT:
+      cm->mul = barrettMul;
+      break;
+    default:
+      runtime_panicCstr("Unknown modular reduction");
+  }
+  constMod->context = cm;
+  return cm;
+}
+
+// Clear the operands, result, and scratch space, which may hold secrets, after
+// an operation on a cached context.  The modulus and constant are kept.
+static void clearConstModulus(constModulus *cm) {
+  memset(cm->product, 0, (cm->bufferLimbs - 2*cm->numLimbs)*sizeof(uint32_t));
+}
+
+// Set dest to the result limbs, as a bigint of |width| bits.
+static void storeConstModularResult(runtime_array *dest, constModulus *cm, uint32_t width,
+    bool secret) {
+  initBigint(dest, width, false, secret);
+  uint32_t *data = getBigintData(dest);
+  for (uint32_t j = 0; j < dest->numElements - 2; j++) {
+    data[2 + j] = cm->result[j];
+  }
+}
+
+// Set cm->result = a^exponent mod m, with a in cm->a.  The time depends only on
+// expBits.
+static void constModularFullExp(constModulus *cm, const uint32_t *expData, uint32_t expBits) {
+  uint32_t numLimbs = cm->numLimbs;
+  if (cm->mul != montgomeryModularMul) {
+    for (uint32_t j = 0; j < numLimbs; j++) {
+      cm->result[j] = j == 0;
+    }
+    constModularExp(cm, cm->mul, cm->result, cm->a, expData, expBits);
+    return;
+  }
+  // Keep the base in Montgomery form for the whole exponentiation, so each step
+  // costs just one Montgomery multiply.  Convert the base and 1 to Montgomery
+  // form first.
+  montgomeryMul(cm, cm->a, cm->a, cm->constant);
+  for (uint32_t j = 0; j < numLimbs; j++) {
+    cm->b[j] = j == 0;
+  }
+  montgomeryMul(cm, cm->result, cm->b, cm->constant);
+  constModularExp(cm, montgomeryMul, cm->result, cm->a, expData, expBits);
+  // Convert back by multiplying by 1.
+  for (uint32_t j = 0; j < numLimbs; j++) {
+    cm->b[j] = j == 0;
+  }
+  montgomeryMul(cm, cm->result, cm->result, cm->b);
+  condSubModulus(cm, cm->result);
+}
+
+// Multiply bigints a and b modulo a constant modulus.
+void runtime_bigintConstModularMul(runtime_array *dest, runtime_array *a, runtime_array *b,
+    runtime_constModulus *modulus) {
+  constModulus *cm = findConstModulus(modulus);
+  bool secret = runtime_bigintSecret(a) || runtime_bigintSecret(b);
+  loadLimbs(cm->a, a, cm->numLimbs);
+  loadLimbs(cm->b, b, cm->numLimbs);
+  cm->mul(cm, cm->result, cm->a, cm->b);
+  storeConstModularResult(dest, cm, modulus->width, secret);
+  clearConstModulus(cm);
+}
+
+// Exponentiate a bigint modulo a constant modulus.
+void runtime_bigintConstModularExp(runtime_array *dest, runtime_array *base,
+    runtime_array *exponent, runtime_constModulus *modulus) {
+  if (runtime_rnBoolToBool(runtime_bigintNegative(exponent))) {
+    runtime_throwExceptionCstr("Tried to exponentiate with negative exponent");
+  }
+  constModulus *cm = findConstModulus(modulus);
+  bool secret = runtime_bigintSecret(base) || runtime_bigintSecret(exponent);
+  loadLimbs(cm->a, base, cm->numLimbs);
+  constModularFullExp(cm, getConstBigintData(exponent) + 2, (exponent->numElements - 2)*31);
+  storeConstModularResult(dest, cm, modulus->width, secret);
+  clearConstModulus(cm);
+}
+
+// Multiply native wide integers a and b modulo a constant modulus of the same
+// width.  The operands are passed by reference, as 64-bit words.
+void runtime_wideIntConstModularMul(uint64_t *dest, const uint64_t *a, const uint64_t *b,
+    runtime_constModulus *modulus) {
+  constModulus *cm = findConstModulus(modulus);
+  loadLimbsFromWords(cm->a, a, modulus->width, cm->numLimbs);
+  loadLimbsFromWords(cm->b, b, modulus->width, cm->numLimbs);
+  cm->mul(cm, cm->result, cm->a, cm->b);
+  storeLimbsToWords(dest, cm->result, cm->numLimbs, modulus->width);
+  clearConstModulus(cm);
+}
+
+// Exponentiate a native wide integer modulo a constant modulus of the same
+// width.  The exponent is an unsigned integer of expWidth bits, also passed as
+// 64-bit words.
+void runtime_wideIntConstModularExp(uint64_t *dest, const uint64_t *base,
+    const uint64_t *exponent, uint32_t expWidth, runtime_constModulus *modulus) {
+  constModulus *cm = findConstModulus(modulus);
+  // Round up to whole 64-bit words for runtime_zeroMemory.
+  uint32_t expLimbs = ((expWidth + 30)/31 + 1) & ~1u;
+  uint32_t *expData = calloc(expLimbs, sizeof(uint32_t));
+  loadLimbsFromWords(expData, exponent, expWidth, expLimbs);
+  loadLimbsFromWords(cm->a, base, modulus->width, cm->numLimbs);
+  constModularFullExp(cm, expData, expWidth);
+  storeLimbsToWords(dest, cm->result, cm->numLimbs, modulus->width);
+  clearConstModulus(cm);
+  runtime_zeroMemory((uint64_t*)expData, expLimbs/2);
+  free(expData);
+}
+
+// Fixed-base exponentiation uses a Lim-Lee comb.  For a modulus of width bits,
+// the exponent is split into RN_COMB_TEETH rows of spacing bits, and the table
+// holds the product of g^(2^(j*spacing)) for each subset j of the rows.  An
+// exponentiation is then just spacing squarings and multiplies, rather than
+// width of each.  The table is an array of integers of the modulus's type: the
+// modulus, followed by the RN_COMB_ENTRIES products in Montgomery form.  Entry
+// 1, the empty product, is R mod m, the Montgomery form of 1.
+#define RN_COMB_TEETH 5u
+#define RN_COMB_ENTRIES (1u << RN_COMB_TEETH)
+
+// Return the number of exponent bits covered by each row of the comb.
+static inline uint32_t findCombSpacing(uint32_t width) {
+  return (width + RN_COMB_TEETH - 1)/RN_COMB_TEETH;
+}
+
+// Check that the modulus can be used for Montgomery multiplication.
+static void checkCombModulus(runtime_array *modulus) {
+  if ((getConstBigintData(modulus)[2] & 1) == 0) {
+    runtime_throwExceptionCstr("Fixed-base exponentiation requires an odd modulus");
+  }
+}
+
+// Set entry to the limbs of a fully reduced value, as a bigint the width of the
+// modulus.
+static void storeCombEntry(runtime_array *entry, const uint32_t *limbs, uint32_t width,
+    bool secret) {
+  initBigint(entry, width, false, secret);
+  uint32_t *data = getBigintData(entry);
+  for (uint32_t j = 0; j < entry->numElements - 2; j++) {
+    data[2 + j] = limbs[j];
+  }
+}
+
+// Build the comb table for computing base^e mod modulus.  The table is only as
+// secret as the base.
+void runtime_bigintFixedBaseTable(runtime_array *table, runtime_array *base,
+    runtime_array *modulus) {
+  if (runtime_bigintSigned(base)) {
+    runtime_throwExceptionCstr("Modular values must be unsigned");
+  }
+  checkCombModulus(modulus);
+  constModulus cm;
+  initConstModulus(&cm, modulus);
+  runtime_array r2 = runtime_makeEmptyArray();
+  findMontgomeryR2Bigint(&r2, modulus, cm.numLimbs);
+  loadLimbs(cm.constant, &r2, cm.numLimbs);
+  runtime_freeArray(&r2);
+  uint32_t width = runtime_bigintWidth(modulus);
+  uint32_t spacing = findCombSpacing(width);
+  bool secret = runtime_bigintSecret(base);
+  runtime_freeArray(table);
+  runtime_allocArray(table, RN_COMB_ENTRIES + 1, sizeof(runtime_array), true);
+  // Recompute entry addresses after each allocation, in case table moved.
+  runtime_copyArray((runtime_array*)table->data, modulus, sizeof(uint32_t), false);
+  // Convert 1 and the base to Montgomery form.  The base may be up to R, which
+  // still leaves the product below 2*m.
+  uint32_t *power = cm.a;
+  uint32_t *entry = cm.b;
+  entry[0] = 1;
+  montgomeryMul(&cm, cm.result, entry, cm.constant);
+  condSubModulus(&cm, cm.result);
+  storeCombEntry((runtime_array*)table->data + 1, cm.result, width, secret);
+  loadLimbs(power, base, cm.numLimbs);
+  montgomeryMul(&cm, power, power, cm.constant);
+  for (uint32_t j = 0; j < RN_COMB_TEETH; j++) {
+    uint32_t row = 1u << j;
+    for (uint32_t i = 0; i < row; i++) {
+      loadLimbs(entry, (runtime_array*)table->data + 1 + i, cm.numLimbs);
+      montgomeryMul(&cm, cm.result, entry, power);
+      condSubModulus(&cm, cm.result);
+      storeCombEntry((runtime_array*)table->data + 1 + row + i, cm.result, width, secret);
+    }
+    // Advance power from g^(2^(j*spacing)) to g^(2^((j+1)*spacing)).
+    for (uint32_t k = 0; k < spacing && j + 1 < RN_COMB_TEETH; k++) {
+      montgomeryMul(&cm, power, power, power);
+    }
+  }
+  freeConstModulus(&cm);
+}
+
+// Compute base^exponent mod modulus from a table built by
+// runtime_bigintFixedBaseTable.  This is constant time in the exponent: every
+// step does one Montgomery squaring, one Montgomery multiply, and reads every
+// table entry.
+void runtime_bigintFixedBaseExp(runtime_array *dest, runtime_array *table,
+    runtime_array *exponent) {
+  if (table->numElements != RN_COMB_ENTRIES + 1) {
+    runtime_throwExceptionCstr("Invalid fixed-base exponentiation table");
+  }
+  runtime_array *modulus = (runtime_array*)table->data;
+  uint32_t width = runtime_bigintWidth(modulus);
+  if (runtime_bigintSigned(exponent) || runtime_bigintWidth(exponent) > width) {
+    runtime_throwExceptionCstr("Fixed-base exponent must be unsigned and no wider than the modulus");
+  }
+  checkCombModulus(modulus);
+  constModulus cm;
+  initConstModulus(&cm, modulus);
+  uint32_t spacing = findCombSpacing(width);
+  bool secret = runtime_bigintSecret(exponent) ||
+      runtime_bigintSecret((runtime_array*)table->data + 2);
+  const runtime_array *entries = (runtime_array*)table->data + 1;
+  uint32_t numLimbs = cm.numLimbs;
+  uint32_t *res = cm.result;
+  uint32_t *entry = cm.b;
+  const uint32_t *expData = getConstBigintData(exponent);
+  uint32_t expBits = (exponent->numElements - 2)*31;
+  uint32_t entryLimbs = entries[0].numElements - 2;
+  loadLimbs(res, entries, numLimbs);
+  for (uint32_t k = spacing; k-- != 0;) {
+    montgomeryMul(&cm, res, res, res);
+    // Bit positions are public, only their values are secret.
+    uint32_t index = 0;
+    for (uint32_t j = 0; j < RN_COMB_TEETH; j++) {
+      uint32_t pos = j*spacing + k;
+      if (pos < expBits) {
+        index |= ((expData[2 + pos/31] >> (pos % 31)) & 1) << j;
+      }
+    }
+    for (uint32_t i = 0; i < numLimbs; i++) {
+      entry[i] = 0;
+    }
+    for (uint32_t e = 0; e < RN_COMB_ENTRIES; e++) {
+      uint32_t diff = e ^ index;
+      uint32_t mask = ((diff | -diff) >> 31) - 1;
+      const uint32_t *data = getConstBigintData(entries + e) + 2;
+      for (uint32_t i = 0; i < entryLimbs; i++) {
+        entry[i] |= data[i] & mask;
+      }
+    }
+    montgomeryMul(&cm, res, res, entry);
+  }
+  // Convert back by multiplying by 1.
+  for (uint32_t j = 0; j < numLimbs; j++) {
+    entry[j] = j == 0;
+  }
+  montgomeryMul(&cm, res, res, entry);
+  condSubModulus(&cm, res);
+  storeConstModularResult(dest, &cm, width, secret);
+  freeConstModulus(&cm);
+}
+
 // Perform a smallnum multiplication.
 uint64_t runtime_smallnumMul(uint64_t a, uint64_t b, bool isSigned, bool secret) {
   if (secret) {
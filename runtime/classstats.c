@@ -0,0 +1,114 @@
+//  Copyright 2021 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Class introspection.  The compiler emits a table describing each class: its
+// name, reference width, the globals memory management uses, and its data
+// member columns.  The memory report has a line per class, giving the number of
+// objects used, allocated, and live, and the bytes of heap its columns use,
+// followed by a line per column.  For example:
+//
+//   Node: refWidth 32, used 3, allocated 4, live 2, 144 bytes
+//     nextFree u32: 32 bytes
+//     name string: 112 bytes
+
+#include "runtime.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const runtime_classInfo *runtime_classes;
+static uint64_t runtime_numClasses;
+
+// Register the class table.  Main calls this at startup.
+void runtime_setClassTable(const runtime_classInfo *classes, uint64_t numClasses) {
+  runtime_classes = classes;
+  runtime_numClasses = numClasses;
+}
+
+// Read one of a class's memory management globals.
+static uint64_t readClassGlobal(const void *global, uint32_t refWidth) {
+  if (refWidth <= 8) {
+    return *(const uint8_t*)global;
+  } else if (refWidth <= 16) {
+    return *(const uint16_t*)global;
+  } else if (refWidth <= 32) {
+    return *(const uint32_t*)global;
+  }
+  return *(const uint64_t*)global;
+}
+
+typedef struct {
+  char *text;
+  size_t len;
+  size_t allocated;
+} runtime_report;
+
+// Append formatted text to the report.
+static void reportPrintf(runtime_report *report, const char *format, ...) {
+  va_list ap;
+  va_start(ap, format);
+  int len = vsnprintf(NULL, 0, format, ap);
+  va_end(ap);
+  if (report->len + len + 1 > report->allocated) {
+    report->allocated = (report->len + len + 1) << 1;
+    report->text = realloc(report->text, report->allocated);
+    if (report->text == NULL) {
+      runtime_panicCstr("Out of memory in class stats");
+    }
+  }
+  va_start(ap, format);
+  vsnprintf(report->text + report->len, len + 1, format, ap);
+  va_end(ap);
+  report->len += len;
+}
+
+// Set |dest| to the memory report for all classes.
+void runtime_classStats(runtime_array *dest) {
+  runtime_report report = {NULL, 0, 0};
+  for (uint64_t i = 0; i < runtime_numClasses; i++) {
+    const runtime_classInfo *theClass = runtime_classes + i;
+    uint32_t refWidth = theClass->refWidth;
+    uint64_t used = readClassGlobal(theClass->used, refWidth);
+    uint64_t allocated = readClassGlobal(theClass->allocated, refWidth);
+    uint64_t firstFree = readClassGlobal(theClass->firstFree, refWidth);
+    uint64_t live = used;
+    if (theClass->numColumns != 0) {
+      const runtime_columnInfo *nextFree = theClass->columns;
+      live -= runtime_countFreeObjects(nextFree->array, nextFree->elementSize, refWidth, used,
+          firstFree);
+    }
+    uint64_t totalBytes = 0;
+    for (uint64_t j = 0; j < theClass->numColumns; j++) {
+      totalBytes += runtime_arrayHeapBytes(theClass->columns[j].array);
+    }
+    reportPrintf(&report, "%s: refWidth %u, used %llu, allocated %llu, live %llu, %llu bytes\n",
+        theClass->name, refWidth, (unsigned long long)used, (unsigned long long)allocated,
+        (unsigned long long)live, (unsigned long long)totalBytes);
+    for (uint64_t j = 0; j < theClass->numColumns; j++) {
+      const runtime_columnInfo *column = theClass->columns + j;
+      reportPrintf(&report, "  %s %s: %llu bytes\n", column->name, column->type,
+          (unsigned long long)runtime_arrayHeapBytes(column->array));
+    }
+  }
+  runtime_arrayInitCstr(dest, report.text != NULL? report.text : "");
+  free(report.text);
+}
+
+// Return the memory report.  This is callable from Rune through
+// builtin/externC.rn.
+void classStats(runtime_array *dest) {
+  runtime_classStats(dest);
+}
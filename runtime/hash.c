@@ -0,0 +1,383 @@
+//  Copyright 2021 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Cryptographic hash functions: SHA-256, HMAC-SHA256, and SHA3-256.  These
+// are constant time in the data, so they are safe to call on secrets.  The
+// length of the data is not secret.  On x86-64 CPUs with the SHA extensions,
+// SHA-256 compresses blocks with the SHA-NI instructions.
+
+#include "runtime.h"
+
+#include <string.h>
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+#define RN_SHA256_BLOCK_BYTES 64
+#define RN_SHA256_DIGEST_BYTES 32
+#define RN_SHA3_256_RATE_BYTES 136
+#define RN_SHA3_256_DIGEST_BYTES 32
+
+typedef struct {
+  uint32_t state[8];
+  uint8_t buffer[RN_SHA256_BLOCK_BYTES];
+  uint32_t bufferLen;
+  uint64_t totalLen;
+} sha256Context;
+
+typedef void (*sha256CompressFunc)(uint32_t *state, const uint8_t *data, uint64_t numBlocks);
+
+static const uint32_t sha256K[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static const uint32_t sha256InitialState[8] = {
+  0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+static const uint64_t keccakRoundConstants[24] = {
+  0x0000000000000001, 0x0000000000008082, 0x800000000000808a, 0x8000000080008000,
+  0x000000000000808b, 0x0000000080000001, 0x8000000080008081, 0x8000000000008009,
+  0x000000000000008a, 0x0000000000000088, 0x0000000080008009, 0x000000008000000a,
+  0x000000008000808b, 0x800000000000008b, 0x8000000000008089, 0x8000000000008003,
+  0x8000000000008002, 0x8000000000000080, 0x000000000000800a, 0x800000008000000a,
+  0x8000000080008081, 0x8000000000008080, 0x0000000080000001, 0x8000000080008008
+};
+
+// Rotation amounts and destination lanes of the rho and pi steps, in the
+// order lanes are visited starting from lane 1.
+static const uint8_t keccakRotations[24] = {
+  1, 3, 6, 10, 15, 21, 28, 36, 45, 55, 2, 14, 27, 41, 56, 8, 25, 43, 62, 18, 39, 61, 20, 44
+};
+static const uint8_t keccakPiLanes[24] = {
+  10, 7, 11, 17, 18, 3, 5, 16, 8, 21, 24, 4, 15, 23, 19, 13, 12, 2, 20, 14, 22, 9, 6, 1
+};
+
+static sha256CompressFunc sha256Compress = NULL;
+
+#define RN_ROTR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define RN_ROTL64(x, n) (((x) << (n)) | ((x) >> (64 - (n))))
+
+// Zero memory holding secrets, in a way the compiler will not optimize away.
+static void zeroSecret(void *p, size_t len) {
+  volatile uint8_t *q = p;
+  while (len--) {
+    *q++ = 0;
+  }
+}
+
+// Read a big-endian 32-bit word.
+static inline uint32_t loadBE32(const uint8_t *p) {
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+// Write a big-endian 32-bit word.
+static inline void storeBE32(uint8_t *p, uint32_t value) {
+  p[0] = value >> 24;
+  p[1] = value >> 16;
+  p[2] = value >> 8;
+  p[3] = value;
+}
+
+// Compress 64-byte blocks into the state, in portable C.
+static void sha256CompressPortable(uint32_t *state, const uint8_t *data, uint64_t numBlocks) {
+  uint32_t w[64];
+  while (numBlocks--) {
+    for (uint32_t i = 0; i < 16; i++) {
+      w[i] = loadBE32(data + 4*i);
+    }
+    for (uint32_t i = 16; i < 64; i++) {
+      uint32_t s0 = RN_ROTR32(w[i - 15], 7) ^ RN_ROTR32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+      uint32_t s1 = RN_ROTR32(w[i - 2], 17) ^ RN_ROTR32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (uint32_t i = 0; i < 64; i++) {
+      uint32_t s1 = RN_ROTR32(e, 6) ^ RN_ROTR32(e, 11) ^ RN_ROTR32(e, 25);
+      uint32_t ch = (e & f) ^ (~e & g);
+      uint32_t t1 = h + s1 + ch + sha256K[i] + w[i];
+      uint32_t s0 = RN_ROTR32(a, 2) ^ RN_ROTR32(a, 13) ^ RN_ROTR32(a, 22);
+      uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+      uint32_t t2 = s0 + maj;
+      h = g;
+      g = f;
+      f = e;
+      e = d + t1;
+      d = c;
+      c = b;
+      b = a;
+      a = t1 + t2;
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+    data += RN_SHA256_BLOCK_BYTES;
+  }
+  zeroSecret(w, sizeof(w));
+}
+
+#if defined(__x86_64__)
+// Compress 64-byte blocks into the state with the SHA-NI instructions.  Each
+// sha256rnds2 does two rounds, on the state split into ABEF and CDGH halves.
+__attribute__((target("sha,sse4.1")))
+static void sha256CompressShaNi(uint32_t *state, const uint8_t *data, uint64_t numBlocks) {
+  const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bull, 0x0405060700010203ull);
+  __m128i dcba = _mm_loadu_si128((const __m128i*)state);
+  __m128i hgfe = _mm_loadu_si128((const __m128i*)(state + 4));
+  __m128i cdab = _mm_shuffle_epi32(dcba, 0xb1);
+  __m128i efgh = _mm_shuffle_epi32(hgfe, 0x1b);
+  __m128i abef = _mm_alignr_epi8(cdab, efgh, 8);
+  __m128i cdgh = _mm_blend_epi16(efgh, cdab, 0xf0);
+  __m128i w[4];
+  while (numBlocks--) {
+    __m128i savedAbef = abef;
+    __m128i savedCdgh = cdgh;
+    for (uint32_t i = 0; i < 16; i++) {
+      __m128i msg;
+      if (i < 4) {
+        msg = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16*i)), byteSwap);
+      } else {
+        // w[i & 3] holds words 4i - 16 .. 4i - 13.
+        msg = _mm_sha256msg1_epu32(w[i & 3], w[(i + 1) & 3]);
+        msg = _mm_add_epi32(msg, _mm_alignr_epi8(w[(i + 3) & 3], w[(i + 2) & 3], 4));
+        msg = _mm_sha256msg2_epu32(msg, w[(i + 3) & 3]);
+      }
+      w[i & 3] = msg;
+      __m128i roundInput = _mm_add_epi32(msg, _mm_loadu_si128((const __m128i*)(sha256K + 4*i)));
+      cdgh = _mm_sha256rnds2_epu32(cdgh, abef, roundInput);
+      roundInput = _mm_shuffle_epi32(roundInput, 0x0e);
+      abef = _mm_sha256rnds2_epu32(abef, cdgh, roundInput);
+    }
+    abef = _mm_add_epi32(abef, savedAbef);
+    cdgh = _mm_add_epi32(cdgh, savedCdgh);
+    data += RN_SHA256_BLOCK_BYTES;
+  }
+  __m128i feba = _mm_shuffle_epi32(abef, 0x1b);
+  __m128i dchg = _mm_shuffle_epi32(cdgh, 0xb1);
+  _mm_storeu_si128((__m128i*)state, _mm_blend_epi16(feba, dchg, 0xf0));
+  _mm_storeu_si128((__m128i*)(state + 4), _mm_alignr_epi8(dchg, feba, 8));
+  w[0] = w[1] = w[2] = w[3] = _mm_setzero_si128();
+}
+
+// Return true if the CPU supports SHA-NI, and the SSSE3 and SSE4.1
+// instructions used to shuffle the state.
+static bool cpuHasShaNi(void) {
+  uint32_t eax, ebx, ecx, edx;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_SSSE3) || !(ecx & bit_SSE4_1)) {
+    return false;
+  }
+  if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+    return false;
+  }
+  return (ebx & bit_SHA) != 0;
+}
+#endif
+
+// Pick the fastest compression function this CPU supports.
+static sha256CompressFunc findSha256Compress(void) {
+  if (sha256Compress == NULL) {
+    sha256Compress = sha256CompressPortable;
+#if defined(__x86_64__)
+    if (cpuHasShaNi()) {
+      sha256Compress = sha256CompressShaNi;
+    }
+#endif
+  }
+  return sha256Compress;
+}
+
+static void sha256Init(sha256Context *ctx) {
+  memcpy(ctx->state, sha256InitialState, sizeof(ctx->state));
+  ctx->bufferLen = 0;
+  ctx->totalLen = 0;
+}
+
+// Hash more data.  Whole blocks are compressed directly from |data|.
+static void sha256Update(sha256Context *ctx, const uint8_t *data, uint64_t len) {
+  sha256CompressFunc compress = findSha256Compress();
+  ctx->totalLen += len;
+  if (ctx->bufferLen != 0) {
+    uint32_t needed = RN_SHA256_BLOCK_BYTES - ctx->bufferLen;
+    if (len < needed) {
+      memcpy(ctx->buffer + ctx->bufferLen, data, len);
+      ctx->bufferLen += len;
+      return;
+    }
+    memcpy(ctx->buffer + ctx->bufferLen, data, needed);
+    compress(ctx->state, ctx->buffer, 1);
+    data += needed;
+    len -= needed;
+    ctx->bufferLen = 0;
+  }
+  uint64_t numBlocks = len/RN_SHA256_BLOCK_BYTES;
+  if (numBlocks != 0) {
+    compress(ctx->state, data, numBlocks);
+    data += numBlocks*RN_SHA256_BLOCK_BYTES;
+    len -= numBlocks*RN_SHA256_BLOCK_BYTES;
+  }
+  memcpy(ctx->buffer, data, len);
+  ctx->bufferLen = len;
+}
+
+// Pad the message, and write the digest.  The context is zeroed.
+static void sha256Final(sha256Context *ctx, uint8_t *digest) {
+  uint64_t bitLen = ctx->totalLen*8;
+  uint8_t padding[2*RN_SHA256_BLOCK_BYTES] = {0x80};
+  uint32_t padLen = RN_SHA256_BLOCK_BYTES - ((ctx->bufferLen + 8) % RN_SHA256_BLOCK_BYTES);
+  for (uint32_t i = 0; i < 8; i++) {
+    padding[padLen + i] = bitLen >> (56 - 8*i);
+  }
+  sha256Update(ctx, padding, padLen + 8);
+  for (uint32_t i = 0; i < 8; i++) {
+    storeBE32(digest + 4*i, ctx->state[i]);
+  }
+  zeroSecret(ctx, sizeof(sha256Context));
+}
+
+// Apply the Keccak-f[1600] permutation.
+static void keccakPermute(uint64_t *lanes) {
+  uint64_t c[5];
+  for (uint32_t round = 0; round < 24; round++) {
+    // Theta.
+    for (uint32_t x = 0; x < 5; x++) {
+      c[x] = lanes[x] ^ lanes[x + 5] ^ lanes[x + 10] ^ lanes[x + 15] ^ lanes[x + 20];
+    }
+    for (uint32_t x = 0; x < 5; x++) {
+      uint64_t d = c[(x + 4) % 5] ^ RN_ROTL64(c[(x + 1) % 5], 1);
+      for (uint32_t y = 0; y < 25; y += 5) {
+        lanes[y + x] ^= d;
+      }
+    }
+    // Rho and pi.
+    uint64_t carry = lanes[1];
+    for (uint32_t i = 0; i < 24; i++) {
+      uint32_t lane = keccakPiLanes[i];
+      uint64_t next = lanes[lane];
+      lanes[lane] = RN_ROTL64(carry, keccakRotations[i]);
+      carry = next;
+    }
+    // Chi.
+    for (uint32_t y = 0; y < 25; y += 5) {
+      for (uint32_t x = 0; x < 5; x++) {
+        c[x] = lanes[y + x];
+      }
+      for (uint32_t x = 0; x < 5; x++) {
+        lanes[y + x] ^= ~c[(x + 1) % 5] & c[(x + 2) % 5];
+      }
+    }
+    // Iota.
+    lanes[0] ^= keccakRoundConstants[round];
+  }
+  zeroSecret(c, sizeof(c));
+}
+
+// XOR a little-endian byte into the lanes.
+static inline void keccakXorByte(uint64_t *lanes, uint32_t pos, uint8_t value) {
+  lanes[pos >> 3] ^= (uint64_t)value << (8*(pos & 7));
+}
+
+// Compute SHA3-256: Keccak with a 136-byte rate and the 01 domain suffix.
+static void sha3_256(uint8_t *digest, const uint8_t *data, uint64_t len) {
+  uint64_t lanes[25] = {0};
+  while (len >= RN_SHA3_256_RATE_BYTES) {
+    for (uint32_t i = 0; i < RN_SHA3_256_RATE_BYTES; i++) {
+      keccakXorByte(lanes, i, data[i]);
+    }
+    keccakPermute(lanes);
+    data += RN_SHA3_256_RATE_BYTES;
+    len -= RN_SHA3_256_RATE_BYTES;
+  }
+  for (uint32_t i = 0; i < len; i++) {
+    keccakXorByte(lanes, i, data[i]);
+  }
+  keccakXorByte(lanes, len, 0x06);
+  keccakXorByte(lanes, RN_SHA3_256_RATE_BYTES - 1, 0x80);
+  keccakPermute(lanes);
+  for (uint32_t i = 0; i < RN_SHA3_256_DIGEST_BYTES; i++) {
+    digest[i] = lanes[i >> 3] >> (8*(i & 7));
+  }
+  zeroSecret(lanes, sizeof(lanes));
+}
+
+// Size the destination string to hold a digest.
+static uint8_t *allocDigest(runtime_array *dest, uint32_t len) {
+  runtime_resizeArray(dest, len, sizeof(uint8_t), false);
+  return (uint8_t*)dest->data;
+}
+
+// Compute the SHA-256 digest of |data|.
+void runtime_sha256(runtime_array *dest, const runtime_array *data) {
+  sha256Context ctx;
+  uint8_t digest[RN_SHA256_DIGEST_BYTES];
+  sha256Init(&ctx);
+  sha256Update(&ctx, (const uint8_t*)data->data, data->numElements);
+  sha256Final(&ctx, digest);
+  memcpy(allocDigest(dest, RN_SHA256_DIGEST_BYTES), digest, RN_SHA256_DIGEST_BYTES);
+  zeroSecret(digest, sizeof(digest));
+}
+
+// Compute HMAC-SHA256, as in RFC 2104.  Keys longer than a block are hashed
+// first.
+void runtime_hmacSha256(runtime_array *dest, const runtime_array *key,
+    const runtime_array *message) {
+  uint8_t block[RN_SHA256_BLOCK_BYTES] = {0};
+  uint8_t innerDigest[RN_SHA256_DIGEST_BYTES];
+  sha256Context ctx;
+  if (key->numElements > RN_SHA256_BLOCK_BYTES) {
+    sha256Init(&ctx);
+    sha256Update(&ctx, (const uint8_t*)key->data, key->numElements);
+    sha256Final(&ctx, block);
+  } else {
+    memcpy(block, key->data, key->numElements);
+  }
+  for (uint32_t i = 0; i < RN_SHA256_BLOCK_BYTES; i++) {
+    block[i] ^= 0x36;
+  }
+  sha256Init(&ctx);
+  sha256Update(&ctx, block, RN_SHA256_BLOCK_BYTES);
+  sha256Update(&ctx, (const uint8_t*)message->data, message->numElements);
+  sha256Final(&ctx, innerDigest);
+  for (uint32_t i = 0; i < RN_SHA256_BLOCK_BYTES; i++) {
+    block[i] ^= 0x36 ^ 0x5c;
+  }
+  sha256Init(&ctx);
+  sha256Update(&ctx, block, RN_SHA256_BLOCK_BYTES);
+  sha256Update(&ctx, innerDigest, RN_SHA256_DIGEST_BYTES);
+  sha256Final(&ctx, allocDigest(dest, RN_SHA256_DIGEST_BYTES));
+  zeroSecret(block, sizeof(block));
+  zeroSecret(innerDigest, sizeof(innerDigest));
+}
+
+// Compute the SHA3-256 digest of |data|.
+void runtime_sha3(runtime_array *dest, const runtime_array *data) {
+  uint8_t digest[RN_SHA3_256_DIGEST_BYTES];
+  sha3_256(digest, (const uint8_t*)data->data, data->numElements);
+  memcpy(allocDigest(dest, RN_SHA3_256_DIGEST_BYTES), digest, RN_SHA3_256_DIGEST_BYTES);
+  zeroSecret(digest, sizeof(digest));
+}
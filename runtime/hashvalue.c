@@ -0,0 +1,143 @@
+//  Copyright 2021 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Fast seeded hashing for hash tables, in the style of wyhash.  Keys are mixed
+// 16 bytes at a time, 48 bytes per loop iteration, using 64x64->128 bit
+// multiplies.  The seed is random per process, so an attacker cannot choose
+// keys that collide.  Setting the RUNE_HASH_SEED environment variable to a
+// number fixes the seed, which makes iteration order repeatable for tests.
+// This is not a cryptographic hash, but its running time depends only on the
+// length of the data, so hashing a secret does not leak it through timing.
+
+#include "runtime.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const uint64_t runtime_hashSecret[4] = {
+  0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL, 0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL
+};
+
+static uint64_t runtime_hashSeed;
+static bool runtime_hashSeedSet;
+
+// Multiply two 64-bit values and fold the 128-bit product with xor.
+static inline uint64_t hashMix(uint64_t a, uint64_t b) {
+  __uint128_t product = (__uint128_t)a * b;
+  return (uint64_t)product ^ (uint64_t)(product >> 64);
+}
+
+// Return the per-process hash seed, choosing it on first use.
+static uint64_t getHashSeed(void) {
+  if (!runtime_hashSeedSet) {
+    const char *seedString = getenv("RUNE_HASH_SEED");
+    if (seedString != NULL && *seedString != '\0') {
+      runtime_hashSeed = strtoull(seedString, NULL, 0);
+    } else {
+      runtime_hashSeed = runtime_generateTrueRandomValue(64);
+    }
+    // Pre-mix the seed, so that no simple input relation cancels it.
+    runtime_hashSeed ^= hashMix(runtime_hashSeed ^ runtime_hashSecret[0], runtime_hashSecret[1]);
+    runtime_hashSeedSet = true;
+  }
+  return runtime_hashSeed;
+}
+
+static inline uint64_t load64(const uint8_t *p) {
+  uint64_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+static inline uint64_t load32(const uint8_t *p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+// Load 1 to 3 bytes, reading the first, middle and last.
+static inline uint64_t load3(const uint8_t *p, uint64_t len) {
+  return ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+}
+
+// Hash |len| bytes.
+uint64_t runtime_hashBytes(const uint8_t *data, uint64_t len) {
+  const uint64_t *secret = runtime_hashSecret;
+  uint64_t seed = getHashSeed();
+  const uint8_t *p = data;
+  uint64_t a, b;
+  if (len <= 16) {
+    if (len >= 4) {
+      uint64_t offset = (len >> 3) << 2;
+      a = (load32(p) << 32) | load32(p + offset);
+      b = (load32(p + len - 4) << 32) | load32(p + len - 4 - offset);
+    } else if (len > 0) {
+      a = load3(p, len);
+      b = 0;
+    } else {
+      a = b = 0;
+    }
+  } else {
+    uint64_t i = len;
+    if (i > 48) {
+      uint64_t seed1 = seed, seed2 = seed;
+      do {
+        seed = hashMix(load64(p) ^ secret[1], load64(p + 8) ^ seed);
+        seed1 = hashMix(load64(p + 16) ^ secret[2], load64(p + 24) ^ seed1);
+        seed2 = hashMix(load64(p + 32) ^ secret[3], load64(p + 40) ^ seed2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      seed ^= seed1 ^ seed2;
+    }
+    while (i > 16) {
+      seed = hashMix(load64(p) ^ secret[1], load64(p + 8) ^ seed);
+      p += 16;
+      i -= 16;
+    }
+    a = load64(p + i - 16);
+    b = load64(p + i - 8);
+  }
+  // The seed goes into both factors: otherwise a == secret[1] would zero the
+  // product under every seed.
+  return hashMix(secret[1] ^ len, hashMix(a ^ secret[1] ^ seed, b ^ seed));
+}
+
+// Hash the bytes of a string.
+uint64_t runtime_hashString(const runtime_array *string) {
+  return runtime_hashBytes((const uint8_t*)string->data, string->numElements);
+}
+
+// Hash a bigint.  The generated code hashes native integers as their value
+// sign or zero extended to runtime_maxWideIntWidth bits.  Bigints hash their
+// low words the same way, and mix in each higher word that differs from the
+// sign fill, so equal values hash the same whatever their widths.  The time
+// depends only on the width.
+uint64_t runtime_hashBigint(const runtime_array *bigint) {
+  uint32_t hashWords = runtime_maxWideIntWidth/64;
+  uint32_t numWords = (runtime_bigintWidth(bigint) + 63)/64;
+  if (numWords < hashWords) {
+    numWords = hashWords;
+  }
+  bool isSigned = runtime_bigintSigned(bigint);
+  uint64_t *words = calloc(numWords, sizeof(uint64_t));
+  runtime_bigintToWideInteger(words, bigint, 64*numWords, isSigned, false);
+  uint64_t fill = isSigned? -(words[numWords - 1] >> 63) : 0;
+  uint64_t hash = runtime_hashBytes((const uint8_t*)words, hashWords*sizeof(uint64_t));
+  for (uint32_t i = hashWords; i < numWords; i++) {
+    hash ^= hashMix(words[i] ^ fill, runtime_hashSecret[i & 3] ^ i);
+  }
+  free(words);
+  return hash;
+}
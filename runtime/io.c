@@ -22,6 +22,7 @@
 #include <stdarg.h>
 #include <stdio.h>  // For access to stdin and stdout.
 #include <stdlib.h>  // For exit.
+#include <string.h>
 #include <unistd.h>  // For getcwd.
 
 // Used in Linux for testing purposes.
@@ -463,9 +464,13 @@ static const uint8_t *findEndOfSpec(const uint8_t *p, uint32_t *elementSize, uin
     *elementSize = sizeof(runtime_array);
   } else if (c == 'i' || c == 'u' || c == 'x') {
     *width = readUint32(&p);
-    if (*width > sizeof(uint64_t) * 8) {
+    if (*width > runtime_maxWideIntWidth) {
       *elementSize = sizeof(runtime_array);
       return p;
+    } else if (*width > sizeof(uint64_t) * 8) {
+      // Wide integers are arrays of uint64_t, passed by reference.
+      *elementSize = ((*width + 63) / 64) * sizeof(uint64_t);
+      return p;
     } else {
       *deref = true;
     }
@@ -630,12 +635,22 @@ static const uint8_t *appendFormattedElement(runtime_array *array, bool topLevel
     uint8_t *typeStart = (uint8_t*)(p - 1);
     uint32_t width = readUint32(&p);
     // We can't print secrets, so this is a bigint based on size.
-    if (width > sizeof(uint64_t) * 8) {
+    if (width > runtime_maxWideIntWidth) {
       runtime_array buf = runtime_makeEmptyArray();
       runtime_array *bigint = va_arg(ap, runtime_array *);
       runtime_bigintToString(&buf, bigint, c == 'x' ? 16 : 10);
       runtime_concatArrays(array, &buf, sizeof(uint8_t), false);
       runtime_freeArray(&buf);
+    } else if (width > sizeof(uint64_t) * 8) {
+      // A wide integer, passed as a pointer to its uint64_t words.
+      runtime_array buf = runtime_makeEmptyArray();
+      runtime_array bigint = runtime_makeEmptyArray();
+      const uint64_t *words = va_arg(ap, const uint64_t *);
+      runtime_wideIntegerToBigint(&bigint, words, width, c == 'i', false);
+      runtime_bigintToString(&buf, &bigint, c == 'x' ? 16 : 10);
+      runtime_concatArrays(array, &buf, sizeof(uint8_t), false);
+      runtime_freeArray(&buf);
+      runtime_freeArray(&bigint);
     } else {
       bool isSigned = c == 'i';
       runtime_array buf = runtime_makeEmptyArray();
@@ -832,7 +847,8 @@ void runtime_nativeIntToString(runtime_array *string, uint64_t value, uint32_t b
   runtime_reverseArray(string, sizeof(uint8_t), false);
 }
 
-// Convert a bigint to ASCII, using the base.
+// Convert a secret bigint to ASCII, using the base.  This uses only the
+// constant-time bigint functions.
 //
 // def toDecimal(value, base):
 //   negative = value < 0
@@ -846,7 +862,7 @@ void runtime_nativeIntToString(runtime_array *string, uint64_t value, uint32_t b
 //     value = q
 //   print
 // 
-void runtime_bigintToString(runtime_array *string, runtime_array *bigint, uint32_t base) {
+static void secretBigintToString(runtime_array *string, runtime_array *bigint, uint32_t base) {
   runtime_freeArray(string);
   if (runtime_rnBoolToBool(runtime_bigintZero(bigint))) {
     uint8_t c = '0';
@@ -889,6 +905,144 @@ void runtime_bigintToString(runtime_array *string, runtime_array *bigint, uint32
   runtime_reverseArray(string, sizeof(uint8_t), false);
 }
 
+// Non-secret bigints are converted on their plain magnitude in 32-bit words,
+// rather than with the constant-time bigint functions.  Each pass divides the
+// magnitude by chunkBase, the largest power of the base that fits in a word, and
+// yields that many digits.  This is still quadratic in the number of words, but
+// does one single-word pass per several digits instead of a full-width
+// constant-time division per digit.  Power-of-two bases just slice the bits.
+
+// Drop leading zero words.
+static inline uint32_t trimWords(const uint32_t *words, uint32_t numWords) {
+  while (numWords != 0 && words[numWords - 1] == 0) {
+    numWords--;
+  }
+  return numWords;
+}
+
+// Divide the magnitude in place by a single word, and return the remainder.
+static uint32_t divideMagnitudeByWord(uint32_t *words, uint32_t numWords, uint32_t divisor) {
+  uint64_t rem = 0;
+  for (uint32_t i = numWords; i-- > 0;) {
+    uint64_t t = (rem << 32) | words[i];
+    words[i] = t/divisor;
+    rem = t % divisor;
+  }
+  return rem;
+}
+
+// Return the ASCII digit for a value less than 36.
+static inline uint8_t toDigit(uint32_t digit) {
+  return digit > 9? 'a' + digit - 10 : '0' + digit;
+}
+
+// Write the digits of the magnitude by repeated division by the chunk base.  The
+// magnitude is destroyed.
+static uint8_t *chunkedMagnitudeToDigits(uint8_t *p, uint32_t *words, uint32_t numWords,
+    uint32_t base) {
+  uint32_t chunkBase = base;
+  uint32_t chunkDigits = 1;
+  while ((uint64_t)chunkBase*base <= UINT32_MAX) {
+    chunkBase *= base;
+    chunkDigits++;
+  }
+  // Digits are generated least significant first, so write them at the end of a
+  // temporary buffer.  The chunk base is at least 2^16, so there are at most two
+  // chunks per word.
+  uint32_t maxDigits = (2*numWords + 1)*chunkDigits;
+  uint8_t *buf = malloc(maxDigits);
+  uint8_t *end = buf + maxDigits;
+  uint8_t *start = end;
+  while (numWords != 0) {
+    uint32_t chunk = divideMagnitudeByWord(words, numWords, chunkBase);
+    numWords = trimWords(words, numWords);
+    for (uint32_t i = 0; i < chunkDigits && (numWords != 0 || chunk != 0); i++) {
+      *--start = toDigit(chunk % base);
+      chunk /= base;
+    }
+  }
+  uint32_t len = end - start;
+  memcpy(p, start, len);
+  free(buf);
+  return p + len;
+}
+
+// Write the digits of the magnitude for a base that is a power of two, by
+// slicing bits.
+static uint8_t *powerOfTwoMagnitudeToDigits(uint8_t *p, const uint32_t *words,
+    uint32_t numWords, uint32_t base) {
+  uint32_t digitBits = __builtin_ctz(base);
+  uint32_t numBits = 32*numWords - __builtin_clz(words[numWords - 1]);
+  uint32_t numDigits = (numBits + digitBits - 1)/digitBits;
+  for (uint32_t i = numDigits; i-- > 0;) {
+    uint32_t bit = i*digitBits;
+    uint64_t window = words[bit >> 5];
+    if ((bit >> 5) + 1 < numWords) {
+      window |= (uint64_t)words[(bit >> 5) + 1] << 32;
+    }
+    *p++ = toDigit((window >> (bit & 0x1f)) & (base - 1));
+  }
+  return p;
+}
+
+// Convert a non-zero trimmed magnitude to digits, and return a pointer past the
+// last digit written.  The magnitude is destroyed.
+static uint8_t *bigMagnitudeToDigits(uint8_t *p, uint32_t *words, uint32_t numWords,
+    uint32_t base) {
+  if ((base & (base - 1)) == 0) {
+    return powerOfTwoMagnitudeToDigits(p, words, numWords, base);
+  }
+  return chunkedMagnitudeToDigits(p, words, numWords, base);
+}
+
+// Convert a bigint to ASCII, using the base, which must be from 2 to 36.
+void runtime_bigintToString(runtime_array *string, runtime_array *bigint, uint32_t base) {
+  if (runtime_bigintSecret(bigint)) {
+    secretBigintToString(string, bigint, base);
+    return;
+  }
+  if (runtime_rnBoolToBool(runtime_bigintZero(bigint))) {
+    runtime_arrayInitCstr(string, "0");
+    return;
+  }
+  bool negative = runtime_rnBoolToBool(runtime_bigintNegative(bigint));
+  runtime_array bytes = runtime_makeEmptyArray();
+  runtime_bigintEncodeLittleEndian(&bytes, bigint);
+  uint32_t numBytes = bytes.numElements;
+  const uint8_t *byteData = (const uint8_t*)bytes.data;
+  uint32_t numWords = (numBytes + 3)/4;
+  uint32_t *words = calloc(numWords + 1, sizeof(uint32_t));
+  for (uint32_t i = 0; i < numBytes; i++) {
+    words[i >> 2] |= (uint32_t)byteData[i] << (8*(i & 3));
+  }
+  runtime_freeArray(&bytes);
+  if (negative) {
+    // Take the two's complement of the sign-extended value to get the magnitude.
+    uint32_t signBits = 8*numBytes - 32*(numWords - 1);
+    if (signBits < 32) {
+      words[numWords - 1] |= ~(uint32_t)0 << signBits;
+    }
+    uint64_t carry = 1;
+    for (uint32_t i = 0; i < numWords; i++) {
+      uint64_t t = (uint64_t)(uint32_t)~words[i] + carry;
+      words[i] = t;
+      carry = t >> 32;
+    }
+  }
+  numWords = trimWords(words, numWords);
+  // A digit holds at least one bit, plus room for the sign.
+  uint8_t *buf = malloc(32*numWords + 1);
+  uint8_t *p = buf;
+  if (negative) {
+    *p++ = '-';
+  }
+  p = bigMagnitudeToDigits(p, words, numWords, base);
+  runtime_resizeArray(string, p - buf, sizeof(uint8_t), false);
+  memcpy(string->data, buf, p - buf);
+  free(buf);
+  free(words);
+}
+
 // Return a char* pointer to the string data.
 static inline char *getStringData(const runtime_array *string) {
   return (char*)(string->data);
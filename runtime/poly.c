@@ -0,0 +1,389 @@
+//  Copyright 2021 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Polynomial arithmetic in Z_q[x]/(x^n + 1) using the number theoretic
+// transform, as used by lattice cryptography.  The modulus q is an
+// NTT-friendly prime below 2^31 with 2n dividing q - 1, so there is a primitive
+// 2n-th root of unity psi.  Coefficients are u32 values in [0, q).
+//
+// All arithmetic is done in Montgomery form with R = 2^32, and is branch-free,
+// so secret coefficients are safe.  The twiddle factors are computed once by
+// runtime_polyNttTable, and passed to the other functions as a [u32] table.  On
+// x86-64, the butterflies and coefficient-wise operations run 8 lanes at a time
+// with AVX2 when the CPU supports it.
+
+#include "runtime.h"
+
+#include <string.h>
+
+// Layout of the table built by runtime_polyNttTable.
+#define RN_NTT_Q 0  // The modulus.
+#define RN_NTT_QINV 1  // -q^-1 mod 2^32.
+#define RN_NTT_LOGN 2  // log2(n).
+#define RN_NTT_R2 3  // R^2 mod q.
+#define RN_NTT_NINV 4  // R/n mod q, to scale the inverse transform.
+#define RN_NTT_HEADER_WORDS 5
+// The header is followed by n zetas: psi^bitrev(i)*R mod q.
+
+typedef struct {
+  uint32_t q;
+  uint32_t qinv;
+  uint32_t n;
+  uint32_t r2;
+  uint32_t ninv;
+  const uint32_t *zetas;
+} nttParams;
+
+// Return a*b*R^-1 mod q, where a*b < q*2^32.
+static inline uint32_t montMul(uint32_t a, uint32_t b, uint32_t q, uint32_t qinv) {
+  uint64_t product = (uint64_t)a*b;
+  uint32_t t = (uint32_t)product*qinv;
+  uint32_t r = (product + (uint64_t)t*q) >> 32;
+  return r - (q & -(uint32_t)(r >= q));
+}
+
+// Return a + b mod q.
+static inline uint32_t modAdd(uint32_t a, uint32_t b, uint32_t q) {
+  uint32_t r = a + b;
+  return r - (q & -(uint32_t)(r >= q));
+}
+
+// Return a - b mod q.
+static inline uint32_t modSub(uint32_t a, uint32_t b, uint32_t q) {
+  uint32_t r = a - b;
+  return r + (q & -(uint32_t)(a < b));
+}
+
+// Return a^e mod q, for building the table.
+static uint32_t modExp(uint32_t a, uint64_t e, uint32_t q) {
+  uint64_t result = 1;
+  uint64_t base = a % q;
+  while (e != 0) {
+    if (e & 1) {
+      result = result*base % q;
+    }
+    base = base*base % q;
+    e >>= 1;
+  }
+  return result;
+}
+
+// Reverse the low |bits| bits of |value|.
+static inline uint32_t bitReverse(uint32_t value, uint32_t bits) {
+  uint32_t result = 0;
+  for (uint32_t i = 0; i < bits; i++) {
+    result = (result << 1) | ((value >> i) & 1);
+  }
+  return result;
+}
+
+// Unpack a table built by runtime_polyNttTable.
+static nttParams readNttTable(const runtime_array *table) {
+  const uint32_t *data = (const uint32_t*)table->data;
+  if (table->numElements < RN_NTT_HEADER_WORDS) {
+    runtime_throwExceptionCstr("Invalid NTT table");
+  }
+  nttParams params;
+  params.q = data[RN_NTT_Q];
+  params.qinv = data[RN_NTT_QINV];
+  params.n = 1u << data[RN_NTT_LOGN];
+  params.r2 = data[RN_NTT_R2];
+  params.ninv = data[RN_NTT_NINV];
+  params.zetas = data + RN_NTT_HEADER_WORDS;
+  if (table->numElements != RN_NTT_HEADER_WORDS + params.n) {
+    runtime_throwExceptionCstr("Invalid NTT table");
+  }
+  return params;
+}
+
+// Copy the polynomial to dest, checking that it has n coefficients.
+static uint32_t *copyPolynomial(runtime_array *dest, const runtime_array *source, uint32_t n) {
+  if (source->numElements != n) {
+    runtime_throwExceptionCstr("Polynomial has %lu coefficients, but the NTT table is for %u",
+        (unsigned long)source->numElements, n);
+  }
+  if (dest != source) {
+    runtime_resizeArray(dest, n, sizeof(uint32_t), false);
+    memcpy(dest->data, source->data, n*sizeof(uint32_t));
+  }
+  return (uint32_t*)dest->data;
+}
+
+// The scalar versions of the kernels.  These handle the last layers of the
+// transforms, where butterflies are less than 8 coefficients apart.
+
+static void forwardLayerScalar(uint32_t *a, const nttParams *params, uint32_t len, uint32_t k) {
+  for (uint32_t start = 0; start < params->n; start += 2*len) {
+    uint32_t zeta = params->zetas[k++];
+    for (uint32_t j = start; j < start + len; j++) {
+      uint32_t t = montMul(zeta, a[j + len], params->q, params->qinv);
+      a[j + len] = modSub(a[j], t, params->q);
+      a[j] = modAdd(a[j], t, params->q);
+    }
+  }
+}
+
+static void inverseLayerScalar(uint32_t *a, const nttParams *params, uint32_t len, uint32_t k) {
+  for (uint32_t start = 0; start < params->n; start += 2*len) {
+    uint32_t zeta = params->q - params->zetas[--k];
+    for (uint32_t j = start; j < start + len; j++) {
+      uint32_t t = a[j];
+      a[j] = modAdd(t, a[j + len], params->q);
+      a[j + len] = montMul(zeta, modSub(t, a[j + len], params->q), params->q, params->qinv);
+    }
+  }
+}
+
+// Set dest[i] = montMul(a[i], b[i]) for i from |start| on.  If b is NULL,
+// multiply by |constant| instead.
+static void mulScalar(uint32_t *dest, const uint32_t *a, const uint32_t *b, uint32_t constant,
+    const nttParams *params, uint32_t start) {
+  for (uint32_t i = start; i < params->n; i++) {
+    dest[i] = montMul(a[i], b != NULL? b[i] : constant, params->q, params->qinv);
+  }
+}
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define RN_NTT_AVX2
+#include <immintrin.h>
+
+// Montgomery multiply 8 lanes.  _mm256_mul_epu32 multiplies the even 32-bit
+// lanes, so the odd lanes are shifted down and done separately.
+__attribute__((target("avx2")))
+static inline __m256i montMulAvx2(__m256i a, __m256i b, __m256i q, __m256i qinv) {
+  __m256i productEven = _mm256_mul_epu32(a, b);
+  __m256i productOdd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+  __m256i tEven = _mm256_mul_epu32(productEven, qinv);
+  __m256i tOdd = _mm256_mul_epu32(productOdd, qinv);
+  __m256i rEven = _mm256_srli_epi64(_mm256_add_epi64(productEven, _mm256_mul_epu32(tEven, q)), 32);
+  __m256i rOdd = _mm256_add_epi64(productOdd, _mm256_mul_epu32(tOdd, q));
+  __m256i r = _mm256_blend_epi32(rEven, rOdd, 0xaa);
+  // r < 2q, and if r < q, r - q wraps around to more than r.
+  return _mm256_min_epu32(r, _mm256_sub_epi32(r, q));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i modAddAvx2(__m256i a, __m256i b, __m256i q) {
+  __m256i r = _mm256_add_epi32(a, b);
+  return _mm256_min_epu32(r, _mm256_sub_epi32(r, q));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i modSubAvx2(__m256i a, __m256i b, __m256i q) {
+  __m256i r = _mm256_sub_epi32(a, b);
+  return _mm256_min_epu32(r, _mm256_add_epi32(r, q));
+}
+
+__attribute__((target("avx2")))
+static void forwardLayerAvx2(uint32_t *a, const nttParams *params, uint32_t len, uint32_t k) {
+  __m256i q = _mm256_set1_epi32(params->q);
+  __m256i qinv = _mm256_set1_epi32(params->qinv);
+  for (uint32_t start = 0; start < params->n; start += 2*len) {
+    __m256i zeta = _mm256_set1_epi32(params->zetas[k++]);
+    for (uint32_t j = start; j < start + len; j += 8) {
+      __m256i x = _mm256_loadu_si256((const __m256i*)(a + j));
+      __m256i y = _mm256_loadu_si256((const __m256i*)(a + j + len));
+      __m256i t = montMulAvx2(zeta, y, q, qinv);
+      _mm256_storeu_si256((__m256i*)(a + j + len), modSubAvx2(x, t, q));
+      _mm256_storeu_si256((__m256i*)(a + j), modAddAvx2(x, t, q));
+    }
+  }
+}
+
+__attribute__((target("avx2")))
+static void inverseLayerAvx2(uint32_t *a, const nttParams *params, uint32_t len, uint32_t k) {
+  __m256i q = _mm256_set1_epi32(params->q);
+  __m256i qinv = _mm256_set1_epi32(params->qinv);
+  for (uint32_t start = 0; start < params->n; start += 2*len) {
+    __m256i zeta = _mm256_set1_epi32(params->q - params->zetas[--k]);
+    for (uint32_t j = start; j < start + len; j += 8) {
+      __m256i x = _mm256_loadu_si256((const __m256i*)(a + j));
+      __m256i y = _mm256_loadu_si256((const __m256i*)(a + j + len));
+      _mm256_storeu_si256((__m256i*)(a + j), modAddAvx2(x, y, q));
+      _mm256_storeu_si256((__m256i*)(a + j + len), montMulAvx2(zeta, modSubAvx2(x, y, q), q, qinv));
+    }
+  }
+}
+
+// Return the number of coefficients done, which is a multiple of 8.
+__attribute__((target("avx2")))
+static uint32_t mulAvx2(uint32_t *dest, const uint32_t *a, const uint32_t *b, uint32_t constant,
+    const nttParams *params) {
+  __m256i q = _mm256_set1_epi32(params->q);
+  __m256i qinv = _mm256_set1_epi32(params->qinv);
+  __m256i c = _mm256_set1_epi32(constant);
+  uint32_t i;
+  for (i = 0; i + 8 <= params->n; i += 8) {
+    __m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+    __m256i y = b != NULL? _mm256_loadu_si256((const __m256i*)(b + i)) : c;
+    _mm256_storeu_si256((__m256i*)(dest + i), montMulAvx2(x, y, q, qinv));
+  }
+  return i;
+}
+
+// Return true if the CPU supports AVX2.
+static bool useAvx2(void) {
+  static int supported = -1;
+  if (supported < 0) {
+    __builtin_cpu_init();
+    supported = __builtin_cpu_supports("avx2");
+  }
+  return supported;
+}
+#endif  // RN_NTT_AVX2
+
+// Set dest[i] = a[i]*b[i]*R^-1 mod q, or a[i]*constant*R^-1 if b is NULL.
+static void mulCoefficients(uint32_t *dest, const uint32_t *a, const uint32_t *b,
+    uint32_t constant, const nttParams *params) {
+  uint32_t start = 0;
+#ifdef RN_NTT_AVX2
+  if (useAvx2()) {
+    start = mulAvx2(dest, a, b, constant, params);
+  }
+#endif
+  mulScalar(dest, a, b, constant, params, start);
+}
+
+// Transform a in place.  The result is in bit-reversed order.
+static void forwardNtt(uint32_t *a, const nttParams *params) {
+  uint32_t k = 1;
+  for (uint32_t len = params->n >> 1; len > 0; len >>= 1) {
+#ifdef RN_NTT_AVX2
+    if (len >= 8 && useAvx2()) {
+      forwardLayerAvx2(a, params, len, k);
+      k += params->n/(2*len);
+      continue;
+    }
+#endif
+    forwardLayerScalar(a, params, len, k);
+    k += params->n/(2*len);
+  }
+}
+
+// Invert forwardNtt in place.
+static void inverseNtt(uint32_t *a, const nttParams *params) {
+  uint32_t k = params->n;
+  for (uint32_t len = 1; len < params->n; len <<= 1) {
+#ifdef RN_NTT_AVX2
+    if (len >= 8 && useAvx2()) {
+      inverseLayerAvx2(a, params, len, k);
+      k -= params->n/(2*len);
+      continue;
+    }
+#endif
+    inverseLayerScalar(a, params, len, k);
+    k -= params->n/(2*len);
+  }
+  mulCoefficients(a, a, NULL, params->ninv, params);
+}
+
+// Build the twiddle table for polynomials of n coefficients mod the prime q.
+void runtime_polyNttTable(runtime_array *table, uint32_t q, uint64_t n) {
+  if (n < 2 || (n & (n - 1)) != 0 || n > (1u << 30)) {
+    runtime_throwExceptionCstr("NTT size must be a power of 2");
+  }
+  if ((q & 1) == 0 || q >= (1u << 31) || (q - 1) % (2*n) != 0) {
+    runtime_throwExceptionCstr("NTT modulus must be an odd prime < 2^31 with 2n dividing q - 1");
+  }
+  // Find psi with psi^n == -1, so it is a primitive 2n-th root of unity.
+  uint32_t psi = 0;
+  for (uint32_t g = 2; g < q; g++) {
+    uint32_t candidate = modExp(g, (q - 1)/(2*n), q);
+    if (modExp(candidate, n, q) == q - 1) {
+      psi = candidate;
+      break;
+    }
+  }
+  if (psi == 0) {
+    runtime_throwExceptionCstr("No primitive root of unity found: is the NTT modulus prime?");
+  }
+  uint32_t logn = __builtin_ctzll(n);
+  runtime_resizeArray(table, RN_NTT_HEADER_WORDS + n, sizeof(uint32_t), false);
+  uint32_t *data = (uint32_t*)table->data;
+  uint32_t x = q;
+  // Newton's iteration doubles the correct low bits of q^-1 each step.
+  for (uint32_t i = 0; i < 4; i++) {
+    x *= 2 - q*x;
+  }
+  uint64_t r = ((uint64_t)1 << 32) % q;
+  data[RN_NTT_Q] = q;
+  data[RN_NTT_QINV] = -x;
+  data[RN_NTT_LOGN] = logn;
+  data[RN_NTT_R2] = r*r % q;
+  data[RN_NTT_NINV] = r*modExp(n % q, q - 2, q) % q;
+  uint32_t *zetas = data + RN_NTT_HEADER_WORDS;
+  for (uint32_t i = 0; i < n; i++) {
+    zetas[i] = modExp(psi, bitReverse(i, logn), q)*r % q;
+  }
+}
+
+// Compute the forward NTT of the polynomial a.
+void runtime_polyNtt(runtime_array *dest, const runtime_array *a, const runtime_array *table) {
+  nttParams params = readNttTable(table);
+  uint32_t *data = copyPolynomial(dest, a, params.n);
+  forwardNtt(data, &params);
+}
+
+// Compute the inverse NTT of a.
+void runtime_polyInverseNtt(runtime_array *dest, const runtime_array *a,
+    const runtime_array *table) {
+  nttParams params = readNttTable(table);
+  uint32_t *data = copyPolynomial(dest, a, params.n);
+  inverseNtt(data, &params);
+}
+
+// Multiply the NTTs a and b coefficient-wise.
+void runtime_polyPointwiseMul(runtime_array *dest, const runtime_array *a,
+    const runtime_array *b, const runtime_array *table) {
+  nttParams params = readNttTable(table);
+  if (b->numElements != params.n) {
+    runtime_throwExceptionCstr("Polynomials have different numbers of coefficients");
+  }
+  runtime_array temp = runtime_makeEmptyArray();
+  uint32_t *data = copyPolynomial(&temp, a, params.n);
+  // montMul divides by R, so multiply by R^2 to cancel both reductions.
+  mulCoefficients(data, data, (const uint32_t*)b->data, 0, &params);
+  mulCoefficients(data, data, NULL, params.r2, &params);
+  runtime_moveArray(dest, &temp);
+}
+
+// Multiply polynomials a and b mod x^n + 1 in O(n log n) time.
+void runtime_polyMul(runtime_array *dest, const runtime_array *a, const runtime_array *b,
+    const runtime_array *table) {
+  nttParams params = readNttTable(table);
+  runtime_array aHat = runtime_makeEmptyArray();
+  runtime_array bHat = runtime_makeEmptyArray();
+  uint32_t *aData = copyPolynomial(&aHat, a, params.n);
+  uint32_t *bData = copyPolynomial(&bHat, b, params.n);
+  forwardNtt(aData, &params);
+  forwardNtt(bData, &params);
+  // Fold the R^2 correction into b, and the two R^-1 factors from the products
+  // cancel it.
+  mulCoefficients(bData, bData, NULL, params.r2, &params);
+  mulCoefficients(aData, aData, bData, 0, &params);
+  inverseNtt(aData, &params);
+  runtime_freeArray(&bHat);
+  runtime_moveArray(dest, &aHat);
+}
+
+// Reduce each coefficient, which may be any u32 value, mod q.
+void runtime_polyReduce(runtime_array *dest, const runtime_array *a, const runtime_array *table) {
+  nttParams params = readNttTable(table);
+  runtime_array temp = runtime_makeEmptyArray();
+  uint32_t *data = copyPolynomial(&temp, a, params.n);
+  // a*R^2*R^-1 is a*R mod q, and one more reduction removes R.
+  mulCoefficients(data, data, NULL, params.r2, &params);
+  mulCoefficients(data, data, NULL, 1, &params);
+  runtime_moveArray(dest, &temp);
+}
@@ -0,0 +1,82 @@
+//  Copyright 2021 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Field access profiling.  When compiled with -profgen, a Rune program counts
+// each load and store of a class data member in a counter per access site,
+// where a site is a (column, member, function, load/store) tuple.  The
+// compiler passes the site descriptions, one per line, and the counters, and
+// the profile is written when the program exits.  Each line of the profile is
+// a site description followed by a tab and its count.
+
+#include "runtime.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+  const char *fileName;
+  const char *sites;
+  uint64_t **counters;
+  uint64_t numSites;
+  bool atExitRegistered;
+} runtime_fieldProfileState;
+
+static runtime_fieldProfileState runtime_fieldProfile;
+
+// Write the profile at exit.
+static void writeFieldProfileAtExit(void) {
+  runtime_writeFieldProfile();
+}
+
+// Start profiling field accesses.  |sites| holds |numSites| newline terminated
+// site descriptions, and |counters| holds a pointer to each site's counter.  A
+// NULL |fileName| stops profiling.
+void runtime_startFieldProfile(const char *fileName, const char *sites, uint64_t **counters,
+    uint64_t numSites) {
+  runtime_fieldProfile.fileName = fileName;
+  runtime_fieldProfile.sites = sites;
+  runtime_fieldProfile.counters = counters;
+  runtime_fieldProfile.numSites = numSites;
+  if (!runtime_fieldProfile.atExitRegistered) {
+    if (atexit(writeFieldProfileAtExit) != 0) {
+      runtime_panicCstr("Unable to register field profile writer");
+    }
+    runtime_fieldProfile.atExitRegistered = true;
+  }
+}
+
+// Write the field access profile.  This is called at exit, but can be called
+// earlier to take a snapshot.
+void runtime_writeFieldProfile(void) {
+  if (runtime_fieldProfile.fileName == NULL) {
+    return;
+  }
+  FILE *file = fopen(runtime_fieldProfile.fileName, "w");
+  if (file == NULL) {
+    fprintf(stderr, "Unable to write field profile %s\n", runtime_fieldProfile.fileName);
+    return;
+  }
+  const char *site = runtime_fieldProfile.sites;
+  for (uint64_t i = 0; i < runtime_fieldProfile.numSites; i++) {
+    const char *end = strchr(site, '\n');
+    if (end == NULL) {
+      break;
+    }
+    fprintf(file, "%.*s\t%llu\n", (int)(end - site), site,
+        (unsigned long long)*runtime_fieldProfile.counters[i]);
+    site = end + 1;
+  }
+  fclose(file);
+}
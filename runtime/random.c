@@ -12,31 +12,162 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+// A ChaCha20-based CPRNG, seeded with the getrandom syscall.  Keystream is
+// generated a buffer at a time, and the first 32 bytes of each buffer replace
+// the key, so earlier output cannot be recovered from the state.  Bytes are
+// zeroed as they are handed out.  The state is discarded in the child after
+// fork, so parent and child never share output.
+
+#define _GNU_SOURCE  // For getrandom.
 #include "runtime.h"
+
+#include <errno.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/random.h>
+
+#define RN_CHACHA_BLOCK_BYTES 64
+#define RN_RANDOM_BUFFER_BYTES (16*RN_CHACHA_BLOCK_BYTES)
+#define RN_RANDOM_KEY_BYTES 32
+// Reseed from the kernel after this many bytes of output.
+#define RN_RANDOM_RESEED_BYTES (1u << 20)
+
+typedef struct {
+  uint32_t key[RN_RANDOM_KEY_BYTES/sizeof(uint32_t)];
+  uint8_t buffer[RN_RANDOM_BUFFER_BYTES];
+  uint32_t available;  // Unused bytes at the end of buffer.
+  uint64_t bytesSinceSeed;
+  bool seeded;
+} runtime_randomState;
+
+static runtime_randomState runtime_random;
+static bool runtime_randomAtForkRegistered = false;
+
+#define RN_ROTL32(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+#define RN_QUARTER_ROUND(a, b, c, d) \
+  a += b; d ^= a; d = RN_ROTL32(d, 16); \
+  c += d; b ^= c; b = RN_ROTL32(b, 12); \
+  a += b; d ^= a; d = RN_ROTL32(d, 8); \
+  c += d; b ^= c; b = RN_ROTL32(b, 7)
+
+// Write one little-endian 32-bit word.
+static inline void storeLE32(uint8_t *dest, uint32_t value) {
+  dest[0] = value;
+  dest[1] = value >> 8;
+  dest[2] = value >> 16;
+  dest[3] = value >> 24;
+}
 
-// Read from /dev/urandom.
+// Compute a ChaCha20 block, as in RFC 8439, with a zero nonce.
+static void chacha20Block(uint8_t *dest, const uint32_t *key, uint32_t counter) {
+  uint32_t state[16] = {
+    0x61707865, 0x3320646e, 0x79622d32, 0x6b206574,
+    key[0], key[1], key[2], key[3], key[4], key[5], key[6], key[7],
+    counter, 0, 0, 0
+  };
+  uint32_t x[16];
+  memcpy(x, state, sizeof(x));
+  for (uint32_t i = 0; i < 10; i++) {
+    RN_QUARTER_ROUND(x[0], x[4], x[8], x[12]);
+    RN_QUARTER_ROUND(x[1], x[5], x[9], x[13]);
+    RN_QUARTER_ROUND(x[2], x[6], x[10], x[14]);
+    RN_QUARTER_ROUND(x[3], x[7], x[11], x[15]);
+    RN_QUARTER_ROUND(x[0], x[5], x[10], x[15]);
+    RN_QUARTER_ROUND(x[1], x[6], x[11], x[12]);
+    RN_QUARTER_ROUND(x[2], x[7], x[8], x[13]);
+    RN_QUARTER_ROUND(x[3], x[4], x[9], x[14]);
+  }
+  for (uint32_t i = 0; i < 16; i++) {
+    storeLE32(dest + 4*i, x[i] + state[i]);
+  }
+}
+
+// Forget the state in the child after fork.
+static void forgetRandomState(void) {
+  memset(&runtime_random, 0, sizeof(runtime_random));
+}
 
-static FILE *deUrandomFile = NULL;
+// Fill the buffer from the kernel's random number generator.  Fall back on
+// /dev/urandom if the getrandom syscall is not available.
+static void readKernelRandomBytes(uint8_t *dest, size_t numBytes) {
+  while (numBytes != 0) {
+    ssize_t len = getrandom(dest, numBytes, 0);
+    if (len < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno != ENOSYS) {
+        runtime_panicCstr("Unable to read from getrandom!");
+      }
+      FILE *file = fopen("/dev/urandom", "r");
+      if (file == NULL) {
+        runtime_panicCstr("Unable to open /dev/urandom!");
+      }
+      if (fread(dest, numBytes, 1, file) != 1) {
+        runtime_panicCstr("Unable to read from /dev/urandom!");
+      }
+      fclose(file);
+      return;
+    }
+    dest += len;
+    numBytes -= len;
+  }
+}
 
-// Open /dev/urandom.
-static inline void openUrandom(void) {
-  if (deUrandomFile == NULL) {
-    deUrandomFile = fopen("/dev/urandom", "r");
-    if (deUrandomFile == NULL) {
-      runtime_panicCstr("Unable to open /dev/urandom!");
+// Seed the key from the kernel.
+static void seedRandomState(void) {
+  if (!runtime_randomAtForkRegistered) {
+    if (pthread_atfork(NULL, NULL, forgetRandomState) != 0) {
+      runtime_panicCstr("Unable to register fork handler for random state");
     }
+    runtime_randomAtForkRegistered = true;
+  }
+  readKernelRandomBytes((uint8_t*)runtime_random.key, RN_RANDOM_KEY_BYTES);
+  runtime_random.available = 0;
+  runtime_random.bytesSinceSeed = 0;
+  runtime_random.seeded = true;
+}
+
+// Generate a new buffer of keystream, and replace the key with the first 32
+// bytes of it.
+static void refillRandomBuffer(void) {
+  if (!runtime_random.seeded || runtime_random.bytesSinceSeed >= RN_RANDOM_RESEED_BYTES) {
+    seedRandomState();
+  }
+  for (uint32_t i = 0; i < RN_RANDOM_BUFFER_BYTES/RN_CHACHA_BLOCK_BYTES; i++) {
+    chacha20Block(runtime_random.buffer + i*RN_CHACHA_BLOCK_BYTES, runtime_random.key, i);
+  }
+  memcpy(runtime_random.key, runtime_random.buffer, RN_RANDOM_KEY_BYTES);
+  memset(runtime_random.buffer, 0, RN_RANDOM_KEY_BYTES);
+  runtime_random.available = RN_RANDOM_BUFFER_BYTES - RN_RANDOM_KEY_BYTES;
+}
+
+// Copy random bytes to |dest|, zeroing them in the buffer.
+static void generateRandomBytes(uint8_t *dest, uint64_t numBytes) {
+  while (numBytes != 0) {
+    if (runtime_random.available == 0) {
+      refillRandomBuffer();
+    }
+    uint32_t len = runtime_random.available;
+    if (len > numBytes) {
+      len = numBytes;
+    }
+    uint8_t *source = runtime_random.buffer + RN_RANDOM_BUFFER_BYTES - runtime_random.available;
+    memcpy(dest, source, len);
+    memset(source, 0, len);
+    runtime_random.available -= len;
+    runtime_random.bytesSinceSeed += len;
+    dest += len;
+    numBytes -= len;
   }
 }
 
 // Generate random bits.
 uint64_t runtime_generateTrueRandomValue(uint32_t width) {
-  openUrandom();
   uint64_t bits;
-  if (fread(&bits, sizeof(bits), 1, deUrandomFile) != 1) {
-    runtime_panicCstr("Unable to read from /dev/urandom!");
-  }
+  generateRandomBytes((uint8_t*)&bits, sizeof(bits));
   if (width < sizeof(uint64_t) * 8) {
     bits = bits & (((uint64_t)1 << width) - 1);
   }
@@ -45,8 +176,18 @@ uint64_t runtime_generateTrueRandomValue(uint32_t width) {
 
 // Generate a random bigint.
 void runtime_generateTrueRandomBytes(uint8_t *dest, uint64_t numBytes) {
-  openUrandom();
-  if (fread(dest, numBytes, 1, deUrandomFile) != 1) {
-    runtime_panicCstr("Unable to read from /dev/urandom!");
-  }
+  generateRandomBytes(dest, numBytes);
+}
+
+// Return a string of |len| random bytes.
+void runtime_randString(runtime_array *dest, uint64_t len) {
+  runtime_resizeArray(dest, len, sizeof(uint8_t), false);
+  generateRandomBytes((uint8_t*)dest->data, len);
+}
+
+// Return an array of |numBytes| random bytes.  This is callable from Rune
+// through builtin/externC.rn.
+void randBytes(runtime_array *dest, uint64_t numBytes) {
+  runtime_resizeArray(dest, numBytes, sizeof(uint8_t), false);
+  generateRandomBytes((uint8_t*)dest->data, numBytes);
 }
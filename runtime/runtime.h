@@ -28,10 +28,14 @@
 
 #include "cttk.h"  // For cttk_bool.
 
-// Integers larger than this are represented as CTTK bigints.  Otherwise, they
-// are passed by value on the stack.
+// Integers up to this width are passed to the runtime by value as uint64_t.
 #define runtime_maxNativeIntWidth (sizeof(uint64_t)*8)
 
+// Integers wider than runtime_maxNativeIntWidth, up to this width, are native
+// LLVM integers, passed to the runtime as pointers to arrays of uint64_t.  Wider
+// integers are represented as CTTK bigints.  This is set by main at startup.
+extern uint32_t runtime_maxWideIntWidth;
+
 #define RN_SIZET_MASK                   \
   (sizeof(size_t) == 4 ? (uint32_t)0x3u \
                        : (sizeof(size_t) == 8 ? (uint32_t)0x7 : UINT32_MAX))
@@ -48,6 +52,8 @@ typedef enum {
   RN_INT,
   RN_FLOAT,
   RN_DOUBLE,
+  RN_WIDE_UINT,  // Wide integers are arrays of uint64_t.
+  RN_WIDE_INT,
 } runtime_type;
 
 // Comparison operator types.
@@ -79,7 +85,8 @@ typedef struct {
                    // initialized.
 #endif
   bool hasSubArrays: 1;
-  size_t allocatedWords : sizeof(size_t) * 8 - 1;
+  bool isStripe: 1;  // The data is a stripe of a shared allocation.  See runtime_resizeColumns.
+  size_t allocatedWords : sizeof(size_t) * 8 - 2;
   runtime_array *backPointer;
 } runtime_heapHeader;
 
@@ -99,6 +106,14 @@ void runtime_allocArray(runtime_array *array, size_t numElements, size_t element
 void runtime_arrayInitCstr(runtime_array *array, const char *text);
 void runtime_resizeArray(runtime_array *array, uint64_t numElements, size_t elementSize,
     bool hasSubArrays);
+void runtime_resizeColumns(runtime_array **columns, const size_t *elementSizes,
+    const uint8_t *hasSubArrays, size_t numColumns, uint64_t numElements);
+uint64_t runtime_compactColumns(runtime_array **columns, const size_t *elementSizes,
+    const uint8_t *hasSubArrays, size_t numColumns, uint64_t used, uint64_t firstFree,
+    uint32_t refWidth, runtime_array *newIds);
+void runtime_remapReferences(runtime_array *array, const size_t *path, uint32_t depth,
+    size_t refSize, uint32_t refWidth, uint64_t numElements, const runtime_array *newIds);
+uint64_t runtime_remapReference(uint64_t ref, uint32_t refWidth, const runtime_array *newIds);
 void runtime_copyArray(runtime_array *dest, runtime_array *source, size_t elementSize,
     bool hasSubArrays);
 void runtime_moveArray(runtime_array *dest, runtime_array *source);
@@ -107,6 +122,9 @@ void runtime_sliceArray(runtime_array *dest, runtime_array *source, uint64_t low
 void runtime_freeArray(runtime_array *array);
 void runtime_foreachArrayObject(runtime_array *array, void *callback, uint32_t refWidth,
     uint32_t depth);
+uint64_t runtime_countFreeObjects(const runtime_array *nextFree, size_t refSize,
+    uint32_t refWidth, uint64_t used, uint64_t firstFree);
+uint64_t runtime_arrayHeapBytes(const runtime_array *array);
 void runtime_updateArrayBackPointer(runtime_array *array);
 void runtime_compactArrayHeap(void);
 void runtime_appendArrayElement(runtime_array *array, uint8_t *data, size_t elementSize,
@@ -115,6 +133,7 @@ void runtime_concatArrays(runtime_array *dest, runtime_array *source, size_t ele
     bool hasSubArrays);
 void runtime_xorStrings(runtime_array *dest, runtime_array *a, runtime_array *b);
 void runtime_reverseArray(runtime_array *array, size_t elementSize, bool hasSubArrays);
+uint64_t runtime_secretLookup(const runtime_array *array, uint64_t index, size_t elementSize);
 bool runtime_compareArrays(runtime_comparisonType compareType, runtime_type elementType,
     const runtime_array *a, const runtime_array *b, size_t elementSize,
     bool hasSubArrays, bool secret);
@@ -150,13 +169,69 @@ void runtime_nativeIntToString(runtime_array *string, uint64_t value, uint32_t b
 void runtime_bigintToString(runtime_array *string, runtime_array *bigint, uint32_t base);
 void runtime_stringToHex(runtime_array *destHexString, const runtime_array *sourceBinString);
 void runtime_hexToString(runtime_array *destBinString, const runtime_array *sourceHexString);
+
+// Cryptographic hashes.  These are constant time, and safe to call on secrets.
+void runtime_sha256(runtime_array *dest, const runtime_array *data);
+void runtime_hmacSha256(runtime_array *dest, const runtime_array *key,
+    const runtime_array *message);
+void runtime_sha3(runtime_array *dest, const runtime_array *data);
+
+// Fast seeded hashes for hash tables.  These are not cryptographic.
+uint64_t runtime_hashBytes(const uint8_t *data, uint64_t len);
+uint64_t runtime_hashString(const runtime_array *string);
+uint64_t runtime_hashBigint(const runtime_array *bigint);
+
+// Polynomials mod (x^n + 1, q), transformed with the NTT.  The table holds the
+// modulus and twiddle factors.
+void runtime_polyNttTable(runtime_array *table, uint32_t q, uint64_t n);
+void runtime_polyNtt(runtime_array *dest, const runtime_array *a, const runtime_array *table);
+void runtime_polyInverseNtt(runtime_array *dest, const runtime_array *a,
+    const runtime_array *table);
+void runtime_polyPointwiseMul(runtime_array *dest, const runtime_array *a,
+    const runtime_array *b, const runtime_array *table);
+void runtime_polyMul(runtime_array *dest, const runtime_array *a, const runtime_array *b,
+    const runtime_array *table);
+void runtime_polyReduce(runtime_array *dest, const runtime_array *a, const runtime_array *table);
 uint64_t runtime_stringFind(const runtime_array *haystack, const runtime_array *needle, uint64_t offset);
 uint64_t runtime_stringRfind(const runtime_array *haystack, const runtime_array *needle, uint64_t offset);
 
-// Interface to TRNG.  On Linux, this should be a CPRNG initialized from
-// /dev/urandom, or even better, using the getrandom syscall.
+// Field access profiling, enabled with the -profgen compiler flag.
+void runtime_startFieldProfile(const char *fileName, const char *sites, uint64_t **counters,
+    uint64_t numSites);
+void runtime_writeFieldProfile(void);
+
+// Class introspection.  The compiler describes each class's data member
+// columns, and main registers the table at startup.  Members in a field group
+// share a column, and their names are separated by commas.  The first column is
+// always the class's nextFree array.
+typedef struct {
+  const char *name;
+  const char *type;
+  runtime_array *array;
+  uint64_t elementSize;
+} runtime_columnInfo;
+
+typedef struct {
+  const char *name;
+  uint32_t refWidth;
+  uint64_t numColumns;
+  const runtime_columnInfo *columns;
+  // The class's _used, _allocated, and _firstFree globals, refWidth bits each.
+  const void *used;
+  const void *allocated;
+  const void *firstFree;
+} runtime_classInfo;
+
+void runtime_setClassTable(const runtime_classInfo *classes, uint64_t numClasses);
+void runtime_classStats(runtime_array *dest);
+void classStats(runtime_array *dest);
+
+// Interface to the CPRNG, a buffered ChaCha20 keystream seeded with the
+// getrandom syscall.
 uint64_t runtime_generateTrueRandomValue(uint32_t width);
 void runtime_generateTrueRandomBytes(uint8_t *dest, uint64_t numBytes);
+void runtime_randString(runtime_array *dest, uint64_t len);
+void randBytes(runtime_array *dest, uint64_t numBytes);
 
 // Small integer exponentiation, with overflow checking.
 
@@ -234,6 +309,15 @@ void runtime_bigintSet(runtime_array *dest, runtime_array *source);
 void runtime_integerToBigint(runtime_array *dest, uint64_t value, uint32_t width, bool isSigned, bool secret);
 uint64_t runtime_bigintToInteger(const runtime_array *source);
 uint64_t runtime_bigintToIntegerTrunc(const runtime_array *source);
+void runtime_setMaxWideIntWidth(uint32_t width);
+void runtime_wideIntegerToBigint(runtime_array *dest, const uint64_t *words, uint32_t width,
+    bool isSigned, bool secret);
+void runtime_bigintToWideInteger(uint64_t *words, const runtime_array *source, uint32_t width,
+    bool isSigned, bool truncate);
+void runtime_wideIntArrayToBigints(runtime_array *dest, const runtime_array *source,
+    uint32_t width, bool secret);
+void runtime_bigintsToWideIntArray(runtime_array *dest, const runtime_array *source,
+    uint32_t width);
 void runtime_bigintDecodeLittleEndian(runtime_array *dest, runtime_array *byteArray,
     uint32_t width, bool isSigned, bool secret);
 void runtime_bigintDecodeBigEndian(runtime_array *dest, runtime_array *byteArray,
@@ -271,6 +355,41 @@ void runtime_bigintModularDiv(runtime_array *dest, runtime_array *a, runtime_arr
 void runtime_bigintModularExp(runtime_array *dest, runtime_array *base, runtime_array *exponent, runtime_array *modulus);
 void runtime_bigintModularNegate(runtime_array *dest, runtime_array *a, runtime_array *modulus);
 bool runtime_bigintModularInverse(runtime_array *dest, runtime_array *source, runtime_array *modulus);
+// Batched modular operations on arrays of bigints sharing one odd modulus.
+void runtime_bigintBatchModularMul(runtime_array *dest, runtime_array *a, runtime_array *b,
+    runtime_array *modulus);
+void runtime_bigintBatchModularExp(runtime_array *dest, runtime_array *bases,
+    runtime_array *exponents, runtime_array *modulus);
+// Fixed-base modular exponentiation from a precomputed comb table.
+void runtime_bigintFixedBaseTable(runtime_array *table, runtime_array *base,
+    runtime_array *modulus);
+void runtime_bigintFixedBaseExp(runtime_array *dest, runtime_array *table,
+    runtime_array *exponent);
+// Modular operations specialized for constant moduli.  The compiler emits a
+// runtime_constModulus global for each, holding the modulus and the reduction
+// constant it precomputed, and the runtime builds the reduction context on
+// first use.  Reduction types match deReductionType in the compiler.
+typedef enum {
+  RN_REDUCE_PSEUDO_MERSENNE = 1,  // 2^k - c, given c.
+  RN_REDUCE_MONTGOMERY = 2,  // Other odd moduli, given R^2 mod m.
+  RN_REDUCE_BARRETT = 3,  // Even moduli, given floor(4^k/m).
+} runtime_reductionType;
+typedef struct {
+  void *context;  // Built on first use, as one allocation.
+  const uint64_t *modulus;
+  const uint64_t *constant;
+  uint32_t width;
+  uint32_t constantWidth;
+  uint32_t reduction;
+} runtime_constModulus;
+void runtime_bigintConstModularMul(runtime_array *dest, runtime_array *a, runtime_array *b,
+    runtime_constModulus *modulus);
+void runtime_bigintConstModularExp(runtime_array *dest, runtime_array *base,
+    runtime_array *exponent, runtime_constModulus *modulus);
+void runtime_wideIntConstModularMul(uint64_t *dest, const uint64_t *a, const uint64_t *b,
+    runtime_constModulus *modulus);
+void runtime_wideIntConstModularExp(uint64_t *dest, const uint64_t *base,
+    const uint64_t *exponent, uint32_t expWidth, runtime_constModulus *modulus);
 static inline void runtime_copyBigint(runtime_array *dest, runtime_array *source) {
   runtime_copyArray(dest, source, sizeof(uint32_t), false);
 }
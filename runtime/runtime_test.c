@@ -20,6 +20,8 @@
 #include <string.h>
 #include <assert.h>
 #include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #define RN_HEAP_SIZE (1u << 15)
 
@@ -127,6 +129,23 @@ static void testIntegerConversion(void) {
   runtime_freeArray(&array);
 }
 
+// Test converting a native wide integer to/from a bigint.
+static void testWideIntegerConversion(void) {
+  uint64_t words[4] = {0xbadc0ffee0ddf00dLL, 0x0123456789abcdefLL, 0xfedcba9876543210LL,
+      0x8000000000000001LL};
+  uint64_t result[4];
+  runtime_array array = runtime_makeEmptyArray();
+  runtime_wideIntegerToBigint(&array, words, 256, false, false);
+  runtime_bigintToWideInteger(result, &array, 256, false, false);
+  assert(!memcmp(words, result, sizeof(words)));
+  runtime_freeArray(&array);
+  runtime_wideIntegerToBigint(&array, words, 256, true, false);
+  assert(runtime_rnBoolToBool(runtime_bigintNegative(&array)));
+  runtime_bigintToWideInteger(result, &array, 256, true, false);
+  assert(!memcmp(words, result, sizeof(words)));
+  runtime_freeArray(&array);
+}
+
 // Test runtime_bigintEncodeLittleEndian and runtime_bigintDecodeLittleEndian.
 static void testEncodeDecode(void) {
   runtime_array byteArray = runtime_makeEmptyArray();
@@ -318,9 +337,203 @@ static void testBigintModularExp(void) {
   runtime_freeArray(&res);
 }
 
+// Test batched modular multiplication and exponentiation against the
+// unbatched versions.  Use more values than SIMD lanes to cover a partial group.
+static void testBigintBatchModular(void) {
+  const uint32_t numValues = 11;
+  runtime_array modulus = runtime_makeEmptyArray();
+  initBigintTo25519(&modulus);
+  runtime_array a = runtime_makeEmptyArray();
+  runtime_array b = runtime_makeEmptyArray();
+  runtime_array exponents = runtime_makeEmptyArray();
+  runtime_allocArray(&a, numValues, sizeof(runtime_array), true);
+  runtime_allocArray(&b, numValues, sizeof(runtime_array), true);
+  runtime_allocArray(&exponents, numValues, sizeof(runtime_array), true);
+  for (uint32_t i = 0; i < numValues; i++) {
+    runtime_integerToBigint((runtime_array*)a.data + i, 12345*i + 1, 255, false, i & 1);
+    runtime_integerToBigint((runtime_array*)b.data + i, 0xdeadbeef*i + 7, 255, false, false);
+    runtime_copyArray((runtime_array*)exponents.data + i, &modulus, sizeof(uint32_t), false);
+  }
+  runtime_array products = runtime_makeEmptyArray();
+  runtime_array powers = runtime_makeEmptyArray();
+  runtime_array expected = runtime_makeEmptyArray();
+  runtime_bigintBatchModularMul(&products, &a, &b, &modulus);
+  // A number raised to a prime modulus is just itself.
+  runtime_bigintBatchModularExp(&powers, &a, &exponents, &modulus);
+  assert(products.numElements == numValues && powers.numElements == numValues);
+  for (uint32_t i = 0; i < numValues; i++) {
+    runtime_array *product = (runtime_array*)products.data + i;
+    runtime_bigintModularMul(&expected, (runtime_array*)a.data + i,
+        (runtime_array*)b.data + i, &modulus);
+    assert(runtime_compareBigints(RN_EQUAL, product, &expected));
+    assert(runtime_bigintSecret(product) == (i & 1));
+    assert(runtime_compareBigints(RN_EQUAL, (runtime_array*)powers.data + i,
+        (runtime_array*)a.data + i));
+  }
+  runtime_freeArray(&modulus);
+  runtime_freeArray(&a);
+  runtime_freeArray(&b);
+  runtime_freeArray(&exponents);
+  runtime_freeArray(&products);
+  runtime_freeArray(&powers);
+  runtime_freeArray(&expected);
+}
+
+// Test fixed-base exponentiation against runtime_bigintModularExp.
+static void testBigintFixedBaseExp(void) {
+  runtime_array modulus = runtime_makeEmptyArray();
+  initBigintTo25519(&modulus);
+  runtime_array g = runtime_makeEmptyArray();
+  runtime_integerToBigint(&g, 2, 255, false, false);
+  runtime_array table = runtime_makeEmptyArray();
+  runtime_bigintFixedBaseTable(&table, &g, &modulus);
+  runtime_array exponent = runtime_makeEmptyArray();
+  runtime_array expected = runtime_makeEmptyArray();
+  runtime_array res = runtime_makeEmptyArray();
+  for (uint32_t i = 0; i < 4; i++) {
+    runtime_integerToBigint(&exponent, 0x123456789abcdefull*i + i, 255, false, true);
+    runtime_bigintModularExp(&expected, &g, &exponent, &modulus);
+    runtime_bigintFixedBaseExp(&res, &table, &exponent);
+    assert(runtime_compareBigints(RN_EQUAL, &res, &expected));
+    assert(runtime_bigintSecret(&res));
+  }
+  // A number raised to a prime modulus is just itself.
+  runtime_bigintFixedBaseExp(&res, &table, &modulus);
+  assert(runtime_compareBigints(RN_EQUAL, &res, &g));
+  runtime_freeArray(&modulus);
+  runtime_freeArray(&g);
+  runtime_freeArray(&table);
+  runtime_freeArray(&exponent);
+  runtime_freeArray(&expected);
+  runtime_freeArray(&res);
+}
+
+// Set dest = op(2^power, modulus), cast to |width| bits.
+static void powerOfTwoOp(void (*op)(runtime_array *dest, runtime_array *a, runtime_array *b),
+    runtime_array *dest, uint32_t power, runtime_array *modulus, uint32_t width) {
+  runtime_array big = runtime_makeEmptyArray();
+  runtime_array bigModulus = runtime_makeEmptyArray();
+  runtime_integerToBigint(&big, 1, power + 1, false, false);
+  runtime_bigintShl(&big, &big, power);
+  runtime_bigintCast(&bigModulus, modulus, power + 1, false, false, false);
+  op(&big, &big, &bigModulus);
+  runtime_bigintCast(dest, &big, width, false, false, false);
+  runtime_freeArray(&big);
+  runtime_freeArray(&bigModulus);
+}
+
+// Check the multiply and exponentiation for a constant modulus against the
+// generic ones, with bigint and with native wide operands.  Widths are at most
+// 320 bits.
+static void checkConstModular(runtime_array *modulus, runtime_array *constant,
+    runtime_reductionType reduction) {
+  uint32_t width = runtime_bigintWidth(modulus);
+  uint32_t constantWidth = runtime_bigintWidth(constant);
+  uint64_t modulusWords[5], constantWords[5], aWords[5], bWords[5], resWords[5];
+  runtime_bigintToWideInteger(modulusWords, modulus, width, false, false);
+  runtime_bigintToWideInteger(constantWords, constant, constantWidth, false, false);
+  runtime_constModulus constModulus = {NULL, modulusWords, constantWords, width,
+      constantWidth, reduction};
+  runtime_array a = runtime_makeEmptyArray();
+  runtime_array b = runtime_makeEmptyArray();
+  runtime_array one = runtime_makeEmptyArray();
+  runtime_array res = runtime_makeEmptyArray();
+  runtime_array expected = runtime_makeEmptyArray();
+  runtime_integerToBigint(&one, 1, width, false, false);
+  for (uint32_t i = 0; i < 4; i++) {
+    runtime_integerToBigint(&a, 12345*i + 1, width, false, i & 1);
+    runtime_integerToBigint(&b, 0xdeadbeef*i + 7, width, false, false);
+    if (i == 3) {
+      // Check the largest product.
+      runtime_bigintSub(&a, modulus, &one);
+      runtime_bigintSub(&b, modulus, &one);
+    }
+    runtime_bigintToWideInteger(aWords, &a, width, false, false);
+    runtime_bigintToWideInteger(bWords, &b, width, false, false);
+    runtime_bigintConstModularMul(&res, &a, &b, &constModulus);
+    runtime_bigintModularMul(&expected, &a, &b, modulus);
+    assert(runtime_compareBigints(RN_EQUAL, &res, &expected));
+    assert(runtime_bigintSecret(&res) == (i & 1));
+    runtime_wideIntConstModularMul(resWords, aWords, bWords, &constModulus);
+    runtime_wideIntegerToBigint(&res, resWords, width, false, false);
+    assert(runtime_compareBigints(RN_EQUAL, &res, &expected));
+    runtime_bigintConstModularExp(&res, &a, &b, &constModulus);
+    runtime_bigintModularExp(&expected, &a, &b, modulus);
+    assert(runtime_compareBigints(RN_EQUAL, &res, &expected));
+    runtime_wideIntConstModularExp(resWords, aWords, bWords, width, &constModulus);
+    runtime_wideIntegerToBigint(&res, resWords, width, false, false);
+    assert(runtime_compareBigints(RN_EQUAL, &res, &expected));
+  }
+  free(constModulus.context);
+  runtime_freeArray(&a);
+  runtime_freeArray(&b);
+  runtime_freeArray(&one);
+  runtime_freeArray(&res);
+  runtime_freeArray(&expected);
+}
+
+// Test the reductions specialized for constant moduli.
+static void testBigintConstModular(void) {
+  runtime_array modulus = runtime_makeEmptyArray();
+  runtime_array constant = runtime_makeEmptyArray();
+  initBigintTo25519(&modulus);
+  runtime_integerToBigint(&constant, 19, 255, false, false);
+  checkConstModular(&modulus, &constant, RN_REDUCE_PSEUDO_MERSENNE);
+  // R = 2^(31*9) for a 255-bit modulus.
+  powerOfTwoOp(runtime_bigintMod, &constant, 2*31*9, &modulus, 255);
+  checkConstModular(&modulus, &constant, RN_REDUCE_MONTGOMERY);
+  // Barrett reduction is used for even moduli.
+  runtime_array evenModulus = runtime_makeEmptyArray();
+  runtime_bigintCast(&evenModulus, &modulus, 256, false, false, false);
+  runtime_bigintShl(&evenModulus, &evenModulus, 1);
+  powerOfTwoOp(runtime_bigintDiv, &constant, 2*256, &evenModulus, 257);
+  checkConstModular(&evenModulus, &constant, RN_REDUCE_BARRETT);
+  runtime_freeArray(&modulus);
+  runtime_freeArray(&evenModulus);
+  runtime_freeArray(&constant);
+}
+
+// Check that the bigint converts to a string of |numZeros| zeros, following
+// |prefix|.
+static void checkBigintString(runtime_array *bigint, uint32_t base, const char *prefix,
+    uint32_t numZeros) {
+  runtime_array string = runtime_makeEmptyArray();
+  runtime_bigintToString(&string, bigint, base);
+  uint32_t prefixLen = strlen(prefix);
+  const char *data = (const char*)string.data;
+  assert(string.numElements == prefixLen + numZeros);
+  assert(!memcmp(data, prefix, prefixLen));
+  for (uint32_t i = prefixLen; i < string.numElements; i++) {
+    assert(data[i] == '0');
+  }
+  runtime_freeArray(&string);
+}
+
+// Test converting bigints to strings.  10^400 spans many chunks, all of them
+// zero but the top one.
+static void testBigintToString(void) {
+  runtime_array value = runtime_makeEmptyArray();
+  runtime_integerToBigint(&value, 10, 2048, true, false);
+  runtime_bigintExp(&value, &value, 400);
+  checkBigintString(&value, 10, "1", 400);
+  runtime_bigintNegate(&value, &value);
+  checkBigintString(&value, 10, "-1", 400);
+  runtime_integerToBigint(&value, 1, 2048, false, false);
+  runtime_bigintShl(&value, &value, 2000);
+  checkBigintString(&value, 16, "1", 500);
+  checkBigintString(&value, 2, "1", 2000);
+  runtime_integerToBigint(&value, (uint64_t)1 << 63, 64, true, false);
+  checkBigintString(&value, 10, "-9223372036854775808", 0);
+  checkBigintString(&value, 16, "-8", 15);
+  runtime_integerToBigint(&value, 0, 64, true, false);
+  checkBigintString(&value, 10, "0", 0);
+  runtime_freeArray(&value);
+}
+
 // Test the Bigint API.
 static void testBigints(void) {
   testIntegerConversion();
+  testWideIntegerConversion();
   testEncodeDecode();
   testCompareBigints();
   testBigintCast();
@@ -332,6 +545,10 @@ static void testBigints(void) {
   testBigintModularInverse();
   testBigintModularDiv();
   testBigintModularExp();
+  testBigintBatchModular();
+  testBigintFixedBaseExp();
+  testBigintConstModular();
+  testBigintToString();
 }
 
 // Test the Smallnum API.
@@ -415,6 +632,341 @@ static void testXorStrings(void) {
   runtime_freeArray(&c);
 }
 
+// Test constant-time lookup with a secret index for each element size, with
+// lengths that leave a partial SIMD block at the end.
+static void testSecretLookup(void) {
+  runtime_array array = runtime_makeEmptyArray();
+  for (size_t elementSize = 1; elementSize <= 8; elementSize <<= 1) {
+    size_t numElements = 37;
+    runtime_resizeArray(&array, numElements, elementSize, false);
+    uint8_t *data = (uint8_t*)array.data;
+    for (size_t i = 0; i < numElements*elementSize; i++) {
+      data[i] = i*7 + 1;
+    }
+    for (size_t i = 0; i < numElements; i++) {
+      uint64_t expected = 0;
+      memcpy(&expected, data + i*elementSize, elementSize);
+      assert(runtime_secretLookup(&array, i, elementSize) == expected);
+    }
+    if (!runtime_setJmp()) {
+      runtime_secretLookup(&array, numElements, elementSize);
+      assert(false);
+    }
+  }
+  runtime_freeArray(&array);
+}
+
+// Test growing several columns together, including one of strings, and then
+// resizing one column on its own.
+static void testResizeColumns(void) {
+  runtime_array ints = runtime_makeEmptyArray();
+  runtime_array bytes = runtime_makeEmptyArray();
+  runtime_array strings = runtime_makeEmptyArray();
+  runtime_array *columns[3] = {&ints, &bytes, &strings};
+  size_t elementSizes[3] = {sizeof(uint32_t), sizeof(uint8_t), sizeof(runtime_array)};
+  uint8_t hasSubArrays[3] = {false, false, true};
+  for (size_t numElements = 2; numElements <= 64; numElements <<= 1) {
+    size_t oldNumElements = ints.numElements;
+    runtime_resizeColumns(columns, elementSizes, hasSubArrays, 3, numElements);
+    for (size_t i = 0; i < 3; i++) {
+      assert(columns[i]->numElements == numElements);
+      assert(runtime_getArrayHeader(columns[i])->backPointer == columns[i]);
+    }
+    for (size_t i = 0; i < numElements; i++) {
+      runtime_array *string = (runtime_array*)strings.data + i;
+      if (i < oldNumElements) {
+        assert(((uint32_t*)ints.data)[i] == i*i);
+        assert(((uint8_t*)bytes.data)[i] == (uint8_t)(i + 1));
+        assert(string->numElements == 1 && ((uint8_t*)string->data)[0] == 'a' + i%26);
+        assert(runtime_getArrayHeader(string)->backPointer == string);
+      } else {
+        assert(((uint32_t*)ints.data)[i] == 0 && ((uint8_t*)bytes.data)[i] == 0);
+        ((uint32_t*)ints.data)[i] = i*i;
+        ((uint8_t*)bytes.data)[i] = i + 1;
+        runtime_resizeArray(string, 1, sizeof(uint8_t), false);
+        ((uint8_t*)string->data)[0] = 'a' + i%26;
+      }
+    }
+  }
+  // Resizing to the current size leaves the columns alone.
+  size_t *data = ints.data;
+  runtime_resizeColumns(columns, elementSizes, hasSubArrays, 3, 64);
+  assert(ints.data == data);
+  runtime_resizeArray(&bytes, 100, sizeof(uint8_t), false);
+  assert(!runtime_getArrayHeader(&bytes)->isStripe);
+  assert(((uint8_t*)bytes.data)[63] == 64 && ((uint8_t*)bytes.data)[64] == 0);
+  runtime_resizeColumns(columns, elementSizes, hasSubArrays, 3, 0);
+  runtime_freeArray(&bytes);
+  assert(ints.data == NULL && strings.data == NULL);
+  printf("Passed resize columns test\n");
+}
+
+// Test renumbering the live objects of a class with a free list, and then
+// rewriting references to them.
+static void testCompactColumns(void) {
+  runtime_array nextFree = runtime_makeEmptyArray();
+  runtime_array names = runtime_makeEmptyArray();
+  runtime_array *columns[2] = {&nextFree, &names};
+  size_t elementSizes[2] = {sizeof(uint32_t), sizeof(runtime_array)};
+  uint8_t hasSubArrays[2] = {false, true};
+  runtime_resizeColumns(columns, elementSizes, hasSubArrays, 2, 8);
+  // Objects 1 and 4 are free, with 4 at the head of the free list.
+  uint32_t *refs = (uint32_t*)nextFree.data;
+  for (uint32_t i = 0; i < 6; i++) {
+    refs[i] = 1;
+    if (i != 1 && i != 4) {
+      runtime_array *name = (runtime_array*)names.data + i;
+      runtime_resizeArray(name, 1, sizeof(uint8_t), false);
+      ((uint8_t*)name->data)[0] = 'a' + i;
+    }
+  }
+  refs[4] = 1;
+  refs[1] = UINT32_MAX;
+  runtime_array newIds = runtime_makeEmptyArray();
+  uint64_t numLive = runtime_compactColumns(columns, elementSizes, hasSubArrays, 2, 6, 4, 32, &newIds);
+  assert(numLive == 4);
+  const char *expected = "acdf";
+  for (uint32_t i = 0; i < 4; i++) {
+    runtime_array *name = (runtime_array*)names.data + i;
+    assert(refs[i] == 1 && ((uint8_t*)name->data)[0] == expected[i]);
+    assert(runtime_getArrayHeader(name)->backPointer == name);
+  }
+  assert(((runtime_array*)names.data)[4].data == NULL && refs[5] == 0);
+  runtime_array links = runtime_makeEmptyArray();
+  runtime_resizeArray(&links, 3, sizeof(uint32_t), false);
+  uint32_t *linkRefs = (uint32_t*)links.data;
+  linkRefs[0] = 5;
+  linkRefs[1] = UINT32_MAX;
+  linkRefs[2] = 2;
+  size_t linkPath[2] = {sizeof(uint32_t), 0};
+  runtime_remapReferences(&links, linkPath, 1, sizeof(uint32_t), 32, 3, &newIds);
+  assert(linkRefs[0] == 3 && linkRefs[1] == UINT32_MAX && linkRefs[2] == 1);
+  assert(runtime_remapReference(3, 32, &newIds) == 2);
+  // An array of (u64, ref) tuples, inside one element of a column of arrays.
+  typedef struct {
+    uint64_t value;
+    uint32_t ref;
+  } pairTuple;
+  runtime_array lists = runtime_makeEmptyArray();
+  runtime_resizeArray(&lists, 1, sizeof(runtime_array), true);
+  runtime_array *pairs = (runtime_array*)lists.data;
+  runtime_resizeArray(pairs, 2, sizeof(pairTuple), false);
+  pairTuple *pairData = (pairTuple*)pairs->data;
+  pairData[0].ref = 5;
+  pairData[1].ref = 3;
+  size_t pairPath[4] = {sizeof(runtime_array), 0, sizeof(pairTuple), offsetof(pairTuple, ref)};
+  runtime_remapReferences(&lists, pairPath, 2, sizeof(uint32_t), 32, 1, &newIds);
+  pairData = (pairTuple*)((runtime_array*)lists.data)->data;
+  assert(pairData[0].ref == 3 && pairData[1].ref == 2);
+  runtime_freeArray(&lists);
+  runtime_freeArray(&links);
+  runtime_freeArray(&newIds);
+  runtime_resizeColumns(columns, elementSizes, hasSubArrays, 2, 0);
+  printf("Passed compact columns test\n");
+}
+
+// Test the CPRNG.  Bulk strings should span several keystream buffers, and a
+// forked child must not repeat the parent's output.
+static void testRandom(void) {
+  runtime_array a = runtime_makeEmptyArray();
+  runtime_array b = runtime_makeEmptyArray();
+  runtime_randString(&a, 5000);
+  runtime_randString(&b, 5000);
+  assert(a.numElements == 5000 && b.numElements == 5000);
+  assert(memcmp(a.data, b.data, 5000) != 0);
+  uint64_t value = runtime_generateTrueRandomValue(7);
+  assert(value < 128);
+  int fds[2];
+  int status = pipe(fds);
+  assert(status == 0);
+  pid_t pid = fork();
+  assert(pid >= 0);
+  uint64_t childValue, parentValue = runtime_generateTrueRandomValue(64);
+  if (pid == 0) {
+    childValue = runtime_generateTrueRandomValue(64);
+    _exit(write(fds[1], &childValue, sizeof(childValue)) != sizeof(childValue));
+  }
+  ssize_t len = read(fds[0], &childValue, sizeof(childValue));
+  assert(len == sizeof(childValue));
+  waitpid(pid, NULL, 0);
+  close(fds[0]);
+  close(fds[1]);
+  assert(childValue != parentValue);
+  runtime_freeArray(&a);
+  runtime_freeArray(&b);
+  printf("Passed random test\n");
+}
+
+// Test the hashes against the FIPS 180-4, FIPS 202, and RFC 4231 vectors.
+static void testHashes(void) {
+  runtime_array data = runtime_makeEmptyArray();
+  runtime_array key = runtime_makeEmptyArray();
+  runtime_array digest = runtime_makeEmptyArray();
+  runtime_array hex = runtime_makeEmptyArray();
+  runtime_arrayInitCstr(&data, "abc");
+  runtime_sha256(&digest, &data);
+  runtime_stringToHex(&hex, &digest);
+  assert(!memcmp(hex.data, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad", 64));
+  runtime_sha3(&digest, &data);
+  runtime_stringToHex(&hex, &digest);
+  assert(!memcmp(hex.data, "3a985da74fe225b2045c172d6bd390bd855f086e3e9d525b46bfe24511431532", 64));
+  runtime_arrayInitCstr(&key, "Jefe");
+  runtime_arrayInitCstr(&data, "what do ya want for nothing?");
+  runtime_hmacSha256(&digest, &key, &data);
+  runtime_stringToHex(&hex, &digest);
+  assert(!memcmp(hex.data, "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843", 64));
+  runtime_freeArray(&data);
+  runtime_freeArray(&key);
+  runtime_freeArray(&digest);
+  runtime_freeArray(&hex);
+  printf("Passed hash test\n");
+}
+
+// Test the seeded hash table hash on every length path.  The seed is random,
+// so only check that hashes are repeatable and sensitive to each byte.
+static void testHashBytes(void) {
+  uint8_t buf[101];
+  for (uint32_t i = 0; i < sizeof(buf); i++) {
+    buf[i] = i*37;
+  }
+  for (uint64_t len = 1; len < sizeof(buf); len++) {
+    uint64_t hash = runtime_hashBytes(buf, len);
+    assert(runtime_hashBytes(buf, len) == hash);
+    assert(runtime_hashBytes(buf, len - 1) != hash);
+    buf[0] ^= 1;
+    assert(runtime_hashBytes(buf, len) != hash);
+    buf[0] ^= 1;
+    buf[len - 1] ^= 0x80;
+    assert(runtime_hashBytes(buf, len) != hash);
+    buf[len - 1] ^= 0x80;
+  }
+  runtime_array string = runtime_makeEmptyArray();
+  runtime_arrayInitCstr(&string, "Hello, World!");
+  assert(runtime_hashString(&string) == runtime_hashBytes((const uint8_t*)"Hello, World!", 13));
+  runtime_freeArray(&string);
+  // Bigints hash like native integers extended to the widest native width.
+  runtime_setMaxWideIntWidth(256);
+  uint64_t words[4] = {5, 0, 0, 0};
+  runtime_array bigint = runtime_makeEmptyArray();
+  runtime_integerToBigint(&bigint, 5, 512, false, false);
+  assert(runtime_hashBigint(&bigint) == runtime_hashBytes((const uint8_t*)words, sizeof(words)));
+  runtime_integerToBigint(&bigint, -(uint64_t)3, 1024, true, false);
+  for (uint32_t i = 0; i < 4; i++) {
+    words[i] = ~(uint64_t)0;
+  }
+  words[0] = -(uint64_t)3;
+  assert(runtime_hashBigint(&bigint) == runtime_hashBytes((const uint8_t*)words, sizeof(words)));
+  runtime_bigintShl(&bigint, &bigint, 300);
+  assert(runtime_hashBigint(&bigint) != runtime_hashBytes((const uint8_t*)words, sizeof(words)));
+  runtime_freeArray(&bigint);
+  runtime_setMaxWideIntWidth(64);
+  printf("Passed hash bytes test\n");
+}
+
+// Test NTT polynomial multiplication against schoolbook multiplication mod
+// x^n + 1, for n large enough to use the vector butterflies.
+static void testPolyMul(void) {
+  uint32_t q = 8380417;
+  uint32_t n = 256;
+  runtime_array table = runtime_makeEmptyArray();
+  runtime_array a = runtime_makeEmptyArray();
+  runtime_array b = runtime_makeEmptyArray();
+  runtime_array c = runtime_makeEmptyArray();
+  runtime_polyNttTable(&table, q, n);
+  runtime_resizeArray(&a, n, sizeof(uint32_t), false);
+  runtime_resizeArray(&b, n, sizeof(uint32_t), false);
+  uint32_t *aData = (uint32_t*)a.data;
+  uint32_t *bData = (uint32_t*)b.data;
+  for (uint32_t i = 0; i < n; i++) {
+    aData[i] = (i*2654435761u) % q;
+    bData[i] = q - 1 - i;
+  }
+  runtime_polyMul(&c, &a, &b, &table);
+  const uint32_t *cData = (const uint32_t*)c.data;
+  for (uint32_t k = 0; k < n; k++) {
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < n; i++) {
+      uint64_t product = (uint64_t)aData[i]*bData[(k - i) & (n - 1)] % q;
+      sum += i <= k? product : q - product;
+    }
+    assert(cData[k] == sum % q);
+  }
+  runtime_polyNtt(&c, &a, &table);
+  runtime_polyInverseNtt(&c, &c, &table);
+  assert(!memcmp(c.data, a.data, n*sizeof(uint32_t)));
+  runtime_freeArray(&table);
+  runtime_freeArray(&a);
+  runtime_freeArray(&b);
+  runtime_freeArray(&c);
+  printf("Passed polynomial multiplication test\n");
+}
+
+// Test writing a field access profile.
+static void testFieldProfile(void) {
+  char fileName[64];
+  snprintf(fileName, sizeof(fileName), "/tmp/runtime_profile%d", (int)getpid());
+  uint64_t loads = 0, stores = 0;
+  uint64_t *counters[] = {&loads, &stores};
+  runtime_startFieldProfile(fileName, "Foo_x\tx\tmain\tload\nFoo_x\tx\tmain\tstore\n",
+      counters, 2);
+  loads += 3;
+  stores++;
+  runtime_writeFieldProfile();
+  runtime_startFieldProfile(NULL, NULL, NULL, 0);
+  FILE *file = fopen(fileName, "r");
+  assert(file != NULL);
+  char buf[128];
+  size_t len = fread(buf, 1, sizeof(buf) - 1, file);
+  buf[len] = '\0';
+  fclose(file);
+  unlink(fileName);
+  assert(!strcmp(buf, "Foo_x\tx\tmain\tload\t3\nFoo_x\tx\tmain\tstore\t1\n"));
+  printf("Passed field profile test\n");
+}
+
+// Test the class memory report on a hand-built class table.
+static void testClassStats(void) {
+  runtime_array nextFree = runtime_makeEmptyArray();
+  runtime_array names = runtime_makeEmptyArray();
+  runtime_array *columns[2] = {&nextFree, &names};
+  size_t elementSizes[2] = {sizeof(uint32_t), sizeof(runtime_array)};
+  uint8_t hasSubArrays[2] = {false, true};
+  runtime_resizeColumns(columns, elementSizes, hasSubArrays, 2, 4);
+  uint64_t namesBytes = runtime_arrayHeapBytes(&names);
+  // Object 1 is free, and 0 and 2 are live.
+  uint32_t *refs = (uint32_t*)nextFree.data;
+  refs[0] = 1;
+  refs[1] = UINT32_MAX;
+  refs[2] = 1;
+  runtime_arrayInitCstr((runtime_array*)names.data + 2, "Rune");
+  assert(runtime_arrayHeapBytes(&names) > namesBytes);
+  uint32_t used = 3, allocated = 4, firstFree = 1;
+  runtime_columnInfo columnInfo[2] = {
+      {"nextFree", "u32", &nextFree, sizeof(uint32_t)},
+      {"name", "string", &names, sizeof(runtime_array)}};
+  runtime_classInfo classInfo = {"Node", 32, 2, columnInfo, &used, &allocated, &firstFree};
+  runtime_setClassTable(&classInfo, 1);
+  runtime_array report = runtime_makeEmptyArray();
+  runtime_classStats(&report);
+  char text[256];
+  assert(report.numElements < sizeof(text));
+  memcpy(text, report.data, report.numElements);
+  text[report.numElements] = '\0';
+  char expected[256];
+  snprintf(expected, sizeof(expected),
+      "Node: refWidth 32, used 3, allocated 4, live 2, %llu bytes\n"
+      "  nextFree u32: %llu bytes\n"
+      "  name string: %llu bytes\n",
+      (unsigned long long)(runtime_arrayHeapBytes(&nextFree) + runtime_arrayHeapBytes(&names)),
+      (unsigned long long)runtime_arrayHeapBytes(&nextFree),
+      (unsigned long long)runtime_arrayHeapBytes(&names));
+  assert(!strcmp(text, expected));
+  runtime_setClassTable(NULL, 0);
+  runtime_freeArray(&report);
+  runtime_resizeColumns(columns, elementSizes, hasSubArrays, 2, 0);
+  printf("Passed class stats test\n");
+}
+
 int main(int argc, char **argv) {
   mcheck(NULL);
   runtime_arrayStart();
@@ -424,6 +976,15 @@ int main(int argc, char **argv) {
   testSprintf();
   testInitArrayOfStringFromC();
   testXorStrings();
+  testSecretLookup();
+  testResizeColumns();
+  testCompactColumns();
+  testRandom();
+  testHashes();
+  testHashBytes();
+  testPolyMul();
+  testFieldProfile();
+  testClassStats();
   runtime_arrayStop();
   printf("passed\n");
 }
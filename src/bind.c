@@ -1516,6 +1516,8 @@ static void verifyFunctionIsCallable(deBlock scopeBlock, deFunction function) {
     case DE_FUNC_OPERATOR:
     case DE_FUNC_CONSTRUCTOR:
     case DE_FUNC_DESTRUCTOR:
+    case DE_FUNC_COMPACTOR:
+    case DE_FUNC_ALLOCATOR:
     case DE_FUNC_ITERATOR:
     case DE_FUNC_STRUCT:
       return;
@@ -1604,6 +1606,32 @@ static void bindCallExpression(deBlock scopeBlock, deExpression expression,
   }
 }
 
+// Bind an index expression with a secret index, which is only allowed for
+// reading integers from arrays.  It is generated as a constant-time scan of the
+// whole array, and the result is secret.
+static void bindSecretIndexExpression(deExpression expression, deDatatype leftType,
+    deDatatype rightType, deLine line) {
+  if (deBindingAssignmentTarget) {
+    deError(line, "Assigning to an array element with a secret index is not allowed");
+  }
+  // The runtime takes a 64-bit index, and truncating a secret index would
+  // read the wrong element rather than fail the bounds check.
+  if (deDatatypeGetWidth(rightType) > 64) {
+    deError(line, "Secret indexes must be 64 bits or less");
+  }
+  deDatatypeType type = deDatatypeGetType(leftType);
+  if (type != DE_TYPE_ARRAY && type != DE_TYPE_STRING) {
+    deError(line, "Indexing with a secret is only allowed for arrays and strings");
+  }
+  deDatatype elementType = deDatatypeGetElementType(leftType);
+  deDatatypeType elementTypeType = deDatatypeGetType(elementType);
+  if ((elementTypeType != DE_TYPE_UINT && elementTypeType != DE_TYPE_INT &&
+      elementTypeType != DE_TYPE_BOOL) || deDatatypeGetWidth(elementType) > 64) {
+    deError(line, "Indexing with a secret is only allowed for arrays of integers up to 64 bits");
+  }
+  deExpressionSetDatatype(expression, deSetDatatypeSecret(elementType, true));
+}
+
 // Bind the index expression.
 static void bindIndexExpression(deBlock scopeBlock, deExpression expression) {
   deExpression left = deExpressionGetFirstExpression(expression);
@@ -1620,14 +1648,15 @@ static void bindIndexExpression(deBlock scopeBlock, deExpression expression) {
   if (deDatatypeGetType(rightType) != DE_TYPE_UINT) {
     deError(line, "Index values must be uint");
   }
-  if (deDatatypeSecret(rightType)) {
-    deError(line, "Indexing with a secret is not allowed");
-  }
   deDatatypeType type = deDatatypeGetType(leftType);
   if (type != DE_TYPE_ARRAY && type != DE_TYPE_STRING && type != DE_TYPE_TUPLE &&
       type != DE_TYPE_STRUCT) {
     deError(line, "Index into non-array/non-string/non-tuple/non-struct type");
   }
+  if (deDatatypeSecret(rightType)) {
+    bindSecretIndexExpression(expression, leftType, rightType, line);
+    return;
+  }
   if (type == DE_TYPE_TUPLE || type == DE_TYPE_STRUCT) {
     deExpression right = deExpressionGetNextExpression(left);
     if (deExpressionGetType(right) != DE_EXPR_INTEGER) {
@@ -1953,6 +1982,29 @@ static void bindAssignmentExpression(deBlock scopeBlock, deExpression expression
   }
 }
 
+// Record that the current signature accesses a data member.  Members accessed
+// by exactly the same set of signatures are always accessed together, and are
+// stored in one array of tuples by deAddMemoryManagement.  Constructors are
+// skipped, since they initialize every member.
+static void recordMemberAccess(deExpression identExpression) {
+  deIdent ident = deExpressionGetIdent(identExpression);
+  if (deCurrentSignature == deSignatureNull || deIdentGetType(ident) != DE_IDENT_VARIABLE) {
+    return;
+  }
+  deFunction function = deSignatureGetFunction(deCurrentSignature);
+  if (deFunctionGetType(function) == DE_FUNC_CONSTRUCTOR) {
+    return;
+  }
+  deVariable variable = deIdentGetVariable(ident);
+  if (deVariableGetLastAccessSignature(variable) == deCurrentSignature) {
+    return;
+  }
+  deVariableSetLastAccessSignature(variable, deCurrentSignature);
+  deVariableSetNumAccessSignatures(variable, deVariableGetNumAccessSignatures(variable) + 1);
+  uint32 hash = utHashValues(deSignature2Index(deCurrentSignature), 0x9e3779b9);
+  deVariableSetAccessSignatureHash(variable, deVariableGetAccessSignatureHash(variable) + hash);
+}
+
 // Bind a dot expression.  If we're binding a constructor, search in the
 // current theClass rather than the class constructor.
 static void bindDotExpression(deBlock scopeBlock, deExpression expression) {
@@ -1995,6 +2047,9 @@ static void bindDotExpression(deBlock scopeBlock, deExpression expression) {
     deError(line, "An identifier is expected after '.'");
   }
   bindExpression(classBlock, rightExpression);
+  if (type == DE_TYPE_CLASS) {
+    recordMemberAccess(rightExpression);
+  }
   deExpressionSetDatatype(expression, deExpressionGetDatatype(rightExpression));
   deExpressionSetConst(expression, deExpressionConst(rightExpression));
 }
@@ -3061,3 +3116,133 @@ void deBindRPCs(void) {
     }
   } deEndRootFunction;
 }
+
+// Determine if the ident expression is only used to access a data member, as
+// in v.x, and not to call a method, which could let the object escape.
+static bool identOnlyAccessesMember(deExpression identExpression) {
+  deExpression dotExpression = deExpressionGetExpression(identExpression);
+  if (dotExpression == deExpressionNull || deExpressionGetType(dotExpression) != DE_EXPR_DOT ||
+      deExpressionGetFirstExpression(dotExpression) != identExpression) {
+    return false;
+  }
+  deDatatype datatype = deExpressionGetDatatype(dotExpression);
+  if (datatype == deDatatypeNull || deDatatypeGetType(datatype) == DE_TYPE_FUNCTION) {
+    return false;
+  }
+  deExpression parent = deExpressionGetExpression(dotExpression);
+  return parent == deExpressionNull || deExpressionGetType(parent) != DE_EXPR_CALL ||
+      deExpressionGetFirstExpression(parent) != dotExpression;
+}
+
+// Determine if every use of the variable only accesses data members.
+static bool variableOnlyAccessesMembers(deVariable variable) {
+  deIdent ident;
+  deForeachVariableIdent(variable, ident) {
+    deExpression expression;
+    deForeachIdentExpression(ident, expression) {
+      if (!identOnlyAccessesMember(expression)) {
+        return false;
+      }
+    } deEndIdentExpression;
+  } deEndVariableIdent;
+  return true;
+}
+
+// Objects of a tclass can be allocated in a function's region if they are
+// reference counted, have no final method, and their constructor does not let
+// self escape.  Their destructor is then never needed, because nothing but the
+// function's locals can refer to them.
+static bool tclassCanUseRegion(deTclass tclass) {
+  if (!deTclassRefCounted(tclass) || deTclassHasFinalMethod(tclass)) {
+    return false;
+  }
+  deBlock block = deFunctionGetSubBlock(deTclassGetFunction(tclass));
+  deVariable self = deBlockGetFirstVariable(block);
+  return self != deVariableNull && variableOnlyAccessesMembers(self);
+}
+
+// Return the tclass if the expression is a call to a constructor whose objects
+// can be allocated in a region.
+static deTclass findRegionConstructorTclass(deExpression expression) {
+  if (expression == deExpressionNull || deExpressionGetType(expression) != DE_EXPR_CALL) {
+    return deTclassNull;
+  }
+  deSignature signature = deExpressionGetSignature(expression);
+  if (signature == deSignatureNull) {
+    return deTclassNull;
+  }
+  deFunction function = deSignatureGetFunction(signature);
+  if (deFunctionGetType(function) != DE_FUNC_CONSTRUCTOR) {
+    return deTclassNull;
+  }
+  deTclass tclass = deFunctionGetTclass(function);
+  if (tclass == deTclassNull || !tclassCanUseRegion(tclass)) {
+    return deTclassNull;
+  }
+  return tclass;
+}
+
+// Determine if the local variable's objects never escape the function: it is
+// only assigned the result of region-safe constructor calls, and otherwise only
+// used to access data members.  If so, mark the variable and its constructor
+// calls.
+static void findRegionVariable(deVariable variable) {
+  bool assigned = false;
+  deIdent ident;
+  deForeachVariableIdent(variable, ident) {
+    deExpression expression;
+    deForeachIdentExpression(ident, expression) {
+      deExpression parent = deExpressionGetExpression(expression);
+      if (parent != deExpressionNull && deExpressionGetType(parent) == DE_EXPR_EQUALS &&
+          deExpressionGetFirstExpression(parent) == expression) {
+        if (findRegionConstructorTclass(deExpressionGetNextExpression(expression)) ==
+            deTclassNull) {
+          return;
+        }
+        assigned = true;
+      } else if (!identOnlyAccessesMember(expression)) {
+        return;
+      }
+    } deEndIdentExpression;
+  } deEndVariableIdent;
+  if (!assigned) {
+    return;
+  }
+  deVariableSetRegion(variable, true);
+  deForeachVariableIdent(variable, ident) {
+    deExpression expression;
+    deForeachIdentExpression(ident, expression) {
+      deExpression parent = deExpressionGetExpression(expression);
+      if (deExpressionGetType(parent) == DE_EXPR_EQUALS &&
+          deExpressionGetFirstExpression(parent) == expression) {
+        deExpression call = deExpressionGetNextExpression(expression);
+        deExpressionSetRegionAlloc(call, true);
+        deTclassSetUsesRegion(findRegionConstructorTclass(call), true);
+      }
+    } deEndIdentExpression;
+  } deEndVariableIdent;
+}
+
+// Escape analysis.  Objects assigned to a local variable that never escape the
+// function, meaning they are never passed to a function, returned, or stored in
+// another variable, relation, or data member, are allocated in a per-call
+// region, and released in bulk when the function returns or throws.  A region
+// variable's old object is also freed when it is reassigned, if it is next on
+// the region's stack.  An exception thrown by a callee skips the release, so
+// the region's objects stay allocated until a caller with a region of the same
+// class returns.  This must be called after deVerifyRelationshipGraph, which
+// decides which tclasses are reference counted.
+void deFindRegionObjects(void) {
+  deFunction function;
+  deForeachRootFunction(deTheRoot, function) {
+    deFunctionType type = deFunctionGetType(function);
+    if (type == DE_FUNC_PLAIN || type == DE_FUNC_OPERATOR) {
+      deVariable variable;
+      deForeachBlockVariable(deFunctionGetSubBlock(function), variable) {
+        if (deVariableGetType(variable) == DE_VAR_LOCAL && !deVariableGenerated(variable)) {
+          findRegionVariable(variable);
+        }
+      } deEndBlockVariable;
+    }
+  } deEndRootFunction;
+}
@@ -33,15 +33,47 @@ static bool propagateChildConstants(deBlock scopeBlock, deExpression expression,
   return allConst;
 }
 
+// Select a faster reduction than runtime_bigintMod for a constant modulus, and
+// append the reduction constant the runtime needs as a third child of the modint
+// expression.  Moduli of 64 bits or less use native arithmetic already.
+static void selectModularReduction(deExpression expression, deExpression modulusExpr) {
+  if (deExpressionGetReductionType(expression) != DE_REDUCE_GENERIC) {
+    return;  // Already selected.
+  }
+  uint32 width = deDatatypeGetWidth(deExpressionGetDatatype(modulusExpr));
+  if (width <= 64) {
+    return;
+  }
+  deLine line = deExpressionGetLine(expression);
+  deBigint modulus = deBigintResize(deExpressionGetBigint(modulusExpr), width, line);
+  deReductionType type = DE_REDUCE_PSEUDO_MERSENNE;
+  deBigint constant = deBigintFindPseudoMersenneOffset(modulus);
+  if (constant == deBigintNull) {
+    if (deBigintGetiData(modulus, 0) & 1) {
+      type = DE_REDUCE_MONTGOMERY;
+      constant = deBigintFindMontgomeryR2(modulus);
+    } else {
+      type = DE_REDUCE_BARRETT;
+      constant = deBigintFindBarrettMu(modulus);
+    }
+  }
+  deBigintDestroy(modulus);
+  deExpression constantExpr = deIntegerExpressionCreate(constant, line);
+  deExpressionSetDatatype(constantExpr, deUintDatatypeCreate(deBigintGetWidth(constant)));
+  deExpressionAppendExpression(expression, constantExpr);
+  deExpressionSetReductionType(expression, type);
+}
+
 // Compute the modulus, and if constant, perform constant propagation on the
 // modular expression using the modulus.
 static bool propagateModularConstants(deBlock scopeBlock, deExpression expression) {
   deExpression valueExpr = deExpressionGetFirstExpression(expression);
-  deExpression modulusExpr = deExpressionGetLastExpression(expression);
+  deExpression modulusExpr = deExpressionGetNextExpression(valueExpr);
   if (!propagateExpressionConstants(scopeBlock, modulusExpr, deBigintNull)) {
     return false;
   }
   utAssert(deExpressionGetType(modulusExpr) == DE_EXPR_INTEGER);
+  selectModularReduction(expression, modulusExpr);
   return propagateExpressionConstants(scopeBlock, valueExpr, deExpressionGetBigint(modulusExpr));
 }
 
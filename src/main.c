@@ -44,10 +44,17 @@ static void usage(void) {
          "    -n        - No clang.  Don't compile the resulting .ll output.\n"
          "    -O        - Optimized build.  Passes -O3 to clang.\n"
          "    -p <dir>  - Use <dir> as the root directory for packages.\n"
+         "    -profgen <file> - Count class data member loads and stores, and write\n"
+         "                the counts to <file> when the program exits.\n"
+         "    -profuse <file> - Lay out class data member arrays hottest first, using\n"
+         "                counts from -profgen, and report members never read.\n"
          "    -t        - Execute unit tests for all modules.\n"
          "    -U        - Unsafe mode.  Don't generate bounds checking, overflow\n"
          "                detection, and destroyed object access detection.\n"
-         "    -x        - Invert the return code: 0 if we fail, and 1 if we pass.\n");
+         "    -w <width> - Generate native LLVM integers up to <width> bits.  Wider\n"
+         "                integers use the bigint runtime.  The default is %u.\n"
+         "    -x        - Invert the return code: 0 if we fail, and 1 if we pass.\n",
+         DE_DEFAULT_MAX_NATIVE_INT_WIDTH);
   exit(1);
 }
 
@@ -59,10 +66,13 @@ int main(int argc, char** argv) {
   deInvertReturnCode = false;
   deTestMode = false;
   deUnsafeMode = false;
+  deMaxNativeIntWidth = DE_DEFAULT_MAX_NATIVE_INT_WIDTH;
   dePackageDir = NULL;
   bool noClang = false;
   bool optimized = false;
   deLLVMFileName = NULL;
+  deFieldProfileGenFile = NULL;
+  deFieldProfileUseFile = NULL;
   uint32 xArg = 1;
   while (xArg < argc && argv[xArg][0] == '-') {
     if (!strcmp(argv[xArg], "-g")) {
@@ -87,12 +97,34 @@ int main(int argc, char** argv) {
         return 1;
       }
       dePackageDir = argv[xArg];
+    } else if (!strcmp(argv[xArg], "-profgen")) {
+      if (++xArg == argc) {
+        printf("-profgen requires the output profile file name");
+        return 1;
+      }
+      deFieldProfileGenFile = argv[xArg];
+    } else if (!strcmp(argv[xArg], "-profuse")) {
+      if (++xArg == argc) {
+        printf("-profuse requires a profile written by a -profgen build");
+        return 1;
+      }
+      deFieldProfileUseFile = argv[xArg];
     } else if (!strcmp(argv[xArg], "-clang")) {
       if (++xArg == argc) {
         printf("-C requires a path argument to the clang executable");
         return 1;
       }
       deClangPath = argv[xArg];
+    } else if (!strcmp(argv[xArg], "-w")) {
+      if (++xArg == argc) {
+        printf("-w requires the maximum native integer width");
+        return 1;
+      }
+      deMaxNativeIntWidth = atoi(argv[xArg]);
+      if (deMaxNativeIntWidth < 64 || (deMaxNativeIntWidth & 63) != 0) {
+        printf("-w requires a multiple of 64 bits");
+        return 1;
+      }
     } else if (!strcmp(argv[xArg], "-x")) {
       deInvertReturnCode = true;
     }  else {
@@ -111,6 +143,10 @@ int main(int argc, char** argv) {
     deParseModule(fileName, rootBlock, true);
     deBind();
     deVerifyRelationshipGraph();
+    deFindRegionObjects();
+    if (deFieldProfileUseFile != NULL) {
+      deReadFieldProfile(deFieldProfileUseFile);
+    }
     deAddMemoryManagement();
     if (deLLVMFileName == NULL) {
       deLLVMFileName = utAllocString(utReplaceSuffix(fileName, ".ll"));
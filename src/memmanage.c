@@ -14,6 +14,19 @@
 
 #include "de.h"
 #include <stdarg.h>
+#include <stdlib.h>
+
+// At most this many data members are merged into one tuple, so 64-bit members
+// fill at most a cache line.
+#define DE_MAX_FIELD_GROUP_MEMBERS 8
+// With a field profile, data members accessed less than 1/16th as often as the
+// class's hottest member are cold.
+#define DE_COLD_MEMBER_RATIO 16
+
+// Determine if some objects of the class are allocated in function regions.
+static bool usesRegion(deClass theClass) {
+  return deTclassUsesRegion(deClassGetTclass(theClass));
+}
 
 // Allocate the self object for this constructor.  Also change return statements
 // to return self.  Bind all new/modified statements.
@@ -25,30 +38,60 @@ static void generateConstructorString(deClass theClass) {
   deSprintToString(
       "appendcode {\n"
       "  func %1$s_allocate() {\n"
-      "    if %1$s_firstFree != -1u%3$u {\n"
+      // Objects reserved by allocateMany are the last ones used, and are
+      // handed out in order before the free list.
+      "    if %1$s_reserved != 0u%3$u {\n"
+      "      object = <%2$s>(%1$s_used - %1$s_reserved)\n"
+      "      %1$s_reserved -= 1u%3$u\n"
+      "    } else if %1$s_firstFree != -1u%3$u {\n"
       "      object = <%2$s>%1$s_firstFree\n"
       "      %1$s_firstFree = %1$s_nextFree[<u%3$u>object]\n"
       "    } else {\n"
       "      if %1$s_used == %1$s_allocated {\n"
-      "        %1$s_allocated <<= 1u%3$u\n",
-      theClassPath, selfType, refWidth);
-  deVariable variable;
-  deForeachBlockVariable(deClassGetSubBlock(theClass), variable) {
-    deSprintToString(
-          "        %1$s_%2$s.resize(%1$s_allocated)\n",
-        theClassPath, deVariableGetName(variable));
-  } deEndBlockVariable;
-  deSprintToString(
+      "        %1$s_allocated <<= 1u%3$u\n"
+      // The code generator resizes all data member arrays along with nextFree.
+      "        %1$s_nextFree.resize(%1$s_allocated)\n"
       "      }\n"
       "      object = <%2$s>%1$s_used\n"
       "      %1$s_used += 1u%3$u\n"
-      "    }\n"
-      "    %1$s_nextFree[<u%3$u>object] = 1u%3$u\n",
+      "    }\n",
       theClassPath, selfType, refWidth);
+  if (usesRegion(theClass)) {
+    // Region objects are linked through nextFree rather than reference counted.
+    deSprintToString(
+        "    if %1$s_inRegion {\n"
+        "      %1$s_inRegion = false\n"
+        "      %1$s_nextFree[<u%2$u>object] = %1$s_regionHead\n"
+        "      %1$s_regionHead = <u%2$u>object\n"
+        "      return object\n"
+        "    }\n",
+        theClassPath, refWidth);
+  }
+  // Live objects start with a reference count of 1.  If nextFree overlays a
+  // data member, it starts with the member's default value instead.
+  char *initialValue = deClassGetFreeListVariable(theClass) != deVariableNull?
+      "0" : "1";
   deSprintToString(
+      "    %1$s_nextFree[<u%2$u>object] = %3$su%2$u\n"
       "    return object\n"
       "  }\n"
-      "}\n");
+      "}\n",
+      theClassPath, refWidth, initialValue);
+}
+
+// Add the group's default tuple, like (0u32, 0.0f64).
+static void addFieldGroupDefaultValue(deFieldGroup group) {
+  deAddString("(");
+  bool firstTime = true;
+  deVariable variable;
+  deForeachFieldGroupVariable(group, variable) {
+    if (!firstTime) {
+      deAddString(", ");
+    }
+    firstTime = false;
+    deAddString(deDatatypeGetDefaultValueString(deVariableGetDatatype(variable)));
+  } deEndFieldGroupVariable;
+  deAddString(")");
 }
 
 // Just indent to the depth.
@@ -58,30 +101,153 @@ static void indent(uint32 depth) {
   }
 }
 
-// Free the self object in the destructor.
-static void generateDestructorString(deClass theClass) {
-  deStringPos = 0;
-  char* theClassPath =
-      utAllocString(deGetBlockPath(deClassGetSubBlock(theClass), true));
-  char* self = "object";
-  deSprintToString("appendcode {\n");
-  deSprintToString("  func %1$s_free(object) {\n", theClassPath);
+// Classes with a cascade-delete parent are not reference counted, and are
+// destroyed from a worklist, so destroying a deep graph does not recurse.
+static bool destroysFromWorklist(deClass theClass) {
+  return !deTclassRefCounted(deClassGetTclass(theClass));
+}
+
+// Generate <class>_startDestroy, which the destructor calls first.  If another
+// object of the class is being destroyed, this one is pushed on the pending
+// stack, and false is returned.  The stack is a separate array, since nextFree
+// may share its array with a data member the queued object still needs.
+static void generateStartDestroyString(char *theClassPath, uint32 refWidth) {
+  deSprintToString(
+      "  func %1$s_startDestroy(object) {\n"
+      "    if %1$s_destroyActive {\n"
+      "      %1$s_pendingDestroys.append(<u%2$u>object)\n"
+      "      return false\n"
+      "    }\n"
+      "    %1$s_destroyActive = true\n"
+      "    return true\n"
+      "  }\n"
+      "\n",
+      theClassPath, refWidth);
+}
+
+// After freeing an object destroyed from a worklist, the outermost destructor
+// destroys the queued objects in a loop.
+static void generateDrainDestroysString(char *theClassPath, char *selfType) {
+  deSprintToString(
+      "    %1$s_destroyActive = false\n"
+      "    if !%1$s_destroyDraining {\n"
+      "      %1$s_destroyDraining = true\n"
+      "      numPending = %1$s_pendingDestroys.length()\n"
+      "      while numPending != 0 {\n"
+      "        numPending -= 1\n"
+      "        pending = <%2$s>%1$s_pendingDestroys[numPending]\n"
+      "        %1$s_pendingDestroys.resize(numPending)\n"
+      "        pending.destroy()\n"
+      "        numPending = %1$s_pendingDestroys.length()\n"
+      "      }\n"
+      "      %1$s_destroyDraining = false\n"
+      "    }\n",
+      theClassPath, selfType);
+}
+
+// Reset the data members of the object to their default values, so it can be
+// reused.  The first member, nextFree, is left to the caller.
+static void generateClearMembersString(deClass theClass, char *theClassPath, uint32 depth) {
   uint32 refWidth = deClassGetRefWidth(theClass);
   bool firstTime = true;
   deVariable variable;
   deForeachBlockVariable(deClassGetSubBlock(theClass), variable) {
-    if (!firstTime) {
+    if (!firstTime && deVariableGetFieldGroup(variable) == deFieldGroupNull &&
+        variable != deClassGetFreeListVariable(theClass)) {
       deVariable globalArrayVar = deVariableGetGlobalArrayVariable(variable);
       char* zero = deDatatypeGetDefaultValueString(deVariableGetDatatype(variable));
-      deSprintToString("    %1$s[<u%3$u>object] = %2$s\n",
+      indent(depth);
+      deSprintToString("%1$s[<u%3$u>object] = %2$s\n",
                      deVariableGetName(globalArrayVar), zero, refWidth);
     }
     firstTime = false;
   } deEndBlockVariable;
+  deFieldGroup group;
+  deForeachClassFieldGroup(theClass, group) {
+    indent(depth);
+    deSprintToString("%1$s_%2$s[<u%3$u>object] = ", theClassPath,
+        utSymGetName(deFieldGroupGetArrayName(group)), refWidth);
+    addFieldGroupDefaultValue(group);
+    deAddString("\n");
+  } deEndClassFieldGroup;
+}
+
+// Generate the functions that free objects allocated in function regions.
+// Region objects are not reference counted, so nextFree links them into a
+// stack from <class>_regionHead, most recent first.  A function loads the head
+// on entry as its mark, and before returning or throwing it calls
+// <class>_releaseRegion with the mark, which frees every object allocated in
+// its region at once.  Nothing outside the function refers to them, so their
+// destructors are skipped.  Objects at the end of the used objects are given
+// back by reducing the used count, and others go on the free list.  Members
+// are still cleared one object at a time, so reused objects start with default
+// values.
+//
+// A region variable holds the only reference to its object.  When it is
+// reassigned, the new object is the region's top, and the code generator calls
+// <class>_freeRegionObject with the old one.  If the old object is next on the
+// stack, it is freed right away, so a loop creating an object per iteration
+// reuses two objects.  Otherwise it is left for the release at return.
+static void generateReleaseRegionString(deClass theClass, char *theClassPath) {
+  uint32 refWidth = deClassGetRefWidth(theClass);
+  deSprintToString(
+      "  func %1$s_releaseRegion(mark) {\n"
+      "    object = %1$s_regionHead\n"
+      "    while object != mark {\n"
+      "      next = %1$s_nextFree[object]\n",
+      theClassPath);
+  generateClearMembersString(theClass, theClassPath, 3);
+  deSprintToString(
+      "      if object + 1u%2$u == %1$s_used {\n"
+      "        %1$s_used = object\n"
+      "      } else {\n"
+      "        %1$s_nextFree[object] = %1$s_firstFree\n"
+      "        %1$s_firstFree = object\n"
+      "      }\n"
+      "      object = next\n"
+      "    }\n"
+      "    %1$s_regionHead = mark\n"
+      "  }\n"
+      "\n"
+      "  func %1$s_freeRegionObject(object) {\n"
+      "    top = %1$s_regionHead\n"
+      "    if object != -1u%2$u && top != -1u%2$u && %1$s_nextFree[top] == object {\n"
+      "      %1$s_nextFree[top] = %1$s_nextFree[object]\n",
+      theClassPath, refWidth);
+  generateClearMembersString(theClass, theClassPath, 3);
+  deSprintToString(
+      "      %1$s_nextFree[object] = %1$s_firstFree\n"
+      "      %1$s_firstFree = object\n"
+      "    }\n"
+      "  }\n"
+      "\n",
+      theClassPath);
+}
+
+// Free the self object in the destructor.
+static void generateDestructorString(deClass theClass) {
+  deStringPos = 0;
+  char* theClassPath =
+      utAllocString(deGetBlockPath(deClassGetSubBlock(theClass), true));
+  char* self = "object";
+  uint32 refWidth = deClassGetRefWidth(theClass);
+  deSprintToString("appendcode {\n");
+  if (destroysFromWorklist(theClass)) {
+    generateStartDestroyString(theClassPath, refWidth);
+  }
+  if (usesRegion(theClass)) {
+    generateReleaseRegionString(theClass, theClassPath);
+  }
+  deSprintToString("  func %1$s_free(object) {\n", theClassPath);
+  generateClearMembersString(theClass, theClassPath, 2);
   deSprintToString(
       "    %1$s_nextFree[<u%3$u>%2$s] = %1$s_firstFree\n"
       "    %1$s_firstFree = <u%3$u>%2$s\n",
       theClassPath, self, refWidth);
+  if (destroysFromWorklist(theClass)) {
+    generateDrainDestroysString(theClassPath,
+        deDatatypeGetTypeString(deClassGetDatatype(theClass)));
+  }
   deSprintToString(
       "  }\n"
       "}\n");
@@ -97,15 +263,38 @@ static void generateRootBlockArrays(deClass theClass) {
       "prependcode {\n"
       "  %1$s_allocated = 1u%2$u\n"
       "  %1$s_used = 0u%2$u\n"
-      "  %1$s_firstFree = -1u%2$u\n",
+      "  %1$s_firstFree = -1u%2$u\n"
+      "  %1$s_reserved = 0u%2$u\n",
       path, deClassGetRefWidth(theClass));
+  if (destroysFromWorklist(theClass)) {
+    deSprintToString(
+        "  %1$s_pendingDestroys = arrayof(u%2$u)\n"
+        "  %1$s_destroyActive = false\n"
+        "  %1$s_destroyDraining = false\n",
+        path, deClassGetRefWidth(theClass));
+  }
+  if (usesRegion(theClass)) {
+    deSprintToString(
+        "  %1$s_regionHead = -1u%2$u\n"
+        "  %1$s_inRegion = false\n",
+        path, deClassGetRefWidth(theClass));
+  }
   deVariable variable;
   deForeachBlockVariable(block, variable) {
     utAssert(deVariableInstantiated(variable) && !deVariableIsType(variable));
-    deSprintToString("  %1$s_%2$s = [%3$s]\n",
-        path, deVariableGetName(variable),
-        deDatatypeGetDefaultValueString(deVariableGetDatatype(variable)));
+    if (deVariableGetFieldGroup(variable) == deFieldGroupNull &&
+        variable != deClassGetFreeListVariable(theClass)) {
+      deSprintToString("  %1$s_%2$s = [%3$s]\n",
+          path, deVariableGetName(variable),
+          deDatatypeGetDefaultValueString(deVariableGetDatatype(variable)));
+    }
   } deEndBlockVariable;
+  deFieldGroup group;
+  deForeachClassFieldGroup(theClass, group) {
+    deSprintToString("  %1$s_%2$s = [", path, utSymGetName(deFieldGroupGetArrayName(group)));
+    addFieldGroupDefaultValue(group);
+    deAddString("]\n");
+  } deEndClassFieldGroup;
   deAddString("}\n");
   utFree(path);
 }
@@ -126,16 +315,198 @@ static void setGlobalArrayVariables(deClass theClass) {
   deVariable variable;
   deForeachBlockVariable(block, variable) {
     char *path = deGetBlockPath(block, true);
-    utSym name = utSymCreateFormatted("%s_%s", path, deVariableGetName(variable));
+    deFieldGroup group = deVariableGetFieldGroup(variable);
+    utSym name;
+    if (variable == deClassGetFreeListVariable(theClass)) {
+      name = utSymCreateFormatted("%s_nextFree", path);
+    } else if (group == deFieldGroupNull) {
+      name = utSymCreateFormatted("%s_%s", path, deVariableGetName(variable));
+    } else {
+      name = utSymCreateFormatted("%s_%s", path, utSymGetName(deFieldGroupGetArrayName(group)));
+    }
     deIdent ident = deBlockFindIdent(globalBlock, name);
     utAssert(ident != deIdentNull && deIdentGetType(ident) == DE_IDENT_VARIABLE);
     deVariable globalVar = deIdentGetVariable(ident);
     deVariableSetGlobalArrayVariable(variable, globalVar);
+    deVariableSetColumnsClass(globalVar, theClass);
+  } deEndBlockVariable;
+}
+
+// Determine if the data member can share an array of tuples with other
+// members.  Only scalars are grouped, and never the first member, which holds
+// the free list and reference count.
+static bool variableCanBeGrouped(deVariable variable) {
+  if (deVariableGetFieldGroup(variable) != deFieldGroupNull ||
+      variable == deBlockGetFirstVariable(deVariableGetBlock(variable))) {
+    return false;
+  }
+  deDatatype datatype = deVariableGetDatatype(variable);
+  switch (deDatatypeGetType(datatype)) {
+    case DE_TYPE_BOOL:
+    case DE_TYPE_FLOAT:
+    case DE_TYPE_CLASS:
+    case DE_TYPE_ENUM:
+      return true;
+    case DE_TYPE_UINT:
+    case DE_TYPE_INT:
+      return deDatatypeGetWidth(datatype) <= 64;
+    default:
+      return false;
+  }
+}
+
+// Name the group's array after its members, like Point_x_y, and number the
+// members by their position in the tuple.
+static void finishFieldGroup(deFieldGroup group) {
+  utSym name = utSymNull;
+  uint32 index = 0;
+  deVariable variable;
+  deForeachFieldGroupVariable(group, variable) {
+    if (name == utSymNull) {
+      name = deVariableGetSym(variable);
+    } else {
+      name = utSymCreateFormatted("%s_%s", utSymGetName(name), deVariableGetName(variable));
+    }
+    deVariableSetFieldGroupIndex(variable, index);
+    index++;
+  } deEndFieldGroupVariable;
+  deFieldGroupSetArrayName(group, name);
+}
+
+// Create field groups for colocate statements in the class.
+static void addColocatedFieldGroups(deClass theClass) {
+  deBlock block = deClassGetSubBlock(theClass);
+  deFieldGroup colocation;
+  deForeachTclassFieldGroup(deClassGetTclass(theClass), colocation) {
+    deLine line = deFieldGroupGetLine(colocation);
+    deFieldGroup group = deFieldGroupCreate(line);
+    uint32 numMembers = 0;
+    deExpression nameExpr;
+    deForeachExpressionExpression(deFieldGroupGetExpression(colocation), nameExpr) {
+      if (deExpressionGetType(nameExpr) != DE_EXPR_IDENT) {
+        deError(line, "Expected data member names in colocate statement");
+      }
+      utSym name = deExpressionGetName(nameExpr);
+      deIdent ident = deBlockFindIdent(block, name);
+      if (ident == deIdentNull || deIdentGetType(ident) != DE_IDENT_VARIABLE) {
+        deError(line, "%s is not a data member of class %s", utSymGetName(name),
+            deTclassGetName(deClassGetTclass(theClass)));
+      }
+      deVariable variable = deIdentGetVariable(ident);
+      if (deVariableGetFieldGroup(variable) != deFieldGroupNull) {
+        deError(line, "Data member %s is already colocated", utSymGetName(name));
+      }
+      if (!variableCanBeGrouped(variable)) {
+        deError(line, "Only bool, integer, float, enum, and object data members can be colocated");
+      }
+      deFieldGroupAppendVariable(group, variable);
+      numMembers++;
+    } deEndExpressionExpression;
+    if (numMembers < 2) {
+      deError(line, "colocate needs at least two data members");
+    }
+    deClassAppendFieldGroup(theClass, group);
+  } deEndTclassFieldGroup;
+}
+
+// Return the loads and stores of the data member counted in the field profile.
+static uint64 findMemberAccesses(deVariable variable) {
+  return deVariableGetProfileLoads(variable) + deVariableGetProfileStores(variable);
+}
+
+// Return the accesses of the class's most accessed data member in the field
+// profile.
+static uint64 findHottestMemberAccesses(deClass theClass) {
+  uint64 hottest = 0;
+  deVariable variable;
+  deForeachBlockVariable(deClassGetSubBlock(theClass), variable) {
+    uint64 accesses = findMemberAccesses(variable);
+    if (accesses > hottest) {
+      hottest = accesses;
+    }
+  } deEndBlockVariable;
+  return hottest;
+}
+
+// Determine if the field profile found the data member is cold.  Without a
+// profile, no member is.
+static bool memberIsCold(deVariable variable, uint64 hottest) {
+  return deFieldProfileUseFile != NULL &&
+      findMemberAccesses(variable) * DE_COLD_MEMBER_RATIO < hottest;
+}
+
+// Group the remaining data members which the binder found are accessed by
+// exactly the same signatures.  Members only accessed in the constructor are
+// left alone.  With a field profile, cold members are only grouped with other
+// cold members, so they do not dilute the cache lines of hot ones.  Groups are
+// limited to a cache line's worth of members.
+static void addCoaccessedFieldGroups(deClass theClass) {
+  deBlock block = deClassGetSubBlock(theClass);
+  uint64 hottest = findHottestMemberAccesses(theClass);
+  deVariable variable;
+  deForeachBlockVariable(block, variable) {
+    uint32 numSignatures = deVariableGetNumAccessSignatures(variable);
+    if (numSignatures != 0 && variableCanBeGrouped(variable)) {
+      uint32 hash = deVariableGetAccessSignatureHash(variable);
+      bool isCold = memberIsCold(variable, hottest);
+      deFieldGroup group = deFieldGroupNull;
+      uint32 numMembers = 1;
+      deVariable other = deVariableGetNextBlockVariable(variable);
+      while (other != deVariableNull && numMembers < DE_MAX_FIELD_GROUP_MEMBERS) {
+        if (deVariableGetNumAccessSignatures(other) == numSignatures &&
+            deVariableGetAccessSignatureHash(other) == hash && variableCanBeGrouped(other) &&
+            memberIsCold(other, hottest) == isCold) {
+          if (group == deFieldGroupNull) {
+            group = deFieldGroupCreate(deVariableGetLine(variable));
+            deFieldGroupAppendVariable(group, variable);
+            deClassAppendFieldGroup(theClass, group);
+          }
+          deFieldGroupAppendVariable(group, other);
+          numMembers++;
+        }
+        other = deVariableGetNextBlockVariable(other);
+      }
+    }
+  } deEndBlockVariable;
+}
+
+// Merge data members that are accessed together into tuples, so we generate an
+// array of tuples for them, rather than an array per member.
+static void groupDataMembers(deClass theClass) {
+  addColocatedFieldGroups(theClass);
+  addCoaccessedFieldGroups(theClass);
+  deFieldGroup group;
+  deForeachClassFieldGroup(theClass, group) {
+    finishFieldGroup(group);
+  } deEndClassFieldGroup;
+}
+
+// Objects of classes that are not reference counted only use nextFree to link
+// them into the free list after they are destroyed.  To save memory, nextFree
+// shares its array with a data member of the same type, which is dead whenever
+// nextFree is live.  Nothing reads nextFree of a live object, or a data member
+// of a destroyed one, so this is done in safe mode too.
+static void overlayFreeList(deClass theClass) {
+  if (deTclassRefCounted(deClassGetTclass(theClass))) {
+    return;
+  }
+  deBlock block = deClassGetSubBlock(theClass);
+  deVariable nextFree = deBlockGetFirstVariable(block);
+  deDatatype datatype = deVariableGetDatatype(nextFree);
+  deVariable variable;
+  deForeachBlockVariable(block, variable) {
+    if (variable != nextFree && deVariableGetDatatype(variable) == datatype &&
+        deVariableGetFieldGroup(variable) == deFieldGroupNull) {
+      deClassSetFreeListVariable(theClass, variable);
+      return;
+    }
   } deEndBlockVariable;
 }
 
 // Add statements to the constructor and to the root block for managing memory.
 static void allocateSelfInConstructor(deClass theClass) {
+  groupDataMembers(theClass);
+  overlayFreeList(theClass);
   generateRootBlockArrays(theClass);
   deBlock rootBlock = deRootGetBlock(deTheRoot);
   deStatement originalFirstStatement = deBlockGetFirstStatement(rootBlock);
@@ -168,6 +539,23 @@ static void freeSelfInDestructor(deClass theClass) {
   deSignature signature = deSignatureCreate(freeFunc, parameterTypes, 0);
   deSignatureSetInstantiated(signature, true);
   deSignatureSetReturnType(signature, deNoneDatatypeCreate());
+  deFunction prevFunc = deFunctionGetPrevBlockFunction(freeFunc);
+  if (usesRegion(theClass)) {
+    // Both freeRegionObject and releaseRegion take a reference as an integer.
+    for (uint32 i = 0; i < 2; i++) {
+      deDatatypeArray refTypes = deDatatypeArrayAlloc();
+      deDatatypeArrayAppendDatatype(refTypes, deUintDatatypeCreate(deClassGetRefWidth(theClass)));
+      signature = deSignatureCreate(prevFunc, refTypes, 0);
+      deSignatureSetInstantiated(signature, true);
+      deSignatureSetReturnType(signature, deNoneDatatypeCreate());
+      prevFunc = deFunctionGetPrevBlockFunction(prevFunc);
+    }
+  }
+  if (destroysFromWorklist(theClass)) {
+    signature = deSignatureCreate(prevFunc, parameterTypes, 0);
+    deSignatureSetInstantiated(signature, true);
+    deSignatureSetReturnType(signature, deBoolDatatypeCreate());
+  }
 }
 
 // Generate code for referencing and defreferencing the class.
@@ -250,7 +638,8 @@ static void callFinalInDestructors(void) {
 
 // Add code to constructors to allocate a new object, and add variables in the
 // root block needed to manage object memory.  We use structure-of-array memory
-// layout, so there is a global array per data member of the class.
+// layout, so there is a global array per data member of the class, except for
+// members accessed together, which share a global array of tuples.
 void deAddMemoryManagement(void) {
   callFinalInDestructors();
   deClass theClass;
@@ -264,3 +653,92 @@ void deAddMemoryManagement(void) {
     }
   } deEndRootClass;
 }
+
+// Find the data member of a profile line, given its column, which is the name
+// of the global array holding it, like Node_name, and the member name.  The
+// profile is read before memory management adds the arrays, and grouping may
+// have named the column differently, so match the class by path prefix.
+static deVariable findProfileMember(char *column, char *member) {
+  utSym memberSym = utSymCreate(member);
+  deClass theClass;
+  deForeachRootClass(deTheRoot, theClass) {
+    if (deClassBound(theClass)) {
+      deBlock block = deClassGetSubBlock(theClass);
+      char *path = deGetBlockPath(block, true);
+      size_t len = strlen(path);
+      if (!strncmp(column, path, len) && column[len] == '_') {
+        deIdent ident = deBlockFindIdent(block, memberSym);
+        if (ident != deIdentNull && deIdentGetType(ident) == DE_IDENT_VARIABLE) {
+          return deIdentGetVariable(ident);
+        }
+      }
+    }
+  } deEndRootClass;
+  return deVariableNull;
+}
+
+// Add the counts from one line of a field profile, in the format written by
+// runtime_writeFieldProfile: column, member, function, "load" or "store", and
+// the count, separated by tabs.  Lines for members no longer in the program are
+// ignored, since the profile may be from an older version of it.
+static void addFieldProfileLine(char *line) {
+  char *fields[5];
+  char *p = line;
+  for (uint32 i = 0; i < 5; i++) {
+    fields[i] = p;
+    while (*p != '\t' && *p != '\n' && *p != '\0') {
+      p++;
+    }
+    if (i < 4 && *p != '\t') {
+      return;
+    }
+    *p++ = '\0';
+  }
+  deVariable variable = findProfileMember(fields[0], fields[1]);
+  if (variable == deVariableNull) {
+    return;
+  }
+  uint64 count = strtoull(fields[4], NULL, 10);
+  if (!strcmp(fields[3], "store")) {
+    deVariableSetProfileStores(variable, deVariableGetProfileStores(variable) + count);
+  } else {
+    deVariableSetProfileLoads(variable, deVariableGetProfileLoads(variable) + count);
+  }
+}
+
+// Report data members the profile never saw read.  The first member is
+// skipped, since it holds the reference count and free list.
+static void reportUnreadDataMembers(deClass theClass) {
+  deBlock block = deClassGetSubBlock(theClass);
+  deVariable variable;
+  deForeachBlockVariable(block, variable) {
+    if (variable != deBlockGetFirstVariable(block) &&
+        deVariableGetProfileLoads(variable) == 0) {
+      printf("Data member %s.%s is never read (%llu stores)\n", deGetBlockPath(block, false),
+          deVariableGetName(variable), (unsigned long long)deVariableGetProfileStores(variable));
+    }
+  } deEndBlockVariable;
+}
+
+// Read a field profile written by a program compiled with -profgen.  Call this
+// before deAddMemoryManagement: the counts keep cold data members out of the
+// tuples of hot ones, and order the data member arrays when they are allocated
+// together, so that the hottest share cache lines and pages.  Report data
+// members never read.
+void deReadFieldProfile(char *fileName) {
+  FILE *file = fopen(fileName, "r");
+  if (file == NULL) {
+    deError(deLineNull, "Unable to read field profile %s", fileName);
+  }
+  char line[4096];
+  while (fgets(line, sizeof(line), file) != NULL) {
+    addFieldProfileLine(line);
+  }
+  fclose(file);
+  deClass theClass;
+  deForeachRootClass(deTheRoot, theClass) {
+    if (deClassBound(theClass)) {
+      reportUnreadDataMembers(theClass);
+    }
+  } deEndRootClass;
+}